@@ -23,9 +23,16 @@
  */
 
 #include "INA226.h"
+#include <algorithm>
 #include <cmath>
+#include <chrono>
 //#define printDebug
 
+#define ERR_RATE_TOO_HIGH   "Sample rate too high"
+
+// Streamed conversions moved by a single readInto()
+#define INA226_SENSOR_BATCH 16
+
 INA226::INA226(uint8_t deviceAddr, float shuntOhm, DI2CBusHandle i2cBusHandle) : DI2CMaster(i2cBusHandle)
 {
     devAddr = deviceAddr;
@@ -34,10 +41,13 @@ INA226::INA226(uint8_t deviceAddr, float shuntOhm, DI2CBusHandle i2cBusHandle) :
 
 INA226::~INA226()
 {
+    stopStreaming();
+    detachAlertHandler();
 }
 
 bool INA226::begin(float maxCurrent)
 {
+    requestedMaxI = maxCurrent;
     if (!readConfig()) {
         return false;
     }
@@ -50,15 +60,85 @@ bool INA226::begin(float maxCurrent)
     return ret;
 }
 
-bool INA226::readConfig(void)
+/**
+ * @brief Same as begin(maxCurrent), but registers are taken from the cache profile of the device (if it was computed
+ * for the same shunt and max current) and written in a single ioctl, skipping calibration search. Otherwise the
+ * calibration is computed as usual and stored in the cache (call cache.save() or let its destructor do it).
+ * Profiles are keyed by bus number, address and die ID.
+ * 
+ * @param maxCurrent    ->  max expected current.
+ * @param cache         ->  profiles cache.
+ * @return true on success, otherwise false (you can retrieve the error by calling getLastError()).
+ */
+bool INA226::begin(float maxCurrent, INA226CalibrationCache& cache)
+{
+    uint16_t dieID;
+    if (!askFor<uint16_t>(devAddr, INA226_REG_DIE_ID, dieID)) {
+        return false;
+    }
+
+    int busID = DI2CBus::busIDFromHandle(getBusHandle());
+    INA226CalibrationCache::Profile profile;
+    if (busID >= 0 && cache.find(busID, devAddr, dieID, profile) &&
+        profile.shuntOhm == shuntR && profile.maxCurrent == maxCurrent) {
+        // CONFIG and CALIBRATION in one ioctl
+        uint8_t cfgBuf[3] = { INA226_REG_CFG, uint8_t(profile.config >> 8), uint8_t(profile.config) };
+        uint8_t calBuf[3] = { INA226_REG_CAL, uint8_t(profile.calibration >> 8), uint8_t(profile.calibration) };
+        DI2CTransfer batch[] = {
+            { devAddr, cfgBuf, sizeof(cfgBuf), nullptr, 0 },
+            { devAddr, calBuf, sizeof(calBuf), nullptr, 0 },
+        };
+        if (!transferBatch(batch)) {
+            return false;
+        }
+        requestedMaxI = maxCurrent;
+        cfg.raw = profile.config;
+        calibration = profile.calibration;
+        lsbI = profile.currentLsb;
+        maxI = lsbI * 32768;
+        return true;
+    }
+
+    if (!begin(maxCurrent)) {
+        return false;
+    }
+    return busID < 0 || storeCalibration(cache);
+}
+
+/**
+ * @brief Store current CONFIG and calibration of the device in the cache (i.e. after setAveraging(), so that next
+ * begin() restores it).
+ * 
+ * @return true on success, otherwise false (you can retrieve the error by calling getLastError()).
+ */
+bool INA226::storeCalibration(INA226CalibrationCache& cache)
 {
-    cfg.value = askForWord(devAddr, INA226_REG_CFG);
-    if (cfg.value == 0xFFFF) {
+    INA226CalibrationCache::Profile profile = {};
+    int busID = DI2CBus::busIDFromHandle(getBusHandle());
+    if (busID < 0) {
+        lastErrorString = INA226ErrorMap[INA226_ERR_BUS_ID];
         return false;
     }
+    if (!askFor<uint16_t>(devAddr, INA226_REG_DIE_ID, profile.dieID) || !readConfig()) {
+        return false;
+    }
+
+    profile.busID = busID;
+    profile.devAddr = devAddr;
+    profile.config = cfg.raw;
+    profile.calibration = calibration;
+    profile.shuntOhm = shuntR;
+    profile.maxCurrent = requestedMaxI;
+    profile.currentLsb = lsbI;
+    cache.store(profile);
     return true;
 }
 
+bool INA226::readConfig(void)
+{
+    return RegMap::read(*this, devAddr, cfg);
+}
+
 bool INA226::isReady(void)
 {
     uint16_t id = askForWord(devAddr, INA226_REG_MANUFACTURER_ID);
@@ -68,8 +148,8 @@ bool INA226::isReady(void)
 bool INA226::reset(void)
 {
     readConfig();
-    cfg.reg.rst = 1;
-    return writeWord(devAddr, INA226_REG_CFG, cfg.value);
+    cfg.set<Regs::Rst>(true);
+    return RegMap::write(*this, devAddr, cfg);
 }
 
 /**
@@ -186,23 +266,88 @@ bool INA226::setMaxCurrent(float maxAmpere, bool normalize)
     }
 
     //  auto scale calibration if needed.
-    uint32_t calib = round(0.00512 / (lsbI * shuntR));
+    uint32_t calib = round(CALIBRATION_SCALE / (lsbI * shuntR));
     while (calib > 32767)
     {
         lsbI *= 2;
         calib >>= 1;
     }
     maxI = lsbI * 32768;
+    calibration = calib;
 
     lastErrorString=INA226ErrorMap[INA226_ERR_NONE];
     return writeWord(devAddr, INA226_REG_CAL, calib);
 }
 
-bool INA226::setAvaraging(INA226::Avaraging avgMask)
+bool INA226::setAveraging(INA226::Averaging avgMask)
 {
     readConfig();
-    cfg.reg.avg=avgMask;
-    return writeWord(devAddr,INA226_REG_CFG,cfg.value);
+    cfg.set<Regs::Avg>(avgMask);
+    return RegMap::write(*this, devAddr, cfg);
+}
+
+//! Old name of setAveraging().
+bool INA226::setAvaraging(INA226::Averaging avgMask)
+{
+    return setAveraging(avgMask);
+}
+
+/**
+ * @brief Write mode, conversion times and averaging (CONFIG register).
+ * @return true on success, otherwise false (you can retrieve the error by calling getLastError()).
+ */
+bool INA226::setAdcConfig(const INA226::AdcConfig& config)
+{
+    DI2CRegValue<Regs::Config> value;
+    value.raw = cfg.raw & ~Regs::Rst::mask;
+    value.set<Regs::Mode>(config.mode);
+    value.set<Regs::VbusCt>(config.busCt);
+    value.set<Regs::VshCt>(config.shuntCt);
+    value.set<Regs::Avg>(config.avg);
+    if (!RegMap::write(*this, devAddr, value)) {
+        return false;
+    }
+    cfg = value;
+    return true;
+}
+
+/**
+ * @brief Read mode, conversion times and averaging (CONFIG register).
+ * @return true on success, otherwise false (you can retrieve the error by calling getLastError()).
+ */
+bool INA226::getAdcConfig(INA226::AdcConfig& config)
+{
+    if (!readConfig()) {
+        return false;
+    }
+    config.mode = cfg.get<Regs::Mode>();
+    config.busCt = cfg.get<Regs::VbusCt>();
+    config.shuntCt = cfg.get<Regs::VshCt>();
+    config.avg = cfg.get<Regs::Avg>();
+    return true;
+}
+
+/**
+ * @brief Set conversion times and averaging giving sampleRateHz results per second with the lowest noise for the
+ * channels of mode (see INAAdcTuner).
+ * 
+ * @return false if the rate can't be reached (fastest settings are set anyway) or on error.
+ */
+bool INA226::tuneAdc(float sampleRateHz, INA226::Mode mode)
+{
+    INAAdcChoice choice;
+    bool reached = INAAdcTuner::tune(INAAdcTuner::INA226_CONV_TIME_US, mode & 0b001, mode & 0b010, false, sampleRateHz, choice);
+    if (!readConfig()) {
+        return false;
+    }
+    AdcConfig config = { mode, ConvTime(choice.busCt), ConvTime(choice.shuntCt), Averaging(choice.avg) };
+    if (!setAdcConfig(config)) {
+        return false;
+    }
+    if (!reached) {
+        lastErrorString = ERR_RATE_TOO_HIGH;
+    }
+    return reached;
 }
 
 float INA226::getBusVoltage()
@@ -250,6 +395,37 @@ float INA226::getPower()
     return power;
 }
 
+/**
+ * @brief Read shunt, bus, current and power registers in a single ioctl, without scaling.
+ * 
+ * @param raw   ->  destination of register values.
+ * @return true on success, otherwise false (you can retrieve the error by calling getLastError()).
+ */
+bool INA226::readRaw(INA226::RawSample& raw)
+{
+    RegMap::Reader<Regs::ShuntValue, Regs::BusVoltage, Regs::CurrentValue, Regs::Power> reader;
+    if (!reader.read(*this, devAddr)) {
+        return false;
+    }
+    raw.shuntVoltage=reader.get<Regs::ShuntValue>();
+    raw.busVoltage=reader.get<Regs::BusVoltage>();
+    raw.current=reader.get<Regs::CurrentValue>();
+    raw.power=reader.get<Regs::Power>();
+    return true;
+}
+
+//! @return current register resolution in A/bit (set by begin()/setMaxCurrent()).
+float INA226::getCurrentLsb(void)
+{
+    return lsbI;
+}
+
+//! @return power register resolution in W/bit (25 times the current LSB).
+float INA226::getPowerLsb(void)
+{
+    return lsbI * POWER_LSB_FACTOR;
+}
+
 uint32_t INA226::getManufacturerID(void)
 {
     return askForWord(devAddr, INA226_REG_MANUFACTURER_ID);
@@ -274,4 +450,492 @@ std::string INA226::getInfo(void)
     info += "Cal register:    0x" + std::string(sRet) + "\n";
 
     return info;
-}
\ No newline at end of file
+}
+
+static const DSensorChannel INA226Channels[]={
+    { "shunt voltage", QUANTITY_VOLTAGE, "V" },
+    { "bus voltage", QUANTITY_VOLTAGE, "V" },
+    { "current", QUANTITY_CURRENT, "A" },
+    { "power", QUANTITY_POWER, "W" }
+};
+
+//! @return DSensor channels (see SensorChannel).
+std::span<const DSensorChannel> INA226::getChannels(void)
+{
+    return INA226Channels;
+}
+
+//! @return conversion period: reading faster gives the same values again.
+uint32_t INA226::getPreferredPeriodUs(void)
+{
+    return getConversionPeriodUs();
+}
+
+/**
+ * @brief DSensor read: while streaming moves up to INA226_SENSOR_BATCH streamed conversions (with their
+ * timestamps, power is bus voltage x current), otherwise reads shunt, bus, current and power in a single ioctl.
+ *
+ * @param samples   ->  destination, 4 samples for each conversion.
+ * @param count     ->  number of samples written.
+ * @return true on success, otherwise false (you can retrieve the error by calling getLastError()).
+ */
+bool INA226::readInto(std::span<DSensorSample> samples, size_t& count)
+{
+    count=0;
+    if (streaming) {
+        INA226::Sample batch[INA226_SENSOR_BATCH];
+        size_t popped=popSamples(std::span<INA226::Sample>(batch, std::min<size_t>(INA226_SENSOR_BATCH, samples.size()/4)));
+        for (size_t ixS=0; ixS<popped; ixS++) {
+            const INA226::Sample& sample=batch[ixS];
+            samples[count++]={ sample.timestampUs, sample.shuntVoltage, 0, CH_SHUNT_VOLTAGE };
+            samples[count++]={ sample.timestampUs, sample.busVoltage, 0, CH_BUS_VOLTAGE };
+            samples[count++]={ sample.timestampUs, sample.current, 0, CH_CURRENT };
+            samples[count++]={ sample.timestampUs, double(sample.busVoltage)*sample.current, 0, CH_POWER };
+        }
+        return true;
+    }
+
+    INA226::RawSample raw;
+    if (samples.size() < 4 || !readRaw(raw)) {
+        return false;
+    }
+    uint64_t timestampUs=monotonicUs();
+    samples[0]={ timestampUs, raw.shuntVoltage*SHUNT_VOLTAGE_LSB, 0, CH_SHUNT_VOLTAGE };
+    samples[1]={ timestampUs, raw.busVoltage*BUS_VOLTAGE_LSB, 0, CH_BUS_VOLTAGE };
+    samples[2]={ timestampUs, raw.current*getCurrentLsb(), 0, CH_CURRENT };
+    samples[3]={ timestampUs, raw.power*getPowerLsb(), 0, CH_POWER };
+    count=4;
+    return true;
+}
+
+//! @return samples of a full streaming batch.
+size_t INA226::getMaxSamplesPerRead(void)
+{
+    return INA226_SENSOR_BATCH*4;
+}
+
+/**
+ * @brief Start continuous conversions and stream one sample for each conversion into a ring buffer.
+ * 
+ * A worker thread reads Mask/Enable (that clears the Conversion Ready flag) and, only if the CVRF flag was set, shunt,
+ * bus and current registers in a single ioctl: every conversion is stored once, at the configured rate (see
+ * getConversionPeriodUs()), and polls without a new conversion cost a single register read.
+ * - Without alertPin the worker polls the flag every 1/8 of conversion period.
+ * - With alertPin the chip is configured to assert ALERT at each conversion ready (CNVR), and the worker wakes up on
+ *   its falling edge (GPIO alert), the sample timestamp is the one of the edge. An alert function takes priority over
+ *   CNVR on the single ALERT pin, so it can't be used with an alert limit set (see setAlert()).
+ * 
+ * N.B. While streaming do not call other methods that access the bus from other threads, except setAlert(),
+ * clearAlert() and acknowledgeAlert() (their transfers are serialized with the worker ones).
+ * 
+ * @param capacity      ->  ring buffer capacity (rounded up to power of 2), when full new samples are dropped.
+ * @param alertPin      ->  gpio connected to INA226 ALERT pin (-1 = polling).
+ * @param gpioHandle    ->  handle of gpio chip of alertPin (obtained from initGpio() or DGpioChip class).
+ * @return true on success, otherwise false (you can retrieve the error by calling getLastError()).
+ */
+bool INA226::startStreaming(size_t capacity, int alertPin, DGpioHandle gpioHandle)
+{
+    if (streaming) {
+        lastErrorString=INA226ErrorMap[INA226_ERR_STREAMING];
+        return false;
+    }
+
+    // ALERT drives one function only: an alert limit would hide conversion ready
+    if (alertPin >= 0 && alertFunction != ALERT_NONE) {
+        lastErrorString=INA226ErrorMap[INA226_ERR_ALERT_LIMIT_STREAMING];
+        return false;
+    }
+
+    if (alertPin >= 0 && alertPin == limitGpio) {
+        lastErrorString=INA226ErrorMap[INA226_ERR_ALERT_PIN_BUSY];
+        return false;
+    }
+
+    // Continuous shunt and bus conversions
+    if (!readConfig()) {
+        return false;
+    }
+    cfg.set<Regs::Mode>(MODE_CONT_SHUNT_BUS);
+    if (!RegMap::write(*this, devAddr, cfg)) {
+        return false;
+    }
+
+    // Conversion ready on ALERT pin, or alert limit function kept if polling
+    DI2CRegValue<Regs::MaskEnable> maskEn;
+    maskEn.raw=alertMask;
+    maskEn.set<Regs::Cnvr>(alertPin >= 0);
+    if (!RegMap::write(*this, devAddr, maskEn)) {
+        return false;
+    }
+
+    alertGpio=-1;
+    alertPending=0;
+    if (alertPin >= 0) {
+        // ALERT is open drain, active low
+        if (lgGpioClaimAlert(gpioHandle, LG_SET_PULL_UP, LG_FALLING_EDGE, alertPin, -1) != LG_OKAY ||
+            lgGpioSetAlertsFunc(gpioHandle, alertPin, alertCallback, this) != LG_OKAY) {
+            lgGpioFree(gpioHandle, alertPin);
+            // Conversion ready off ALERT again
+            maskEn.raw=alertMask;
+            RegMap::write(*this, devAddr, maskEn);
+            lastErrorString=INA226ErrorMap[INA226_ERR_GPIO_ALERT];
+            return false;
+        }
+        alertGpio=alertPin;
+        alertHandle=gpioHandle;
+    }
+
+    samples=std::make_unique<DRingBuffer<INA226::Sample>>(capacity);
+    streaming=true;
+    streamThread=std::thread([this]() { streamLoop(); });
+
+    lastErrorString=INA226ErrorMap[INA226_ERR_NONE];
+    return true;
+}
+
+/**
+ * @brief Stop the streaming worker (chip is left in continuous mode, buffered samples can still be popped).
+ * With the ALERT pin, conversion ready is removed from Mask/Enable (the alert limit function is kept), so ALERT does
+ * not pulse at every conversion anymore.
+ */
+void INA226::stopStreaming(void)
+{
+    {
+        std::lock_guard<std::mutex> lock(alertMutex);
+        if (!streaming) {
+            return;
+        }
+        streaming=false;
+    }
+    alertCond.notify_all();
+    if (streamThread.joinable()) {
+        streamThread.join();
+    }
+
+    if (alertGpio >= 0) {
+        lgGpioSetAlertsFunc(alertHandle, alertGpio, nullptr, nullptr);
+        lgGpioFree(alertHandle, alertGpio);
+        alertGpio=-1;
+
+        std::lock_guard<std::mutex> busLock(busMutex);
+        DI2CRegValue<Regs::MaskEnable> maskEn;
+        maskEn.raw=alertMask;
+        RegMap::write(*this, devAddr, maskEn);
+    }
+}
+
+//! @return true if streaming worker is running.
+bool INA226::isStreaming(void)
+{
+    return streaming;
+}
+
+//! @return number of samples ready to be popped.
+size_t INA226::available(void)
+{
+    return samples ? samples->size() : 0;
+}
+
+/**
+ * @brief Get the oldest streamed sample.
+ * @return false if no samples are available.
+ */
+bool INA226::popSample(INA226::Sample& sample)
+{
+    return samples ? samples->pop(sample) : false;
+}
+
+/**
+ * @brief Get the oldest streamed samples.
+ * @return number of samples copied (up to samples.size()).
+ */
+size_t INA226::popSamples(std::span<INA226::Sample> dest)
+{
+    return samples ? samples->pop(dest) : 0;
+}
+
+//! @return number of samples lost because the ring buffer was full.
+size_t INA226::getDroppedSamples(void)
+{
+    return samples ? samples->droppedCount() : 0;
+}
+
+/**
+ * @return time between two conversions in continuous shunt and bus mode, from the last read configuration.
+ */
+uint32_t INA226::getConversionPeriodUs(void)
+{
+    INAAdcChoice choice = { uint8_t(cfg.get<Regs::VshCt>()), uint8_t(cfg.get<Regs::VbusCt>()), 0, uint8_t(cfg.get<Regs::Avg>()), 0 };
+    return INAAdcTuner::periodUs(INAAdcTuner::INA226_CONV_TIME_US, true, true, false, choice);
+}
+
+/**
+ * @brief Read Mask/Enable, then shunt, bus and current in one ioctl if a conversion is ready (data read after a set
+ * CVRF is the one of that conversion).
+ */
+bool INA226::readStreamSample(bool& ready, INA226::Sample& sample)
+{
+    std::lock_guard<std::mutex> busLock(busMutex);
+    DI2CRegValue<Regs::MaskEnable> maskEn;
+    if (!RegMap::read(*this, devAddr, maskEn)) {
+        return false;
+    }
+    ready=maskEn.get<Regs::Cvrf>();
+    // Reading Mask/Enable clears AFF (and the latch): keep it for acknowledgeAlert()
+    if (maskEn.get<Regs::Aff>()) {
+        alertFlagged=true;
+    }
+    if (!ready) {
+        return true;
+    }
+
+    uint8_t buf[3][2];
+    const DI2CReadRequest requests[]={
+        { INA226_REG_SHUNT_VOLT, buf[0], 2 },
+        { INA226_REG_BUS_VOLT, buf[1], 2 },
+        { INA226_REG_CURRENT, buf[2], 2 },
+    };
+    if (!askForBufs(devAddr, requests)) {
+        return false;
+    }
+
+    sample.shuntVoltage=DI2CCodec::decode<int16_t>(std::span<const uint8_t,2>(buf[0])) * SHUNT_VOLTAGE_LSB;
+    sample.busVoltage=DI2CCodec::decode<uint16_t>(std::span<const uint8_t,2>(buf[1])) * BUS_VOLTAGE_LSB;
+    sample.current=DI2CCodec::decode<int16_t>(std::span<const uint8_t,2>(buf[2])) * lsbI;
+    return true;
+}
+
+void INA226::streamLoop(void)
+{
+    using namespace std::chrono;
+    uint32_t periodUs=getConversionPeriodUs();
+    microseconds pollInterval(std::max<uint32_t>(periodUs/8, 50));
+    // With ALERT pin a missed edge must not stop the stream
+    microseconds alertTimeout(periodUs*2);
+
+    while (streaming) {
+        uint64_t timestampUs=0;
+        if (alertGpio >= 0) {
+            std::unique_lock<std::mutex> lock(alertMutex);
+            alertCond.wait_for(lock, alertTimeout, [this]() { return alertPending > 0 || !streaming; });
+            if (!streaming) {
+                break;
+            }
+            if (alertPending > 0) {
+                timestampUs=alertTimestampUs;
+                alertPending=0;
+            }
+        }
+        else {
+            std::this_thread::sleep_for(pollInterval);
+        }
+
+        bool ready=false;
+        Sample sample;
+        if (!readStreamSample(ready, sample) || !ready) {
+            continue;
+        }
+        sample.timestampUs=timestampUs ? timestampUs : duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+        samples->push(sample);
+    }
+}
+
+/**
+ * @brief lgpio ALERT pin callback: wakes up the streaming worker.
+ * lgpio timestamps are CLOCK_MONOTONIC nanoseconds, same clock of std::chrono::steady_clock on linux.
+ */
+void INA226::alertCallback(int eventsCount, lgGpioAlert_p events, void *userData)
+{
+    INA226 *self=static_cast<INA226 *>(userData);
+    for (int ixE=0; ixE<eventsCount; ixE++) {
+        if (events[ixE].report.level == LG_TIMEOUT) {
+            continue;
+        }
+        {
+            std::lock_guard<std::mutex> lock(self->alertMutex);
+            self->alertTimestampUs=events[ixE].report.timestamp / 1000;
+            self->alertPending++;
+        }
+        self->alertCond.notify_one();
+    }
+}
+
+/*
+ * Alert limit: the chip compares every conversion with ALERT_LMT and pulls
+ * the ALERT pin (open drain, active low) when the selected function trips.
+ * With latch, ALERT stays asserted (and AFF set) until Mask/Enable is read,
+ * so a single short fault is never missed. While streaming the worker reads
+ * Mask/Enable at every conversion, so the latch is re-armed by it: the AFF it
+ * reads is kept and reported by the next acknowledgeAlert().
+ */
+
+/**
+ * @brief Set the alert function and its limit (can be called while streaming, see startStreaming()).
+ * 
+ * @param function  ->  the limit to check (ALERT_NONE disables).
+ * @param limit     ->  A for shunt limits (converted to shunt voltage), V for bus limits, W for power limit
+ *                      (needs begin() for current resolution).
+ * @param latch     ->  true: ALERT stays asserted until acknowledgeAlert() (until the next conversion while
+ *                      streaming, the fault is still reported by acknowledgeAlert()), false: ALERT follows the condition.
+ * @return true on success, otherwise false (you can retrieve the error by calling getLastError()). While streaming
+ * with the ALERT pin (conversion ready) only ALERT_NONE is accepted: the chip drives ALERT with the highest priority
+ * function, and any alert function has priority over conversion ready.
+ */
+bool INA226::setAlert(INA226::AlertFunction function, float limit, bool latch)
+{
+    std::lock_guard<std::mutex> busLock(busMutex);
+    if (function != ALERT_NONE && streaming && alertGpio >= 0) {
+        lastErrorString = INA226ErrorMap[INA226_ERR_ALERT_LIMIT_STREAMING];
+        return false;
+    }
+
+    float regValue;
+    int32_t regMin = 0;
+    switch (function) {
+        case ALERT_SHUNT_OVER:
+        case ALERT_SHUNT_UNDER:
+            regValue = limit * shuntR / SHUNT_VOLTAGE_LSB;
+            regMin = INT16_MIN;
+            break;
+        case ALERT_BUS_OVER:
+        case ALERT_BUS_UNDER:
+            regValue = limit / BUS_VOLTAGE_LSB;
+            break;
+        case ALERT_POWER_OVER:
+            if (lsbI == 0) {
+                lastErrorString = INA226ErrorMap[INA226_ERR_NOT_READY];
+                return false;
+            }
+            regValue = limit / getPowerLsb();
+            break;
+        default:
+            regValue = 0;
+            break;
+    }
+    int32_t regLimit = std::clamp<int32_t>(std::lround(regValue), regMin, regMin < 0 ? INT16_MAX : UINT16_MAX);
+
+    DI2CRegValue<Regs::AlertLimit> alertLmt;
+    alertLmt.raw = uint16_t(regLimit);
+    DI2CRegValue<Regs::MaskEnable> maskEn;
+    maskEn.raw = uint16_t(function);
+    maskEn.set<Regs::Len>(latch && function != ALERT_NONE);
+    // Conversion ready on ALERT pin is kept while streaming with it (no alert function, see above)
+    maskEn.set<Regs::Cnvr>(streaming && alertGpio >= 0);
+    if (!RegMap::write(*this, devAddr, alertLmt) || !RegMap::write(*this, devAddr, maskEn)) {
+        return false;
+    }
+
+    alertMask = maskEn.raw & ~Regs::Cnvr::mask;
+    alertFlagged = false;
+    {
+        std::lock_guard<std::mutex> lock(limitMutex);
+        alertFunction = function;
+        alertLimit = limit;
+    }
+    lastErrorString = INA226ErrorMap[INA226_ERR_NONE];
+    return true;
+}
+
+/**
+ * @brief Disable the alert function.
+ */
+bool INA226::clearAlert(void)
+{
+    return setAlert(ALERT_NONE, 0, false);
+}
+
+/**
+ * @brief Read Mask/Enable: re-arms a latched alert (can be called while streaming, see startStreaming()).
+ * 
+ * @param active    ->  true if the alert function tripped (AFF) since last acknowledgeAlert() (also when the flag
+ *                      was read by the streaming worker).
+ * @return true on success, otherwise false (you can retrieve the error by calling getLastError()).
+ */
+bool INA226::acknowledgeAlert(bool& active)
+{
+    std::lock_guard<std::mutex> busLock(busMutex);
+    DI2CRegValue<Regs::MaskEnable> maskEn;
+    if (!RegMap::read(*this, devAddr, maskEn)) {
+        return false;
+    }
+    active = alertFlagged.exchange(false) || maskEn.get<Regs::Aff>();
+    return true;
+}
+
+/**
+ * @brief Call handler on every ALERT pin falling edge (lgpio alert thread, microseconds after the fault).
+ * 
+ * @param alertPin      ->  gpio connected to ALERT (pull-up enabled).
+ * @param gpioHandle    ->  gpio chip handle.
+ * @param handler       ->  function to call.
+ * @return true on success, otherwise false (you can retrieve the error by calling getLastError()).
+ */
+bool INA226::attachAlertHandler(int alertPin, DGpioHandle gpioHandle, INA226::AlertHandler handler)
+{
+    if (streaming && alertPin == alertGpio) {
+        lastErrorString = INA226ErrorMap[INA226_ERR_ALERT_PIN_BUSY];
+        return false;
+    }
+    detachAlertHandler();
+
+    {
+        std::lock_guard<std::mutex> lock(limitMutex);
+        alertHandler = handler;
+    }
+    // ALERT is open drain, active low
+    if (lgGpioClaimAlert(gpioHandle, LG_SET_PULL_UP, LG_FALLING_EDGE, alertPin, -1) != LG_OKAY ||
+        lgGpioSetAlertsFunc(gpioHandle, alertPin, limitAlertCallback, this) != LG_OKAY) {
+        lgGpioFree(gpioHandle, alertPin);
+        std::lock_guard<std::mutex> lock(limitMutex);
+        alertHandler = nullptr;
+        lastErrorString = INA226ErrorMap[INA226_ERR_GPIO_ALERT];
+        return false;
+    }
+    limitGpio = alertPin;
+    limitHandle = gpioHandle;
+    alertCount = 0;
+
+    lastErrorString = INA226ErrorMap[INA226_ERR_NONE];
+    return true;
+}
+
+/**
+ * @brief Release the ALERT gpio (alert function of the chip is untouched): waits for a running handler, it is not
+ * called afterwards.
+ */
+void INA226::detachAlertHandler(void)
+{
+    if (limitGpio >= 0) {
+        lgGpioSetAlertsFunc(limitHandle, limitGpio, nullptr, nullptr);
+        lgGpioFree(limitHandle, limitGpio);
+        limitGpio = -1;
+    }
+    std::lock_guard<std::mutex> lock(limitMutex);
+    alertHandler = nullptr;
+}
+
+//! @return number of ALERT pin edges since the handler was attached.
+uint32_t INA226::getAlertCount(void)
+{
+    return alertCount.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief lgpio ALERT pin callback of the alert limit: calls the handler with the edge timestamp.
+ * The handler runs under limitMutex: setAlert() and detachAlertHandler() wait for it to return.
+ */
+void INA226::limitAlertCallback(int eventsCount, lgGpioAlert_p events, void *userData)
+{
+    INA226 *self = static_cast<INA226 *>(userData);
+    for (int ixE = 0; ixE < eventsCount; ixE++) {
+        if (events[ixE].report.level == LG_TIMEOUT) {
+            continue;
+        }
+        self->alertCount.fetch_add(1, std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock(self->limitMutex);
+        if (self->alertHandler) {
+            AlertEvent event = { events[ixE].report.timestamp / 1000, self->alertFunction, self->alertLimit };
+            self->alertHandler(event);
+        }
+    }
+}
@@ -72,16 +72,34 @@ POR VALUE  0     0      0    0 0 0 0 0 0 0 0 0 0 0 0 0
 #define INA226_ERR_SHUNT_LOW              0x8002
 #define INA226_ERR_NORMALIZE_FAILED       0x8003
 #define INA226_ERR_NOT_READY              0x8004
+#define INA226_ERR_STREAMING              0x8005
+#define INA226_ERR_GPIO_ALERT             0x8006
+#define INA226_ERR_BUS_ID                 0x8007
+#define INA226_ERR_ALERT_PIN_BUSY         0x8008
+#define INA226_ERR_ALERT_LIMIT_STREAMING  0x8009
 
 #define INA226_MINIMAL_SHUNT_OHM          0.001
 
 #include <di2cmaster>
+#include <di2cregmap>
+#include <dgpiochip>
+#include <dringbuffer>
+#include <dsensor>
+#include <INAAdcTuner/INAAdcTuner.h>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "INA226CalibrationCache.h"
 
-class INA226 : public DI2CMaster {
+class INA226 : public DI2CMaster, public DSensor {
     public:
-        enum Avaraging {
-            AVG_1 = 0b000,
+        //! Number of averages (AVG)
+        enum Averaging {
+            AVG_1 = 0b000,                  // POR
             AVG_4 = 0b001,
             AVG_16 = 0b010,
             AVG_64 = 0b011,
@@ -90,18 +108,172 @@ class INA226 : public DI2CMaster {
             AVG_512 = 0b110,
             AVG_1024 = 0b111
         };
+        using Avaraging = Averaging;        // old name
+
+        //! Conversion time of bus and shunt voltage (VBUSCT, VSHCT)
+        enum ConvTime {
+            CT_140US = 0b000,
+            CT_204US = 0b001,
+            CT_332US = 0b010,
+            CT_588US = 0b011,
+            CT_1100US = 0b100,              // POR
+            CT_2116US = 0b101,
+            CT_4156US = 0b110,
+            CT_8244US = 0b111
+        };
+
+        //! Operating mode (MODE)
+        enum Mode {
+            MODE_POWER_DOWN = 0b000,
+            MODE_TRIG_SHUNT = 0b001,
+            MODE_TRIG_BUS = 0b010,
+            MODE_TRIG_SHUNT_BUS = 0b011,
+            MODE_CONT_SHUNT = 0b101,
+            MODE_CONT_BUS = 0b110,
+            MODE_CONT_SHUNT_BUS = 0b111     // POR
+        };
+
+        //! ADC configuration.
+        struct AdcConfig {
+            INA226::Mode mode;
+            INA226::ConvTime busCt;
+            INA226::ConvTime shuntCt;
+            INA226::Averaging avg;
+        };
+
+        //! Raw register values (multiply by the LSB to get engineering units, see INAScale for batches).
+        struct RawSample {
+            int32_t shuntVoltage;   // SHUNT_VOLTAGE_LSB
+            int32_t busVoltage;     // BUS_VOLTAGE_LSB
+            int32_t current;        // getCurrentLsb()
+            int32_t power;          // getPowerLsb()
+        };
+
+        static constexpr float SHUNT_VOLTAGE_LSB = 2.5e-6f;   // V
+        static constexpr float BUS_VOLTAGE_LSB = 1.25e-3f;    // V
+        static constexpr float POWER_LSB_FACTOR = 25;         // x current LSB
+        static constexpr double CALIBRATION_SCALE = 0.00512;  // CAL = CALIBRATION_SCALE / (current LSB x shunt)
+
+        //! DSensor channels (index of DSensorSample::channel).
+        enum SensorChannel {
+            CH_SHUNT_VOLTAGE = 0,   // V
+            CH_BUS_VOLTAGE = 1,     // V
+            CH_CURRENT = 2,         // A
+            CH_POWER = 3            // W
+        };
+
+        //! A streaming sample: one for each conversion.
+        struct Sample {
+            uint64_t timestampUs;   // steady clock (CLOCK_MONOTONIC) microseconds of conversion ready
+            float shuntVoltage;     // V
+            float busVoltage;       // V
+            float current;          // A
+        };
+
+        //! Alert functions (Mask/Enable D15-D11): one at a time drives the ALERT pin.
+        enum AlertFunction {
+            ALERT_NONE = 0,
+            ALERT_SHUNT_OVER = 1 << 15,     // SOL: limit in A (compared with shunt voltage)
+            ALERT_SHUNT_UNDER = 1 << 14,    // SUL: limit in A (compared with shunt voltage)
+            ALERT_BUS_OVER = 1 << 13,       // BOL: limit in V
+            ALERT_BUS_UNDER = 1 << 12,      // BUL: limit in V
+            ALERT_POWER_OVER = 1 << 11      // POL: limit in W
+        };
+
+        //! An ALERT pin edge.
+        struct AlertEvent {
+            uint64_t timestampUs;           // steady clock (CLOCK_MONOTONIC) microseconds of the edge
+            INA226::AlertFunction function;
+            float limit;
+        };
+
+        //! Called by the lgpio alert thread: keep it short, no i2c (use acknowledgeAlert() elsewhere), do not call the
+        //! alert methods from it.
+        typedef std::function<void(const INA226::AlertEvent& event)> AlertHandler;
+
+        //! Register map
+        struct Regs {
+            // Configuration register fields
+            struct Mode   : DI2CField<0,3,INA226::Mode> {};         // D2-D0   Operating mode
+            struct VshCt  : DI2CField<3,3,INA226::ConvTime> {};     // D5-D3   Shunt voltage conversion time
+            struct VbusCt : DI2CField<6,3,INA226::ConvTime> {};     // D8-D6   Bus voltage conversion time
+            struct Avg    : DI2CField<9,3,INA226::Averaging> {};    // D11-D9  Averaging
+            struct Rst    : DI2CField<15,1,bool> {};                // D15     Reset
+            // Mask/Enable register fields
+            struct Len    : DI2CField<0,1,bool> {};                 // D0      Alert latch enable
+            struct Apol   : DI2CField<1,1,bool> {};                 // D1      Alert polarity
+            struct Ovf    : DI2CField<2,1,bool> {};                 // D2      Math overflow flag
+            struct Cvrf   : DI2CField<3,1,bool> {};                 // D3      Conversion ready flag
+            struct Aff    : DI2CField<4,1,bool> {};                 // D4      Alert function flag
+            struct Cnvr   : DI2CField<10,1,bool> {};                // D10     Conversion ready alert
+            struct Pol    : DI2CField<11,1,bool> {};                // D11     Power over-limit
+            struct Bul    : DI2CField<12,1,bool> {};                // D12     Bus voltage under-voltage
+            struct Bol    : DI2CField<13,1,bool> {};                // D13     Bus voltage over-voltage
+            struct Sul    : DI2CField<14,1,bool> {};                // D14     Shunt voltage under-voltage
+            struct Sol    : DI2CField<15,1,bool> {};                // D15     Shunt voltage over-voltage
+            // Signed full register values
+            struct ShuntValue   : DI2CField<0,16,int16_t> {};
+            struct CurrentValue : DI2CField<0,16,int16_t> {};
+
+            using Config         = DI2CRegister<INA226_REG_CFG, 2, ACCESS_READ_WRITE, std::endian::big, Mode, VshCt, VbusCt, Avg, Rst>;
+            using ShuntVoltage   = DI2CRegister<INA226_REG_SHUNT_VOLT, 2, ACCESS_READ_ONLY, std::endian::big, ShuntValue>;
+            using BusVoltage     = DI2CRegister<INA226_REG_BUS_VOLT, 2, ACCESS_READ_ONLY>;
+            using Power          = DI2CRegister<INA226_REG_POWER, 2, ACCESS_READ_ONLY>;
+            using Current        = DI2CRegister<INA226_REG_CURRENT, 2, ACCESS_READ_ONLY, std::endian::big, CurrentValue>;
+            using Calibration    = DI2CRegister<INA226_REG_CAL, 2>;
+            using MaskEnable     = DI2CRegister<INA226_REG_MASKEN, 2, ACCESS_READ_WRITE, std::endian::big, Len, Apol, Ovf, Cvrf, Aff, Cnvr, Pol, Bul, Bol, Sul, Sol>;
+            using AlertLimit     = DI2CRegister<INA226_REG_ALERT_LMT, 2>;
+            using ManufacturerID = DI2CRegister<INA226_REG_MANUFACTURER_ID, 2, ACCESS_READ_ONLY>;
+            using DieID          = DI2CRegister<INA226_REG_DIE_ID, 2, ACCESS_READ_ONLY>;
+        };
+        //! INA226 does not auto-increment the register pointer
+        using RegMap = DI2CRegMap<false, Regs::Config, Regs::ShuntVoltage, Regs::BusVoltage, Regs::Power, Regs::Current,
+                                  Regs::Calibration, Regs::MaskEnable, Regs::AlertLimit, Regs::ManufacturerID, Regs::DieID>;
 
         INA226(uint8_t deviceAddr, float shuntOhm, DI2CBusHandle i2cBusHandle);
         ~INA226();
         bool begin(float maxCurrent);
+        bool begin(float maxCurrent, INA226CalibrationCache& cache);
+        bool storeCalibration(INA226CalibrationCache& cache);
         bool isReady(void);
         bool reset(void);
         bool setMaxCurrent(float maxCurrent, bool normalize);
-        bool setAvaraging(INA226::Avaraging avgMask);
+        bool setAveraging(INA226::Averaging avgMask);
+        bool setAvaraging(INA226::Averaging avgMask);
+        bool setAdcConfig(const INA226::AdcConfig& config);
+        bool getAdcConfig(INA226::AdcConfig& config);
+        bool tuneAdc(float sampleRateHz, INA226::Mode mode = MODE_CONT_SHUNT_BUS);
         float getBusVoltage(void);
         float getShuntVoltage(void);
         float getCurrent(void);
         float getPower(void);
+        bool readRaw(INA226::RawSample& raw);
+        float getCurrentLsb(void);
+        float getPowerLsb(void);
+
+        // Streaming (continuous conversions, one sample for each conversion)
+        bool startStreaming(size_t capacity = 1024, int alertPin = -1, DGpioHandle gpioHandle = -1);
+        void stopStreaming(void);
+        bool isStreaming(void);
+        size_t available(void);
+        bool popSample(INA226::Sample& sample);
+        size_t popSamples(std::span<INA226::Sample> samples);
+        size_t getDroppedSamples(void);
+        uint32_t getConversionPeriodUs(void);
+
+        // Alert limit (ALERT pin driven by the chip, no polling)
+        bool setAlert(INA226::AlertFunction function, float limit, bool latch = true);
+        bool clearAlert(void);
+        bool acknowledgeAlert(bool& active);
+        bool attachAlertHandler(int alertPin, DGpioHandle gpioHandle, INA226::AlertHandler handler);
+        void detachAlertHandler(void);
+        uint32_t getAlertCount(void);
+
+        // DSensor (streamed samples while streaming, otherwise one reading)
+        std::span<const DSensorChannel> getChannels(void) override;
+        uint32_t getPreferredPeriodUs(void) override;
+        bool readInto(std::span<DSensorSample> samples, size_t& count) override;
+        size_t getMaxSamplesPerRead(void) override;
 
         uint32_t getManufacturerID(void);
         uint32_t getDieID(void); 
@@ -109,6 +281,10 @@ class INA226 : public DI2CMaster {
 
     private:
         bool readConfig(void);
+        void streamLoop(void);
+        bool readStreamSample(bool& ready, INA226::Sample& sample);
+        static void alertCallback(int eventsCount, lgGpioAlert_p events, void *userData);
+        static void limitAlertCallback(int eventsCount, lgGpioAlert_p events, void *userData);
 
         std::map<uint16_t, std::string> INA226ErrorMap = {
             {INA226_ERR_NONE, "No error"},
@@ -116,25 +292,45 @@ class INA226 : public DI2CMaster {
             {INA226_ERR_MAXCURRENT_LOW, "Max current too low"},
             {INA226_ERR_SHUNT_LOW, "Shunt resistance too low"},
             {INA226_ERR_NORMALIZE_FAILED, "Normalization failed"},
-            {INA226_ERR_NOT_READY, "INA226 not ready"}
+            {INA226_ERR_NOT_READY, "INA226 not ready"},
+            {INA226_ERR_STREAMING, "Streaming already running"},
+            {INA226_ERR_GPIO_ALERT, "ALERT pin setup failed"},
+            {INA226_ERR_BUS_ID, "Bus number of handle unknown"},
+            {INA226_ERR_ALERT_PIN_BUSY, "ALERT pin used by streaming"},
+            {INA226_ERR_ALERT_LIMIT_STREAMING, "Alert limit and conversion ready can't share the ALERT pin"}
         };
 
-        union REG_CFG {
-            uint16_t value;
-            struct {
-                uint16_t mode   : 3;  // D2-D0   (bit 0-2)   Operating mode
-                uint16_t vshct  : 3;  // D5-D3   (bit 3-5)   Shunt voltage conversion time
-                uint16_t vbusct : 3;  // D8-D6   (bit 6-8)   Bus voltage conversion time
-                uint16_t avg    : 3;  // D11-D9  (bit 9-11)  Averaging bits
-                uint16_t reserved : 3;// D14-D12 (bit 12-14) Reserved bits
-                uint16_t rst    : 1;  // D15     (bit 15)    Reset
-            } reg;
-        } cfg;
+        DI2CRegValue<Regs::Config> cfg;
         
         uint8_t devAddr;
         float shuntR;   // Shunt R value      -> Ohm
         float lsbI = 0; // Current resolution -> A/bit
         float maxI = 0; // Max current        -> A
+        float requestedMaxI = 0;    // begin() max current
+        uint16_t calibration = 0;   // CALIBRATION register value
+
+        // Streaming
+        std::unique_ptr<DRingBuffer<INA226::Sample>> samples;
+        std::thread streamThread;
+        std::atomic<bool> streaming{false};
+        std::mutex busMutex;        // i2c transfers (and lastErrorString) of the worker and of the alert methods
+        int alertGpio = -1;
+        DGpioHandle alertHandle = -1;
+        std::mutex alertMutex;
+        std::condition_variable alertCond;
+        uint32_t alertPending = 0;
+        uint64_t alertTimestampUs = 0;
+
+        // Alert limit
+        uint16_t alertMask = 0;     // Mask/Enable alert function and latch bits
+        std::mutex limitMutex;      // alertFunction, alertLimit and alertHandler (read by the lgpio thread)
+        INA226::AlertFunction alertFunction = ALERT_NONE;
+        float alertLimit = 0;
+        std::atomic<bool> alertFlagged{false};  // AFF read (and so cleared) by the streaming worker
+        INA226::AlertHandler alertHandler;
+        int limitGpio = -1;
+        DGpioHandle limitHandle = -1;
+        std::atomic<uint32_t> alertCount{0};
 };
 
 #endif
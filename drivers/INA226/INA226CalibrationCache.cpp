@@ -0,0 +1,195 @@
+/*
+ * INA226CalibrationCache - persisted INA226 calibration profiles
+ *
+ * Copyright (C) 2025 Fabio Durigon.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ */
+
+/*
+ * Binary file (native byte order, the cache belongs to the machine):
+ * header   "I226", version (1 byte), reserved (1 byte), count (2 bytes),
+ *          FNV-1a hash of records (4 bytes)
+ * records  count x Profile (24 bytes)
+ * A file with bad header, size or hash is ignored (profiles are computed
+ * again), so a corrupted cache can't load wrong calibrations.
+ */
+
+#include "INA226CalibrationCache.h"
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+
+#define CACHE_MAGIC         "I226"
+#define CACHE_VERSION       1
+#define CACHE_HEADER_LEN    12
+
+#define ERR_CACHE_FORMAT    "Calibration cache file not valid"
+
+static_assert(sizeof(INA226CalibrationCache::Profile) == 24, "Profile is a file record: keep it packed");
+
+static uint32_t fnv1a(const uint8_t *data, size_t len)
+{
+    uint32_t hash=2166136261u;
+    for (size_t ixB=0; ixB<len; ixB++) {
+        hash=(hash ^ data[ixB]) * 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * @brief Create the cache and load profiles of filePath (if any).
+ */
+INA226CalibrationCache::INA226CalibrationCache(const std::string& filePath) : path(filePath)
+{
+    dirty=false;
+    load();
+}
+
+/**
+ * @brief Save the profiles stored since last save().
+ */
+INA226CalibrationCache::~INA226CalibrationCache()
+{
+    save();
+}
+
+/**
+ * @brief Replace profiles with the file content.
+ * 
+ * @return true on success, otherwise false (missing file or not valid, you can retrieve the error by calling getLastError()).
+ */
+bool INA226CalibrationCache::load(void)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    profiles.clear();
+    dirty=false;
+
+    FILE *file=fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        lastErrorString=strerror(errno);
+        return false;
+    }
+
+    uint8_t header[CACHE_HEADER_LEN];
+    bool ret=fread(header, 1, CACHE_HEADER_LEN, file) == CACHE_HEADER_LEN &&
+             memcmp(header, CACHE_MAGIC, 4) == 0 && header[4] == CACHE_VERSION;
+    if (ret) {
+        uint16_t count;
+        uint32_t hash;
+        memcpy(&count, &header[6], sizeof(count));
+        memcpy(&hash, &header[8], sizeof(hash));
+        profiles.resize(count);
+        ret=fread(profiles.data(), sizeof(Profile), count, file) == count && fgetc(file) == EOF &&
+            fnv1a(reinterpret_cast<const uint8_t *>(profiles.data()), count*sizeof(Profile)) == hash;
+    }
+    fclose(file);
+
+    if (!ret) {
+        profiles.clear();
+        lastErrorString=ERR_CACHE_FORMAT;
+    }
+    return ret;
+}
+
+/**
+ * @brief Write profiles to file, if changed (the file is replaced atomically).
+ * 
+ * @return true on success, otherwise false (you can retrieve the error by calling getLastError()).
+ */
+bool INA226CalibrationCache::save(void)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!dirty) {
+        return true;
+    }
+
+    uint8_t header[CACHE_HEADER_LEN]={};
+    uint16_t count=profiles.size();
+    uint32_t hash=fnv1a(reinterpret_cast<const uint8_t *>(profiles.data()), count*sizeof(Profile));
+    memcpy(header, CACHE_MAGIC, 4);
+    header[4]=CACHE_VERSION;
+    memcpy(&header[6], &count, sizeof(count));
+    memcpy(&header[8], &hash, sizeof(hash));
+
+    std::string tmpPath=path + ".tmp";
+    FILE *file=fopen(tmpPath.c_str(), "wb");
+    if (file == nullptr) {
+        lastErrorString=strerror(errno);
+        return false;
+    }
+    bool ret=fwrite(header, 1, CACHE_HEADER_LEN, file) == CACHE_HEADER_LEN &&
+             fwrite(profiles.data(), sizeof(Profile), count, file) == count;
+    ret=(fclose(file) == 0) && ret;
+    if (!ret || rename(tmpPath.c_str(), path.c_str()) != 0) {
+        lastErrorString=strerror(errno);
+        remove(tmpPath.c_str());
+        return false;
+    }
+
+    dirty=false;
+    return true;
+}
+
+/**
+ * @brief Find the profile of a device.
+ * 
+ * @return true if found.
+ */
+bool INA226CalibrationCache::find(uint16_t busID, uint8_t devAddr, uint16_t dieID, Profile& profile)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const Profile& item : profiles) {
+        if (item.busID == busID && item.devAddr == devAddr && item.dieID == dieID) {
+            profile=item;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Add or replace (same bus, address and die ID) a profile; it will be written by next save().
+ */
+void INA226CalibrationCache::store(const Profile& profile)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    Profile record=profile;
+    record.reserved=0;
+    record.reserved2=0;
+
+    dirty=true;
+    for (Profile& item : profiles) {
+        if (item.busID == record.busID && item.devAddr == record.devAddr && item.dieID == record.dieID) {
+            item=record;
+            return;
+        }
+    }
+    if (profiles.size() < UINT16_MAX) {
+        profiles.push_back(record);
+    }
+}
+
+/**
+ * @brief Remove all profiles (the file is emptied by next save()).
+ */
+void INA226CalibrationCache::clear(void)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    profiles.clear();
+    dirty=true;
+}
+
+size_t INA226CalibrationCache::size(void)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return profiles.size();
+}
+
+std::string INA226CalibrationCache::getLastError(void)
+{
+    return lastErrorString;
+}
@@ -0,0 +1,55 @@
+/*
+ * INA226CalibrationCache - persisted INA226 calibration profiles
+ *
+ * Copyright (C) 2025 Fabio Durigon.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ */
+
+#ifndef INA226CalibrationCache_H
+#define INA226CalibrationCache_H
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class INA226CalibrationCache {
+    public:
+        //! Computed registers of a device for a shunt/max current pair.
+        struct Profile {
+            uint16_t busID;         // /dev/i2c-N
+            uint8_t devAddr;
+            uint8_t reserved;
+            uint16_t dieID;
+            uint16_t config;        // CONFIG register
+            uint16_t calibration;   // CALIBRATION register
+            uint16_t reserved2;
+            float shuntOhm;         // begin() parameters the profile was computed for
+            float maxCurrent;
+            float currentLsb;       // A/bit
+        };
+
+        INA226CalibrationCache(const std::string& filePath);
+        ~INA226CalibrationCache();
+
+        bool load(void);
+        bool save(void);
+        bool find(uint16_t busID, uint8_t devAddr, uint16_t dieID, Profile& profile);
+        void store(const Profile& profile);
+        void clear(void);
+        size_t size(void);
+        std::string getLastError(void);
+
+    private:
+        std::string path;
+        std::vector<Profile> profiles;
+        bool dirty;
+        std::mutex mutex;
+        std::string lastErrorString;
+};
+
+#endif
@@ -34,13 +34,20 @@
 
 #define CURRENT_LSB 	0.000015625
 #define SHUNT_CAL	1024
+#define SHUNT_CAL_MAX	32767
+#define ADC_CONFIG_POR	0xFB68
+
+#define ERR_SHUNT_CAL_RANGE	"Shunt calibration out of range"
+#define ERR_RATE_TOO_HIGH	"Sample rate too high"
 
 #include "INA228.h"
-#include <byteswap.h>
 
 INA228::INA228(uint8_t deviceAddr, DI2CBusHandle i2cBusHandle) : DI2CMaster(i2cBusHandle)
 {
     devAddr=deviceAddr;
+    currentLsb=CURRENT_LSB;
+    shuntCal=SHUNT_CAL;
+    adcConfig.raw=ADC_CONFIG_POR;
 }
 
 INA228::~INA228()
@@ -51,20 +58,21 @@ INA228::~INA228()
 bool INA228::begin(void)
 {
 	bool ret=writeWord(devAddr,INA228_CONFIG, 0x8000);	// Reset
-	ret&=writeWord(devAddr,INA228_SHUNT_CAL, SHUNT_CAL);	// Average over 16 Samples
+	ret&=writeWord(devAddr,INA228_SHUNT_CAL, shuntCal);
+	if (ret && adcConfig.raw != ADC_CONFIG_POR) {
+		ret=RegMap::write(*this, devAddr, adcConfig);
+	}
     return ret;
 }
 
 float INA228::voltage(void)
 {
-	int32_t iBusVoltage;
+	int32_t iBusVoltage = 0;
 	float fBusVoltage;
-	bool sign;
 
-	askForBuf(devAddr,INA228_VBUS,(uint8_t *)&iBusVoltage, 3);
-	sign = iBusVoltage & 0x80;
-	iBusVoltage = bswap_32(iBusVoltage & 0xFFFFFF) >> 12;
-	if (sign) iBusVoltage += 0xFFF00000;
+	// 24 bit register, 20 bit value in D23-D4
+	askFor<int32_t,std::endian::big,3>(devAddr, INA228_VBUS, iBusVoltage);
+	iBusVoltage >>= 4;
 	fBusVoltage = (iBusVoltage) * 0.0001953125;
 
 	return (fBusVoltage);
@@ -83,14 +91,12 @@ float INA228::dietemp()
 
 float INA228::shuntvoltage(void)
 {
-	int32_t iShuntVoltage;
+	int32_t iShuntVoltage = 0;
 	float fShuntVoltage;
-	bool sign;
 
-	askForBuf(devAddr, INA228_VSHUNT,(uint8_t *)&iShuntVoltage, 3);
-	sign = iShuntVoltage & 0x80;
-	iShuntVoltage = bswap_32(iShuntVoltage & 0xFFFFFF) >> 12;
-	if (sign) iShuntVoltage += 0xFFF00000;
+	// 24 bit register, 20 bit value in D23-D4
+	askFor<int32_t,std::endian::big,3>(devAddr, INA228_VSHUNT, iShuntVoltage);
+	iShuntVoltage >>= 4;
 
 	fShuntVoltage = (iShuntVoltage) * 0.0003125;		// Output in mV when ADCRange = 0
 	//fShuntVoltage = (iShuntVoltage) * 0.000078125;	// Output in mV when ADCRange = 1
@@ -100,27 +106,24 @@ float INA228::shuntvoltage(void)
 
 float INA228::current(void)
 {
-	int32_t iCurrent;
+	int32_t iCurrent = 0;
 	float fCurrent;
-	bool sign;
 
-	askForBuf(devAddr,INA228_CURRENT,(uint8_t *)&iCurrent, 3);
-	sign = iCurrent & 0x80;
-	iCurrent = bswap_32(iCurrent & 0xFFFFFF) >> 12;
-	if (sign) iCurrent += 0xFFF00000;
-	fCurrent = (iCurrent) * CURRENT_LSB;
+	// 24 bit register, 20 bit value in D23-D4
+	askFor<int32_t,std::endian::big,3>(devAddr, INA228_CURRENT, iCurrent);
+	iCurrent >>= 4;
+	fCurrent = (iCurrent) * currentLsb;
 
 	return (fCurrent);
 }
 
 float INA228::power(void)
 {
-	uint32_t iPower;
+	uint32_t iPower = 0;
 	float fPower;
 
-	askForBuf(devAddr,INA228_POWER,(uint8_t *)&iPower, 3);
-	iPower = bswap_32(iPower & 0xFFFFFF) >> 8;
-	fPower = 3.2 * CURRENT_LSB * iPower;
+	askFor<uint32_t,std::endian::big,3>(devAddr, INA228_POWER, iPower);
+	fPower = 3.2 * currentLsb * iPower;
 
 	return (fPower);
 }
@@ -133,13 +136,12 @@ float INA228::power(void)
 
 float INA228::energy(void)
 {
-	uint64_t iEnergy;
+	uint64_t iEnergy = 0;
 	float fEnergy;
 
-	askForBuf(devAddr,INA228_ENERGY,(uint8_t *)&iEnergy, 5);
-	iEnergy = bswap_64(iEnergy & 0xFFFFFFFFFF) >> 24;
+	askFor<uint64_t,std::endian::big,5>(devAddr, INA228_ENERGY, iEnergy);
 
-	fEnergy = 16 * 3.2 * CURRENT_LSB * iEnergy;
+	fEnergy = 16 * 3.2 * currentLsb * iEnergy;
 
 	return (fEnergy);
 }
@@ -152,20 +154,266 @@ float INA228::energy(void)
 
 float INA228::charge(void)
 {
-	int64_t iCharge;
+	int64_t iCharge = 0;
 	float fCharge;
-	bool sign;
 
-	askForBuf(devAddr,INA228_CHARGE,(uint8_t *)&iCharge, 5);
-	sign = iCharge & 0x80;
-	iCharge = bswap_64(iCharge & 0xFFFFFFFFFF) >> 24;
-	if (sign) iCharge += 0xFFFFFF0000000000;
+	askFor<int64_t,std::endian::big,5>(devAddr, INA228_CHARGE, iCharge);
 
-	fCharge = CURRENT_LSB * iCharge;
+	fCharge = currentLsb * iCharge;
 
 	return (fCharge);
 }
 
+/*
+ * Reads VSHUNT, VBUS, DIETEMP, CURRENT, POWER, ENERGY and CHARGE in a single
+ * ioctl (one repeated start burst for each register, INA228 does not
+ * auto-increment) and decodes them (branch-free sign extension).
+ */
+
+bool INA228::readAllRaw(INA228::RawMeasurements& raw)
+{
+	RegMap::Reader<Regs::VshuntValue, Regs::VbusValue, Regs::DietempValue, Regs::CurrentValue,
+				   Regs::Power, Regs::Energy, Regs::ChargeValue> reader;
+
+	if (!reader.read(*this, devAddr)) {
+		return false;
+	}
+
+	raw.shuntVoltage = reader.get<Regs::VshuntValue>();
+	raw.busVoltage = reader.get<Regs::VbusValue>();
+	raw.dieTemp = reader.get<Regs::DietempValue>();
+	raw.current = reader.get<Regs::CurrentValue>();
+	raw.power = reader.get<Regs::Power>();
+	raw.energy = reader.get<Regs::Energy>();
+	raw.charge = reader.get<Regs::ChargeValue>();
+	return true;
+}
+
+/*
+ * Same as readAllRaw() but in engineering units (see Measurements).
+ */
+
+bool INA228::readAll(INA228::Measurements& values)
+{
+	RawMeasurements raw;
+	if (!readAllRaw(raw)) {
+		return false;
+	}
+
+	values.shuntVoltage = raw.shuntVoltage * 0.0003125;		// ADCRange = 0
+	values.busVoltage = raw.busVoltage * 0.0001953125;
+	values.dieTemp = raw.dieTemp * 0.0078125;
+	values.current = raw.current * currentLsb;
+	values.power = 3.2 * currentLsb * raw.power;
+	values.energy = 16 * 3.2 * currentLsb * raw.energy;
+	values.charge = currentLsb * raw.charge;
+	return true;
+}
+
+/*
+ * Reads ENERGY and CHARGE accumulators (register LSB) in a single ioctl.
+ */
+
+bool INA228::readAccumulators(uint64_t& energy, int64_t& charge)
+{
+	RegMap::Reader<Regs::Energy, Regs::ChargeValue> reader;
+
+	if (!reader.read(*this, devAddr)) {
+		return false;
+	}
+
+	energy = reader.get<Regs::Energy>();
+	charge = reader.get<Regs::ChargeValue>();
+	return true;
+}
+
+/*
+ * Current register resolution in A/bit and power register resolution in
+ * W/bit, to scale raw values (see INAScale).
+ */
+
+float INA228::getCurrentLsb(void)
+{
+	return currentLsb;
+}
+
+float INA228::getPowerLsb(void)
+{
+	return POWER_LSB_FACTOR * currentLsb;
+}
+
+/*
+ * ENERGY register resolution in J/bit and CHARGE register resolution in
+ * C/bit.
+ */
+
+float INA228::getEnergyLsb(void)
+{
+	return 16 * 3.2 * currentLsb;
+}
+
+float INA228::getChargeLsb(void)
+{
+	return currentLsb;
+}
+
+/*
+ * Runtime calibration (ADCRANGE = 0):
+ * CURRENT_LSB = maxCurrent / 2^19
+ * SHUNT_CAL = 13107.2 x 10^6 x CURRENT_LSB x Rshunt
+ * SHUNT_CAL is written immediately if the bus is ready, and again by begin().
+ */
+
+bool INA228::setShunt(float shuntOhm, float maxCurrent)
+{
+	float lsb = maxCurrent / 524288.0;
+	double cal = SHUNT_CAL_SCALE * lsb * shuntOhm;
+	if (cal < 1 || cal > SHUNT_CAL_MAX) {
+		lastErrorString = ERR_SHUNT_CAL_RANGE;
+		return false;
+	}
+
+	currentLsb = lsb;
+	shuntCal = uint16_t(cal + 0.5);
+	return writeWord(devAddr, INA228_SHUNT_CAL, shuntCal);
+}
+
+/*
+ * Clears ENERGY and CHARGE accumulators.
+ */
+
+bool INA228::resetAccumulators(void)
+{
+	return RegMap::modify<Regs::Rstacc>(*this, devAddr, true);
+}
+
+/*
+ * ADC_CONFIG: operating mode, conversion times and averaging. The
+ * configuration is kept and written again by begin() (reset restores POR
+ * values).
+ */
+
+bool INA228::setAdcConfig(const INA228::AdcConfig& config)
+{
+	DI2CRegValue<Regs::AdcConfig> value;
+	value.set<Regs::Mode>(config.mode);
+	value.set<Regs::Vbusct>(config.busCt);
+	value.set<Regs::Vshct>(config.shuntCt);
+	value.set<Regs::Vtct>(config.tempCt);
+	value.set<Regs::Avg>(config.avg);
+	if (!RegMap::write(*this, devAddr, value)) {
+		return false;
+	}
+	adcConfig = value;
+	return true;
+}
+
+bool INA228::getAdcConfig(INA228::AdcConfig& config)
+{
+	DI2CRegValue<Regs::AdcConfig> value;
+	if (!RegMap::read(*this, devAddr, value)) {
+		return false;
+	}
+	config.mode = value.get<Regs::Mode>();
+	config.busCt = value.get<Regs::Vbusct>();
+	config.shuntCt = value.get<Regs::Vshct>();
+	config.tempCt = value.get<Regs::Vtct>();
+	config.avg = value.get<Regs::Avg>();
+	return true;
+}
+
+/*
+ * Sets conversion times and averaging giving sampleRateHz results per
+ * second with the lowest noise for the channels of mode (see INAAdcTuner).
+ * Returns false if the rate can't be reached (fastest settings are set
+ * anyway).
+ */
+
+bool INA228::tuneAdc(float sampleRateHz, INA228::Mode mode)
+{
+	INAAdcChoice choice;
+	bool reached = INAAdcTuner::tune(INAAdcTuner::INA228_CONV_TIME_US, mode & 0x2, mode & 0x1, mode & 0x4, sampleRateHz, choice);
+	AdcConfig config = { mode, ConvTime(choice.busCt), ConvTime(choice.shuntCt), ConvTime(choice.tempCt), Averaging(choice.avg) };
+	if (!setAdcConfig(config)) {
+		return false;
+	}
+	if (!reached) {
+		lastErrorString = ERR_RATE_TOO_HIGH;
+	}
+	return reached;
+}
+
+/*
+ * Time between two averaged results of the configured channels.
+ */
+
+uint32_t INA228::getConversionPeriodUs(void)
+{
+	AdcConfig config = { adcConfig.get<Regs::Mode>(), adcConfig.get<Regs::Vbusct>(), adcConfig.get<Regs::Vshct>(),
+						 adcConfig.get<Regs::Vtct>(), adcConfig.get<Regs::Avg>() };
+	return conversionPeriodUs(config);
+}
+
+uint32_t INA228::conversionPeriodUs(const INA228::AdcConfig& config)
+{
+	INAAdcChoice choice = { uint8_t(config.shuntCt), uint8_t(config.busCt), uint8_t(config.tempCt), uint8_t(config.avg), 0 };
+	return INAAdcTuner::periodUs(INAAdcTuner::INA228_CONV_TIME_US, config.mode & 0x2, config.mode & 0x1, config.mode & 0x4, choice);
+}
+
+static const DSensorChannel INA228Channels[] = {
+	{ "shunt voltage", QUANTITY_VOLTAGE, "V" },
+	{ "bus voltage", QUANTITY_VOLTAGE, "V" },
+	{ "die temperature", QUANTITY_TEMPERATURE, "C" },
+	{ "current", QUANTITY_CURRENT, "A" },
+	{ "power", QUANTITY_POWER, "W" },
+	{ "energy", QUANTITY_ENERGY, "J" },
+	{ "charge", QUANTITY_CHARGE, "C" }
+};
+
+/*
+ * DSensor channels (see SensorChannel).
+ */
+
+std::span<const DSensorChannel> INA228::getChannels(void)
+{
+	return INA228Channels;
+}
+
+/*
+ * DSensor preferred period: the conversion period of ADC_CONFIG, reading faster gives the same values again.
+ */
+
+uint32_t INA228::getPreferredPeriodUs(void)
+{
+	return getConversionPeriodUs();
+}
+
+/*
+ * DSensor read: all measurement registers in a single ioctl (see readAllRaw()), one sample for each channel, in
+ * double precision (energy and charge keep all 40 bits).
+ */
+
+bool INA228::readInto(std::span<DSensorSample> samples, size_t& count)
+{
+	RawMeasurements raw;
+
+	count = 0;
+	if (samples.size() < std::size(INA228Channels) || !readAllRaw(raw)) {
+		return false;
+	}
+
+	uint64_t timestampUs = monotonicUs();
+	samples[0] = { timestampUs, raw.shuntVoltage * double(SHUNT_VOLTAGE_LSB), 0, CH_SHUNT_VOLTAGE };
+	samples[1] = { timestampUs, raw.busVoltage * double(BUS_VOLTAGE_LSB), 0, CH_BUS_VOLTAGE };
+	samples[2] = { timestampUs, raw.dieTemp * double(DIETEMP_LSB), 0, CH_DIETEMP };
+	samples[3] = { timestampUs, raw.current * double(currentLsb), 0, CH_CURRENT };
+	samples[4] = { timestampUs, raw.power * double(getPowerLsb()), 0, CH_POWER };
+	samples[5] = { timestampUs, raw.energy * double(getEnergyLsb()), 0, CH_ENERGY };
+	samples[6] = { timestampUs, raw.charge * double(getChargeLsb()), 0, CH_CHARGE };
+	count = std::size(INA228Channels);
+	return true;
+}
+
 std::string INA228::getInfo(void)
 {
     std::string info;
@@ -47,9 +47,146 @@
 #define INA228_DEVICE_ID		0x3F
 
 #include <di2cmaster>
+#include <di2cregmap>
+#include <dsensor>
+#include <INAAdcTuner/INAAdcTuner.h>
 
-class INA228 : public DI2CMaster {
+class INA228 : public DI2CMaster, public DSensor {
     public:
+        //! ADC_CONFIG operating mode (D15-D12)
+        enum Mode {
+            MODE_SHUTDOWN = 0x0,
+            MODE_TRIG_BUS = 0x1,
+            MODE_TRIG_SHUNT = 0x2,
+            MODE_TRIG_SHUNT_BUS = 0x3,
+            MODE_TRIG_TEMP = 0x4,
+            MODE_TRIG_TEMP_BUS = 0x5,
+            MODE_TRIG_TEMP_SHUNT = 0x6,
+            MODE_TRIG_ALL = 0x7,
+            MODE_CONT_BUS = 0x9,
+            MODE_CONT_SHUNT = 0xA,
+            MODE_CONT_SHUNT_BUS = 0xB,
+            MODE_CONT_TEMP = 0xC,
+            MODE_CONT_TEMP_BUS = 0xD,
+            MODE_CONT_TEMP_SHUNT = 0xE,
+            MODE_CONT_ALL = 0xF          // POR
+        };
+
+        //! Conversion time of VBUS, VSHUNT and temperature (VBUSCT, VSHCT, VTCT)
+        enum ConvTime {
+            CT_50US = 0,
+            CT_84US = 1,
+            CT_150US = 2,
+            CT_280US = 3,
+            CT_540US = 4,
+            CT_1052US = 5,                  // POR
+            CT_2074US = 6,
+            CT_4120US = 7
+        };
+
+        //! Number of averages (AVG)
+        enum Averaging {
+            AVG_1 = 0,                      // POR
+            AVG_4 = 1,
+            AVG_16 = 2,
+            AVG_64 = 3,
+            AVG_128 = 4,
+            AVG_256 = 5,
+            AVG_512 = 6,
+            AVG_1024 = 7
+        };
+
+        //! ADC configuration.
+        struct AdcConfig {
+            INA228::Mode mode;
+            INA228::ConvTime busCt;
+            INA228::ConvTime shuntCt;
+            INA228::ConvTime tempCt;
+            INA228::Averaging avg;
+        };
+
+        //! Register map
+        struct Regs {
+            // Measurement values (20 bit values are in D23-D4, sign extended when decoded)
+            struct VshuntValue  : DI2CField<4,20,int32_t> {};       // D23-D4  Shunt voltage
+            struct VbusValue    : DI2CField<4,20,int32_t> {};       // D23-D4  Bus voltage (always positive)
+            struct DietempValue : DI2CField<0,16,int16_t> {};       // D15-D0  Die temperature
+            struct CurrentValue : DI2CField<4,20,int32_t> {};       // D23-D4  Current
+            struct ChargeValue  : DI2CField<0,40,int64_t> {};       // D39-D0  Charge
+            // Configuration register fields
+            struct Adcrange     : DI2CField<4,1,bool> {};           // D4      Shunt full scale range (1 = 40.96 mV)
+            struct Tempcomp     : DI2CField<5,1,bool> {};           // D5      Shunt temperature compensation
+            struct Convdly      : DI2CField<6,8> {};                // D13-D6  Initial conversion delay (2 ms steps)
+            struct Rstacc       : DI2CField<14,1,bool> {};          // D14     Reset ENERGY and CHARGE accumulators
+            struct Rst          : DI2CField<15,1,bool> {};          // D15     Reset
+            // ADC configuration register fields
+            struct Avg          : DI2CField<0,3,INA228::Averaging> {};  // D2-D0   Averaging
+            struct Vtct         : DI2CField<3,3,INA228::ConvTime> {};   // D5-D3   Temperature conversion time
+            struct Vshct        : DI2CField<6,3,INA228::ConvTime> {};   // D8-D6   Shunt voltage conversion time
+            struct Vbusct       : DI2CField<9,3,INA228::ConvTime> {};   // D11-D9  Bus voltage conversion time
+            struct Mode         : DI2CField<12,4,INA228::Mode> {};      // D15-D12 Operating mode
+            // Diagnostic flags and alert register fields
+            struct Cnvrf        : DI2CField<1,1,bool> {};           // D1      Conversion ready flag
+
+            using Config         = DI2CRegister<INA228_CONFIG, 2, ACCESS_READ_WRITE, std::endian::big, Adcrange, Tempcomp, Convdly, Rstacc, Rst>;
+            using AdcConfig      = DI2CRegister<INA228_ADC_CONFIG, 2, ACCESS_READ_WRITE, std::endian::big, Avg, Vtct, Vshct, Vbusct, Mode>;
+            using ShuntCal       = DI2CRegister<INA228_SHUNT_CAL, 2>;
+            using ShuntTempco    = DI2CRegister<INA228_SHUNT_TEMPCO, 2>;
+            using Vshunt         = DI2CRegister<INA228_VSHUNT, 3, ACCESS_READ_ONLY, std::endian::big, VshuntValue>;
+            using Vbus           = DI2CRegister<INA228_VBUS, 3, ACCESS_READ_ONLY, std::endian::big, VbusValue>;
+            using Dietemp        = DI2CRegister<INA228_DIETEMP, 2, ACCESS_READ_ONLY, std::endian::big, DietempValue>;
+            using Current        = DI2CRegister<INA228_CURRENT, 3, ACCESS_READ_ONLY, std::endian::big, CurrentValue>;
+            using Power          = DI2CRegister<INA228_POWER, 3, ACCESS_READ_ONLY>;
+            using Energy         = DI2CRegister<INA228_ENERGY, 5, ACCESS_READ_ONLY>;
+            using Charge         = DI2CRegister<INA228_CHARGE, 5, ACCESS_READ_ONLY, std::endian::big, ChargeValue>;
+            using DiagAlrt       = DI2CRegister<INA228_DIAG_ALRT, 2, ACCESS_READ_WRITE, std::endian::big, Cnvrf>;
+            using ManufacturerID = DI2CRegister<INA228_MANUFACTURER_ID, 2, ACCESS_READ_ONLY>;
+            using DeviceID       = DI2CRegister<INA228_DEVICE_ID, 2, ACCESS_READ_ONLY>;
+        };
+        //! INA228 does not auto-increment the register pointer
+        using RegMap = DI2CRegMap<false, Regs::Config, Regs::AdcConfig, Regs::ShuntCal, Regs::ShuntTempco, Regs::Vshunt,
+                                  Regs::Vbus, Regs::Dietemp, Regs::Current, Regs::Power, Regs::Energy, Regs::Charge,
+                                  Regs::DiagAlrt, Regs::ManufacturerID, Regs::DeviceID>;
+
+        //! All measurement registers (VSHUNT..CHARGE) decoded, in register LSB.
+        struct RawMeasurements {
+            int32_t shuntVoltage;   // 20 bit signed
+            int32_t busVoltage;     // 20 bit
+            int16_t dieTemp;        // 16 bit signed
+            int32_t current;        // 20 bit signed
+            uint32_t power;         // 24 bit
+            uint64_t energy;        // 40 bit
+            int64_t charge;         // 40 bit signed
+        };
+
+        //! All measurement registers in engineering units.
+        struct Measurements {
+            float shuntVoltage;     // mV
+            float busVoltage;       // V
+            float dieTemp;          // Celsius
+            float current;          // A
+            float power;            // W
+            float energy;           // J
+            float charge;           // C
+        };
+
+        //! DSensor channels (index of DSensorSample::channel).
+        enum SensorChannel {
+            CH_SHUNT_VOLTAGE = 0,   // V
+            CH_BUS_VOLTAGE = 1,     // V
+            CH_DIETEMP = 2,         // Celsius
+            CH_CURRENT = 3,         // A
+            CH_POWER = 4,           // W
+            CH_ENERGY = 5,          // J
+            CH_CHARGE = 6           // C
+        };
+
+        static constexpr float SHUNT_VOLTAGE_LSB = 312.5e-9f;      // V (ADCRange = 0)
+        static constexpr float BUS_VOLTAGE_LSB = 195.3125e-6f;     // V
+        static constexpr float DIETEMP_LSB = 7.8125e-3f;           // Celsius
+        static constexpr float POWER_LSB_FACTOR = 3.2f;            // x current LSB
+        static constexpr double SHUNT_CAL_SCALE = 13107.2e6;       // SHUNT_CAL = SHUNT_CAL_SCALE x current LSB x shunt (ADCRange = 0)
+
         INA228(uint8_t deviceAddr, DI2CBusHandle i2cBusHandle);
         ~INA228();
         bool begin(void);
@@ -60,11 +197,33 @@ class INA228 : public DI2CMaster {
         float power(void);
         float energy(void);
         float charge(void);
+        bool readAllRaw(INA228::RawMeasurements& raw);
+        bool readAll(INA228::Measurements& values);
+        bool readAccumulators(uint64_t& energy, int64_t& charge);
+        float getCurrentLsb(void);
+        float getPowerLsb(void);
+        float getEnergyLsb(void);
+        float getChargeLsb(void);
+        bool setShunt(float shuntOhm, float maxCurrent);
+        bool resetAccumulators(void);
+        bool setAdcConfig(const INA228::AdcConfig& config);
+        bool getAdcConfig(INA228::AdcConfig& config);
+        bool tuneAdc(float sampleRateHz, INA228::Mode mode = MODE_CONT_SHUNT_BUS);
+        uint32_t getConversionPeriodUs(void);
+        static uint32_t conversionPeriodUs(const INA228::AdcConfig& config);
+
+        // DSensor
+        std::span<const DSensorChannel> getChannels(void) override;
+        uint32_t getPreferredPeriodUs(void) override;
+        bool readInto(std::span<DSensorSample> samples, size_t& count) override;
 
         std::string getInfo(void);
 
     private:
         uint8_t devAddr;
+        float currentLsb;   // Current resolution -> A/bit
+        uint16_t shuntCal;  // SHUNT_CAL register value
+        DI2CRegValue<Regs::AdcConfig> adcConfig;    // written by begin() after reset
 };
 
 #endif
@@ -0,0 +1,199 @@
+/*
+ * INA228EnergyMeter - long term energy/charge metering with INA228
+ *
+ * Copyright (C) 2025 Fabio Durigon.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ */
+
+/*
+ * ENERGY (unsigned) and CHARGE (signed) are 40 bit accumulators: at full
+ * scale ENERGY wraps after about 12 days, and both restart from zero on a
+ * power cycle or RSTACC. update() reads both in one ioctl, every few
+ * seconds is enough, and extends them to 64 bit totals:
+ * - the modular difference from the previous reading is a wrap when it is
+ *   compatible with the full scale rate in the elapsed time.
+ * - otherwise the accumulator was reset, and the new reading is all the
+ *   energy/charge since the reset.
+ *
+ * Full scale rates, in register LSB per second:
+ * ENERGY: POWER max (2^24) x power LSB / (16 x power LSB) = 2^20 LSB/s
+ * CHARGE: CURRENT max (2^19) x current LSB x 1 s / current LSB = 2^19 LSB/s
+ */
+
+#include "INA228EnergyMeter.h"
+#include <chrono>
+
+#define ACC_BITS            40
+#define ACC_MASK            ((uint64_t(1) << ACC_BITS) - 1)
+#define ENERGY_MAX_RATE     (uint64_t(1) << 20)
+#define CHARGE_MAX_RATE     (uint64_t(1) << 19)
+
+/**
+ * @param ina228            ->  the sensor (calibrate it with INA228::setShunt() before begin()).
+ * @param historyCapacity   ->  number of intervals kept for popInterval().
+ */
+INA228EnergyMeter::INA228EnergyMeter(INA228& ina228, size_t historyCapacity) : ina(ina228)
+{
+    history=std::make_unique<DRingBuffer<Interval>>(historyCapacity);
+}
+
+/**
+ * @brief Take the first reading as baseline (totals start from zero).
+ * 
+ * @param resetChip ->  also clear chip accumulators.
+ * @return true on success, otherwise false (you can retrieve the error by calling ina228.getLastError()).
+ */
+bool INA228EnergyMeter::begin(bool resetChip)
+{
+    if (resetChip && !ina.resetAccumulators()) {
+        return false;
+    }
+
+    if (!ina.readAccumulators(lastEnergyRaw, lastChargeRaw)) {
+        return false;
+    }
+    lastUpdateUs=nowUs();
+    started=true;
+    return true;
+}
+
+/**
+ * @brief Read accumulators and add the interval since last update to totals.
+ * 
+ * @return true on success, otherwise false (you can retrieve the error by calling ina228.getLastError()).
+ */
+bool INA228EnergyMeter::update(void)
+{
+    if (!started) {
+        return begin();
+    }
+
+    uint64_t energyRaw;
+    int64_t chargeRaw;
+    if (!ina.readAccumulators(energyRaw, chargeRaw)) {
+        return false;
+    }
+    uint64_t timestampUs=nowUs();
+    uint64_t elapsedUs=timestampUs-lastUpdateUs;
+
+    // Max plausible change (full scale rate, 2x margin and 1s for timing jitter)
+    uint64_t elapsedS=elapsedUs/1000000+1;
+    uint64_t energyMax=ENERGY_MAX_RATE*elapsedS*2;
+    uint64_t chargeMax=CHARGE_MAX_RATE*elapsedS*2;
+
+    Interval interval={};
+    uint64_t energyDelta=(energyRaw-lastEnergyRaw) & ACC_MASK;
+    if (energyDelta > energyMax) {
+        // Went backward: accumulators restarted from zero
+        energyDelta=energyRaw;
+        interval.resetDetected=true;
+    }
+    else if (energyRaw < lastEnergyRaw) {
+        wrapCount++;
+    }
+
+    // Signed modular difference (sign extended from 40 bits)
+    int64_t chargeDelta=int64_t(uint64_t(chargeRaw-lastChargeRaw) << (64-ACC_BITS)) >> (64-ACC_BITS);
+    uint64_t chargeAbs=chargeDelta < 0 ? uint64_t(-chargeDelta) : uint64_t(chargeDelta);
+    if (interval.resetDetected || chargeAbs > chargeMax) {
+        chargeDelta=chargeRaw;
+        interval.resetDetected=true;
+    }
+    if (interval.resetDetected) {
+        resetCount++;
+    }
+
+    totalEnergyRaw+=energyDelta;
+    totalChargeRaw+=chargeDelta;
+    lastEnergyRaw=energyRaw;
+    lastChargeRaw=chargeRaw;
+    lastUpdateUs=timestampUs;
+
+    interval.timestampUs=timestampUs;
+    interval.durationUs=elapsedUs;
+    interval.energy=double(energyDelta)*ina.getEnergyLsb();
+    interval.charge=double(chargeDelta)*ina.getChargeLsb();
+    if (elapsedUs > 0) {
+        interval.avgPower=interval.energy*1e6/elapsedUs;
+        interval.avgCurrent=interval.charge*1e6/elapsedUs;
+    }
+    lastInterval=interval;
+    hasInterval=true;
+    history->push(interval);
+    return true;
+}
+
+/**
+ * @brief Restart totals from zero (chip accumulators are untouched).
+ */
+void INA228EnergyMeter::clearTotals(void)
+{
+    totalEnergyRaw=0;
+    totalChargeRaw=0;
+    wrapCount=0;
+    resetCount=0;
+}
+
+//! @return energy since begin() in J.
+double INA228EnergyMeter::getTotalEnergy(void)
+{
+    return double(totalEnergyRaw)*ina.getEnergyLsb();
+}
+
+//! @return charge since begin() in C.
+double INA228EnergyMeter::getTotalCharge(void)
+{
+    return double(totalChargeRaw)*ina.getChargeLsb();
+}
+
+//! @return energy since begin() in ENERGY register LSB (64 bit).
+uint64_t INA228EnergyMeter::getTotalEnergyRaw(void)
+{
+    return totalEnergyRaw;
+}
+
+//! @return charge since begin() in CHARGE register LSB (64 bit).
+int64_t INA228EnergyMeter::getTotalChargeRaw(void)
+{
+    return totalChargeRaw;
+}
+
+/**
+ * @brief Get the interval of last update().
+ * @return false if update() has never been called.
+ */
+bool INA228EnergyMeter::getLastInterval(Interval& interval)
+{
+    interval=lastInterval;
+    return hasInterval;
+}
+
+/**
+ * @brief Get the oldest interval not yet popped (history keeps historyCapacity intervals, newer ones are dropped).
+ * @return false if no intervals are available.
+ */
+bool INA228EnergyMeter::popInterval(Interval& interval)
+{
+    return history->pop(interval);
+}
+
+//! @return number of ENERGY accumulator wraps.
+uint32_t INA228EnergyMeter::getWrapCount(void)
+{
+    return wrapCount;
+}
+
+//! @return number of accumulators resets detected.
+uint32_t INA228EnergyMeter::getResetCount(void)
+{
+    return resetCount;
+}
+
+uint64_t INA228EnergyMeter::nowUs(void)
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
@@ -0,0 +1,67 @@
+/*
+ * INA228EnergyMeter - long term energy/charge metering with INA228
+ *
+ * Copyright (C) 2025 Fabio Durigon.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ */
+
+#ifndef INA228EnergyMeter_H
+#define INA228EnergyMeter_H
+
+#include <cstdint>
+#include <memory>
+#include <dringbuffer>
+#include "INA228.h"
+
+class INA228EnergyMeter {
+    public:
+        //! Energy and charge of one update() interval.
+        struct Interval {
+            uint64_t timestampUs;   // steady clock microseconds at end of interval
+            uint64_t durationUs;
+            double energy;          // J
+            double charge;          // C
+            double avgPower;        // W
+            double avgCurrent;      // A
+            bool resetDetected;     // accumulators were reset (power cycle, RSTACC) during the interval
+        };
+
+        INA228EnergyMeter(INA228& ina228, size_t historyCapacity = 64);
+
+        bool begin(bool resetChip = false);
+        bool update(void);
+        void clearTotals(void);
+
+        double getTotalEnergy(void);        // J
+        double getTotalCharge(void);        // C
+        uint64_t getTotalEnergyRaw(void);   // ENERGY LSB
+        int64_t getTotalChargeRaw(void);    // CHARGE LSB
+        bool getLastInterval(Interval& interval);
+        bool popInterval(Interval& interval);
+        uint32_t getWrapCount(void);
+        uint32_t getResetCount(void);
+
+    private:
+        static uint64_t nowUs(void);
+
+        INA228& ina;
+        std::unique_ptr<DRingBuffer<Interval>> history;
+        Interval lastInterval = {};
+        bool hasInterval = false;
+
+        bool started = false;
+        uint64_t lastEnergyRaw = 0;     // last 40 bit register values
+        int64_t lastChargeRaw = 0;
+        uint64_t lastUpdateUs = 0;
+
+        uint64_t totalEnergyRaw = 0;    // 64 bit extended totals
+        int64_t totalChargeRaw = 0;
+        uint32_t wrapCount = 0;
+        uint32_t resetCount = 0;
+};
+
+#endif
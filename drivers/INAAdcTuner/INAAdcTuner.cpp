@@ -0,0 +1,90 @@
+/*
+ * INAAdcTuner - ADC conversion time / averaging selection for INA226/INA228
+ *
+ * Copyright (C) 2025 Fabio Durigon.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ */
+
+#include "INAAdcTuner.h"
+#include <algorithm>
+#include <tuple>
+
+/**
+ * @brief Choose ADC settings for a sample rate.
+ * 
+ * @param convTimesUs   ->  conversion times of the chip (INA226_CONV_TIME_US or INA228_CONV_TIME_US).
+ * @param shunt         ->  shunt voltage is converted.
+ * @param bus           ->  bus voltage is converted.
+ * @param temp          ->  die temperature is converted (INA228 only).
+ * @param sampleRateHz  ->  requested rate of averaged results.
+ * @param choice        ->  chosen settings (conversion times of disabled channels are the shortest).
+ * @return true on success, false if the rate is higher than the fastest settings (choice is set to the fastest).
+ */
+bool INAAdcTuner::tune(std::span<const uint16_t, 8> convTimesUs, bool shunt, bool bus, bool temp, float sampleRateHz, INAAdcChoice& choice)
+{
+    const bool enabled[3]={ shunt, bus, temp };
+    uint32_t targetUs=sampleRateHz > 0 ? uint32_t(1e6/sampleRateHz) : UINT32_MAX;
+
+    // Score: min integration of enabled channels, shunt integration, bus integration, fewer averages
+    std::tuple<uint64_t,uint64_t,uint64_t,int> best{0,0,0,0};
+    bool found=false;
+    choice={0,0,0,0,0};
+
+    uint8_t ct[3];
+    for (uint8_t avg=0; avg<8; avg++) {
+        for (ct[0]=0; ct[0]<8; ct[0]++) {
+            for (ct[1]=0; ct[1]<8; ct[1]++) {
+                for (ct[2]=0; ct[2]<8; ct[2]++) {
+                    // Disabled channels use the shortest code only (it doesn't matter)
+                    if ((!shunt && ct[0]) || (!bus && ct[1]) || (!temp && ct[2])) {
+                        continue;
+                    }
+                    INAAdcChoice candidate={ct[0], ct[1], ct[2], avg, 0};
+                    candidate.periodUs=periodUs(convTimesUs, shunt, bus, temp, candidate);
+                    if (candidate.periodUs > targetUs) {
+                        continue;
+                    }
+
+                    uint64_t minIntegration=UINT64_MAX;
+                    for (int ixC=0; ixC<3; ixC++) {
+                        if (enabled[ixC]) {
+                            minIntegration=std::min<uint64_t>(minIntegration, uint64_t(convTimesUs[ct[ixC]])*AVG_COUNT[avg]);
+                        }
+                    }
+                    std::tuple<uint64_t,uint64_t,uint64_t,int> score{
+                        minIntegration,
+                        shunt ? uint64_t(convTimesUs[ct[0]])*AVG_COUNT[avg] : 0,
+                        bus ? uint64_t(convTimesUs[ct[1]])*AVG_COUNT[avg] : 0,
+                        -int(avg)
+                    };
+                    if (!found || score > best) {
+                        best=score;
+                        choice=candidate;
+                        found=true;
+                    }
+                }
+            }
+        }
+    }
+
+    if (!found) {
+        // Too fast: shortest conversions, no averaging
+        choice={0, 0, 0, 0, 0};
+        choice.periodUs=periodUs(convTimesUs, shunt, bus, temp, choice);
+    }
+    return found;
+}
+
+/**
+ * @return time between two averaged results with the given settings.
+ */
+uint32_t INAAdcTuner::periodUs(std::span<const uint16_t, 8> convTimesUs, bool shunt, bool bus, bool temp, const INAAdcChoice& choice)
+{
+    uint32_t conversionUs=(shunt ? convTimesUs[choice.shuntCt & 7] : 0) + (bus ? convTimesUs[choice.busCt & 7] : 0) +
+                          (temp ? convTimesUs[choice.tempCt & 7] : 0);
+    return conversionUs*AVG_COUNT[choice.avg & 7];
+}
@@ -0,0 +1,53 @@
+/*
+ * INAAdcTuner - ADC conversion time / averaging selection for INA226/INA228
+ *
+ * Copyright (C) 2025 Fabio Durigon.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ */
+
+#ifndef INAAdcTuner_H
+#define INAAdcTuner_H
+
+#include <cstdint>
+#include <span>
+
+/**
+ * @brief Chosen ADC settings: 3 bit codes of conversion times and averaging, as in the configuration registers.
+ */
+struct INAAdcChoice {
+    uint8_t shuntCt;        // VSHCT
+    uint8_t busCt;          // VBUSCT
+    uint8_t tempCt;         // VTCT (INA228 only)
+    uint8_t avg;            // AVG
+    uint32_t periodUs;      // time between two averaged results
+};
+
+/**
+ * @brief Picks conversion times and averaging giving a requested effective sample rate with the lowest noise.
+ *
+ * ADC noise goes down with the square root of the integration time of each result (conversion time x averages), so
+ * among the settings whose period (sum of conversion times of enabled channels x averages) fits the requested one:
+ * 1 - the smallest integration time among enabled channels is maximised (no channel is left noisy);
+ * 2 - then the shunt one (current is the noise sensitive measurement), then the bus one;
+ * 3 - then longer conversion times are preferred to more averages (same integration, fewer conversions).
+ *
+ * @code
+ * INAAdcChoice choice;
+ * INAAdcTuner::tune(INAAdcTuner::INA228_CONV_TIME_US, true, true, false, 1000, choice);     // 1 kHz
+ * @endcode
+ */
+class INAAdcTuner {
+    public:
+        static constexpr uint16_t INA226_CONV_TIME_US[8] = { 140, 204, 332, 588, 1100, 2116, 4156, 8244 };
+        static constexpr uint16_t INA228_CONV_TIME_US[8] = { 50, 84, 150, 280, 540, 1052, 2074, 4120 };
+        static constexpr uint16_t AVG_COUNT[8] = { 1, 4, 16, 64, 128, 256, 512, 1024 };
+
+        static bool tune(std::span<const uint16_t, 8> convTimesUs, bool shunt, bool bus, bool temp, float sampleRateHz, INAAdcChoice& choice);
+        static uint32_t periodUs(std::span<const uint16_t, 8> convTimesUs, bool shunt, bool bus, bool temp, const INAAdcChoice& choice);
+};
+
+#endif
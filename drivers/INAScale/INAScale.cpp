@@ -0,0 +1,93 @@
+/*
+ * INAScale - batch conversion of INA226/INA228 raw samples
+ *
+ * Copyright (C) 2025 Fabio Durigon.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ */
+
+#include "INAScale.h"
+#include <algorithm>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #include <arm_neon.h>
+    #define INASCALE_NEON
+#elif defined(__SSE2__)
+    #include <emmintrin.h>
+    #define INASCALE_SSE2
+#endif
+
+/**
+ * @brief Scale raw values to float: out[i] = raw[i] * lsb.
+ * Converts min(raw.size(), out.size()) values.
+ */
+void INAScale::toFloat(std::span<const int32_t> raw, float lsb, std::span<float> out)
+{
+    size_t count=std::min(raw.size(),out.size());
+    size_t ixV=0;
+
+#if defined(INASCALE_NEON)
+    for (; ixV+4<=count; ixV+=4) {
+        float32x4_t v=vcvtq_f32_s32(vld1q_s32(&raw[ixV]));
+        vst1q_f32(&out[ixV],vmulq_n_f32(v,lsb));
+    }
+#elif defined(INASCALE_SSE2)
+    __m128 vLsb=_mm_set1_ps(lsb);
+    for (; ixV+4<=count; ixV+=4) {
+        __m128 v=_mm_cvtepi32_ps(_mm_loadu_si128(reinterpret_cast<const __m128i *>(&raw[ixV])));
+        _mm_storeu_ps(&out[ixV],_mm_mul_ps(v,vLsb));
+    }
+#endif
+
+    toFloatScalar(raw.subspan(ixV,count-ixV),lsb,out.subspan(ixV,count-ixV));
+}
+
+/**
+ * @brief Plain loop version of toFloat().
+ */
+void INAScale::toFloatScalar(std::span<const int32_t> raw, float lsb, std::span<float> out)
+{
+    size_t count=std::min(raw.size(),out.size());
+    for (size_t ixV=0; ixV<count; ixV++) {
+        out[ixV]=raw[ixV]*lsb;
+    }
+}
+
+/**
+ * @brief Scale raw values to integer units: out[i] = round(raw[i] * mul / 2^shift).
+ * Converts min(raw.size(), out.size()) values, results must fit int32 (i.e. uV up to 2147 V).
+ */
+void INAScale::toFixed(std::span<const int32_t> raw, INAFixedScale scale, std::span<int32_t> out)
+{
+    size_t count=std::min(raw.size(),out.size());
+    size_t ixV=0;
+
+#if defined(INASCALE_NEON)
+    int32x2_t vMul=vdup_n_s32(scale.mul);
+    int64x2_t vShift=vdupq_n_s64(-int64_t(scale.shift));
+    for (; ixV+4<=count; ixV+=4) {
+        int32x4_t v=vld1q_s32(&raw[ixV]);
+        // 32x32 -> 64 bit products, rounding shift right, narrow back to 32 bit
+        int64x2_t lo=vrshlq_s64(vmull_s32(vget_low_s32(v),vMul),vShift);
+        int64x2_t hi=vrshlq_s64(vmull_s32(vget_high_s32(v),vMul),vShift);
+        vst1q_s32(&out[ixV],vcombine_s32(vmovn_s64(lo),vmovn_s64(hi)));
+    }
+#endif
+
+    toFixedScalar(raw.subspan(ixV,count-ixV),scale,out.subspan(ixV,count-ixV));
+}
+
+/**
+ * @brief Plain loop version of toFixed() (no FPU needed).
+ */
+void INAScale::toFixedScalar(std::span<const int32_t> raw, INAFixedScale scale, std::span<int32_t> out)
+{
+    size_t count=std::min(raw.size(),out.size());
+    int64_t round=scale.shift > 0 ? int64_t(1) << (scale.shift-1) : 0;
+    for (size_t ixV=0; ixV<count; ixV++) {
+        out[ixV]=static_cast<int32_t>((int64_t(raw[ixV])*scale.mul+round) >> scale.shift);
+    }
+}
@@ -0,0 +1,72 @@
+/*
+ * INAScale - batch conversion of INA226/INA228 raw samples
+ *
+ * Copyright (C) 2025 Fabio Durigon.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ */
+
+#ifndef INAScale_H
+#define INAScale_H
+
+#include <cstdint>
+#include <span>
+
+/**
+ * @brief Fixed point scale: value = (raw * mul) >> shift, rounded.
+ * Build it with INAScale::fixedScale().
+ */
+struct INAFixedScale {
+    int32_t mul;
+    uint8_t shift;
+};
+
+/**
+ * @brief Converts arrays of raw register values (int32) to engineering units.
+ *
+ * At high sample rates store raw integers (INA226::readRaw(), INA228::readAllRaw()) and scale them in bulk:
+ * - toFloat()  ->  float units (i.e. V, A), explicit SSE2/NEON kernels when available.
+ * - toFixed()  ->  integer units (i.e. uV, uA) with an integer multiply and shift, for targets without FPU
+ *                  (explicit NEON kernel, elsewhere a plain loop the compiler can vectorise).
+ * ...Scalar() versions are the plain loops, used for tail elements and as reference in benchmarks.
+ *
+ * @code
+ * int32_t raw[256];            // i.e. INA226 current register values
+ * float amps[256];
+ * INAScale::toFloat(raw, ina226.getCurrentLsb(), amps);
+ * int32_t microAmps[256];
+ * INAFixedScale scale=INAScale::fixedScale(ina226.getCurrentLsb(), 1e-6);
+ * INAScale::toFixed(raw, scale, microAmps);
+ * @endcode
+ */
+class INAScale {
+    public:
+        /**
+         * @brief Compute a fixed point scale with the best precision.
+         *
+         * @param lsb       ->  value of 1 LSB (i.e. 2.5e-6 V for INA226 shunt voltage).
+         * @param outUnit   ->  value of 1 output unit (i.e. 1e-6 for micro volts).
+         * @return scale for toFixed().
+         */
+        static constexpr INAFixedScale fixedScale(double lsb, double outUnit)
+        {
+            double factor=lsb/outUnit;
+            uint8_t shift=0;
+            // Largest shift keeping mul in 30 bits (raw * mul fits int64 for any int32 raw)
+            while (shift < 62 && factor * 2.0 < double(1 << 30)) {
+                factor*=2.0;
+                shift++;
+            }
+            return { static_cast<int32_t>(factor + 0.5), shift };
+        }
+
+        static void toFloat(std::span<const int32_t> raw, float lsb, std::span<float> out);
+        static void toFloatScalar(std::span<const int32_t> raw, float lsb, std::span<float> out);
+        static void toFixed(std::span<const int32_t> raw, INAFixedScale scale, std::span<int32_t> out);
+        static void toFixedScalar(std::span<const int32_t> raw, INAFixedScale scale, std::span<int32_t> out);
+};
+
+#endif
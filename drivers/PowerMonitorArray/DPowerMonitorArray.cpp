@@ -0,0 +1,431 @@
+/*
+ * DPowerMonitorArray - synchronized sampling of INA226/INA228 arrays
+ *
+ * Copyright (C) 2025 Fabio Durigon.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ */
+
+/*
+ * All devices work in triggered (single shot) mode, shunt + bus, 1 sample
+ * average. Each sample() cycle:
+ * 1 - writes the trigger configuration of all devices of a bus in a single
+ *     ioctl, buses one after the other: conversions start within a few
+ *     tens of microseconds on the same bus (one register write each).
+ * 2 - waits the longest conversion time.
+ * 3 - reads ready flag, VSHUNT, VBUS, CURRENT and POWER of all devices of a
+ *     bus in batch (neither device auto-increments the register pointer, so
+ *     it is one repeated start burst for each register); devices whose
+ *     ready flag is still clear are read again shortly after.
+ *
+ * Register values (big endian):
+ *           INA226 (16 bit)           INA228 (24 bit, 20 bit values in D23-D4)
+ * VSHUNT    0x01  2.5 uV              0x04  312.5 nV (ADCRANGE = 0)
+ * VBUS      0x02  1.25 mV             0x05  195.3125 uV
+ * CURRENT   0x04  current LSB         0x07  current LSB
+ * POWER     0x03  25 x current LSB    0x08  3.2 x current LSB
+ * Ready     0x06  MASK_ENABLE CVRF    0x0B  DIAG_ALRT CNVRF
+ * Trigger   0x00  CONFIG              0x01  ADC_CONFIG
+ */
+
+#include "DPowerMonitorArray.h"
+#include <INA226/INA226.h>
+#include <INA228/INA228.h>
+#include <INAAdcTuner/INAAdcTuner.h>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+#define INA_MANUFACTURER_TI         0x5449
+#define INA226_DIEID                0x2260
+#define INA228_DIEID                0x228       // DIEID D15-D4
+#define READY_RETRIES               3
+
+#define ERR_TOO_MANY_CHANNELS       "Too many channels"
+#define ERR_SHUNT_CAL_RANGE         "Shunt calibration out of range"
+#define ERR_NOT_BEGUN               "begin() not called after last addDevice()"
+#define ERR_NOT_READY               "Conversion not ready"
+
+DPowerMonitorArray::DPowerMonitorArray()
+{
+    maxConversionUs=0;
+    sequence=0;
+    begun=false;
+}
+
+DPowerMonitorArray::~DPowerMonitorArray()
+{
+
+}
+
+/**
+ * @brief Add a device to the array (call begin() after the last one).
+ * 
+ * @param busHandle     ->  bus of the device.
+ * @param devAddr       ->  device address.
+ * @param type          ->  DEVICE_INA226 or DEVICE_INA228.
+ * @param shuntOhm      ->  shunt resistor.
+ * @param maxCurrent    ->  max expected current, sets the current LSB.
+ * @return the channel index on success, otherwise -1 (you can retrieve the error by calling getLastError()).
+ */
+int DPowerMonitorArray::addDevice(DI2CBusHandle busHandle, uint8_t devAddr, DDeviceType type, float shuntOhm, float maxCurrent)
+{
+    if (channels.size() >= MAX_CHANNELS) {
+        lastErrorString=ERR_TOO_MANY_CHANNELS;
+        return -1;
+    }
+
+    DChannel channel={};
+    channel.info.busHandle=busHandle;
+    channel.info.devAddr=devAddr;
+    channel.info.type=type;
+    channel.info.shuntOhm=shuntOhm;
+
+    // Current LSB: max current at full scale of the (signed) CURRENT register
+    double cal;
+    if (type == DEVICE_INA226) {
+        channel.info.currentLsb=maxCurrent/double(1 << (INA226::Regs::CurrentValue::bits-1));
+        cal=INA226::CALIBRATION_SCALE/(channel.info.currentLsb*shuntOhm);
+    }
+    else {
+        channel.info.currentLsb=maxCurrent/double(1 << (INA228::Regs::CurrentValue::bits-1));
+        cal=INA228::SHUNT_CAL_SCALE*channel.info.currentLsb*shuntOhm;
+    }
+    if (cal < 1 || cal > 32767) {
+        lastErrorString=ERR_SHUNT_CAL_RANGE;
+        return -1;
+    }
+    channel.calibration=uint16_t(std::lround(cal));
+
+    getBusGroup(busHandle).channels.push_back(channels.size());
+    channels.push_back(channel);
+    begun=false;
+    return int(channels.size()-1);
+}
+
+/**
+ * @brief Probe an address range and add every INA226/INA228 found (same shunt for all).
+ * 
+ * @return number of devices added.
+ */
+int DPowerMonitorArray::discover(DI2CBusHandle busHandle, float shuntOhm, float maxCurrent, uint8_t firstAddr, uint8_t lastAddr)
+{
+    DI2CMaster& master=*getBusGroup(busHandle).master;
+    int found=0;
+
+    for (int addr=firstAddr; addr<=lastAddr; addr++) {
+        DI2CRegValue<INA226::Regs::ManufacturerID> manufacturer226;
+        DI2CRegValue<INA226::Regs::DieID> dieID;
+        DI2CRegValue<INA228::Regs::ManufacturerID> manufacturer228;
+        DI2CRegValue<INA228::Regs::DeviceID> deviceID;
+        if (INA226::RegMap::read(master, addr, manufacturer226) && manufacturer226.raw == INA_MANUFACTURER_TI &&
+            INA226::RegMap::read(master, addr, dieID) && dieID.raw == INA226_DIEID) {
+            found+=addDevice(busHandle, addr, DEVICE_INA226, shuntOhm, maxCurrent) >= 0;
+        }
+        else if (INA228::RegMap::read(master, addr, manufacturer228) && manufacturer228.raw == INA_MANUFACTURER_TI &&
+                 INA228::RegMap::read(master, addr, deviceID) && (deviceID.raw >> 4) == INA228_DIEID) {
+            found+=addDevice(busHandle, addr, DEVICE_INA228, shuntOhm, maxCurrent) >= 0;
+        }
+    }
+
+    return found;
+}
+
+/**
+ * @brief Reset and configure all devices in triggered mode.
+ * 
+ * @param conversionTimeUs  ->  shunt and bus conversion time: the nearest supported one is used, separately for
+ *                              each device type.
+ * @return true on success, otherwise false (you can retrieve the error by calling getLastError()).
+ */
+bool DPowerMonitorArray::begin(uint32_t conversionTimeUs)
+{
+    maxConversionUs=0;
+    for (auto& group : groups) {
+        group->triggerBatch.clear();
+        group->readBatch.clear();
+        for (size_t ixCh : group->channels) {
+            if (!configure(*group, channels[ixCh], conversionTimeUs)) {
+                return false;
+            }
+            maxConversionUs=std::max(maxConversionUs, channels[ixCh].info.conversionUs);
+        }
+        group->retryBatch.reserve(group->readBatch.size());
+    }
+
+    begun=true;
+    return true;
+}
+
+/**
+ * @brief Trigger and read all channels.
+ * 
+ * @param frame ->  readings of all channels (readings of failed channels have valid = false).
+ * @return true if all channels were read, otherwise false (you can retrieve the error by calling getLastError()).
+ */
+bool DPowerMonitorArray::sample(DFrame& frame)
+{
+    if (!begun) {
+        lastErrorString=ERR_NOT_BEGUN;
+        return false;
+    }
+
+    bool ret=true;
+    for (auto& channel : channels) {
+        channel.ready=false;
+    }
+
+    // Trigger conversions
+    uint64_t firstTriggerUs=0;
+    uint64_t lastTriggerUs=0;
+    for (auto& pGroup : groups) {
+        DBusGroup& group=*pGroup;
+        uint64_t startUs=nowUs();
+        group.ok=group.master->transferBatch(group.triggerBatch);
+        uint64_t endUs=nowUs();
+        if (!group.ok) {
+            lastErrorString=group.master->getLastError();
+            ret=false;
+            continue;
+        }
+        group.triggerUs=(startUs+endUs)/2;
+        if (firstTriggerUs == 0) {
+            firstTriggerUs=startUs;
+        }
+        lastTriggerUs=endUs;
+    }
+
+    // Wait conversions and read
+    std::this_thread::sleep_until(std::chrono::steady_clock::time_point(std::chrono::microseconds(firstTriggerUs+maxConversionUs)));
+    for (int ixTry=0; ixTry<=READY_RETRIES; ixTry++) {
+        bool allReady=true;
+        for (auto& pGroup : groups) {
+            DBusGroup& group=*pGroup;
+            if (group.ok && !readGroup(group, ixTry > 0)) {
+                lastErrorString=group.master->getLastError();
+                group.ok=false;
+                ret=false;
+            }
+            for (size_t ixCh : group.channels) {
+                allReady&=!group.ok || channels[ixCh].ready;
+            }
+        }
+        if (allReady) {
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(std::max<uint32_t>(maxConversionUs/8, 50)));
+    }
+
+    frame.sequence=sequence++;
+    frame.timestampUs=firstTriggerUs+maxConversionUs/2;
+    frame.skewUs=uint32_t(lastTriggerUs-firstTriggerUs);
+    frame.channelsCount=channels.size();
+    for (auto& group : groups) {
+        for (size_t ixCh : group->channels) {
+            DReading& reading=frame.readings[ixCh];
+            decode(channels[ixCh], reading);
+            reading.timestampUs=group->triggerUs+channels[ixCh].info.conversionUs/2;
+            if (!reading.valid && ret) {
+                lastErrorString=ERR_NOT_READY;
+                ret=false;
+            }
+        }
+    }
+
+    return ret;
+}
+
+size_t DPowerMonitorArray::channelsCount(void)
+{
+    return channels.size();
+}
+
+bool DPowerMonitorArray::getChannelInfo(size_t channel, DChannelInfo& info)
+{
+    if (channel >= channels.size()) {
+        return false;
+    }
+    info=channels[channel].info;
+    return true;
+}
+
+std::string DPowerMonitorArray::getLastError(void)
+{
+    return lastErrorString;
+}
+
+DPowerMonitorArray::DBusGroup& DPowerMonitorArray::getBusGroup(DI2CBusHandle busHandle)
+{
+    for (auto& group : groups) {
+        if (group->busHandle == busHandle) {
+            return *group;
+        }
+    }
+
+    auto group=std::make_unique<DBusGroup>();
+    group->busHandle=busHandle;
+    group->master=std::make_unique<DI2CMaster>(busHandle);
+    group->triggerUs=0;
+    group->ok=false;
+    groups.push_back(std::move(group));
+    return *groups.back();
+}
+
+/*
+ * Register write (address + value) packed in a transfer buffer.
+ */
+template<typename Reg>
+static void packWrite(uint8_t *buf, const DI2CRegValue<Reg>& value)
+{
+    buf[0]=Reg::address;
+    DI2CCodec::encode<typename Reg::RawType, Reg::endian, Reg::width>(value.raw, std::span<uint8_t, Reg::width>(&buf[1], Reg::width));
+}
+
+/*
+ * Raw value of a register received in a transfer buffer.
+ */
+template<typename Reg>
+static typename Reg::RawType unpack(const uint8_t *buf)
+{
+    return DI2CCodec::decode<typename Reg::RawType, Reg::endian, Reg::width>(std::span<const uint8_t, Reg::width>(buf, Reg::width));
+}
+
+/*
+ * Resets the device, writes calibration and prepares trigger and read
+ * transfers of the channel (channels vector must not change afterwards).
+ */
+bool DPowerMonitorArray::configure(DBusGroup& group, DChannel& channel, uint32_t conversionTimeUs)
+{
+    DI2CMaster& master=*group.master;
+    uint8_t addr=channel.info.devAddr;
+    bool is226=channel.info.type == DEVICE_INA226;
+    const uint16_t *convTimes=is226 ? INAAdcTuner::INA226_CONV_TIME_US : INAAdcTuner::INA228_CONV_TIME_US;
+    uint8_t ctCode=0;
+    for (uint8_t ixC=1; ixC<8; ixC++) {
+        if (std::abs(int64_t(convTimes[ixC])-conversionTimeUs) < std::abs(int64_t(convTimes[ctCode])-conversionTimeUs)) {
+            ctCode=ixC;
+        }
+    }
+    channel.info.conversionUs=uint32_t(convTimes[ctCode])*2;      // shunt + bus
+
+    // Trigger: shunt and bus single shot, 1 sample average (reserved bits as after reset)
+    bool ret;
+    uint16_t regLen;
+    if (is226) {
+        using Regs=INA226::Regs;
+        DI2CRegValue<Regs::Calibration> cal;
+        DI2CRegValue<Regs::Config> trigger;
+        cal.raw=channel.calibration;
+        ret=INA226::RegMap::write(master, addr, DI2CRegValue<Regs::Config>().set<Regs::Rst>(true));
+        ret=ret && INA226::RegMap::write(master, addr, cal);
+        ret=ret && INA226::RegMap::read(master, addr, trigger);
+        trigger.set<Regs::Mode>(INA226::MODE_TRIG_SHUNT_BUS).set<Regs::Avg>(INA226::AVG_1);
+        trigger.set<Regs::VshCt>(INA226::ConvTime(ctCode)).set<Regs::VbusCt>(INA226::ConvTime(ctCode));
+        packWrite(channel.triggerBuf, trigger);
+        channel.readyReg=Regs::MaskEnable::address;
+        channel.regs[0]=Regs::ShuntVoltage::address;
+        channel.regs[1]=Regs::BusVoltage::address;
+        channel.regs[2]=Regs::Current::address;
+        channel.regs[3]=Regs::Power::address;
+        regLen=Regs::ShuntVoltage::width;
+    }
+    else {
+        using Regs=INA228::Regs;
+        DI2CRegValue<Regs::ShuntCal> cal;
+        DI2CRegValue<Regs::AdcConfig> trigger;
+        cal.raw=channel.calibration;
+        ret=INA228::RegMap::write(master, addr, DI2CRegValue<Regs::Config>().set<Regs::Rst>(true));
+        ret=ret && INA228::RegMap::write(master, addr, cal);
+        trigger.set<Regs::Mode>(INA228::MODE_TRIG_SHUNT_BUS).set<Regs::Avg>(INA228::AVG_1);
+        trigger.set<Regs::Vshct>(INA228::ConvTime(ctCode)).set<Regs::Vbusct>(INA228::ConvTime(ctCode));
+        trigger.set<Regs::Vtct>(INA228::ConvTime(ctCode));
+        packWrite(channel.triggerBuf, trigger);
+        channel.readyReg=Regs::DiagAlrt::address;
+        channel.regs[0]=Regs::Vshunt::address;
+        channel.regs[1]=Regs::Vbus::address;
+        channel.regs[2]=Regs::Current::address;
+        channel.regs[3]=Regs::Power::address;
+        regLen=Regs::Vshunt::width;
+    }
+    if (!ret) {
+        lastErrorString=master.getLastError();
+        return false;
+    }
+
+    group.triggerBatch.push_back({addr, channel.triggerBuf, sizeof(channel.triggerBuf), nullptr, 0});
+    group.readBatch.push_back({addr, &channel.readyReg, 1, channel.rxBuf, 2});
+    for (size_t ixR=0; ixR<4; ixR++) {
+        group.readBatch.push_back({addr, &channel.regs[ixR], 1, &channel.rxBuf[2+ixR*regLen], regLen});
+    }
+    return true;
+}
+
+/*
+ * Reads ready flag and registers of all (or only not ready) channels of the
+ * group in batch.
+ */
+bool DPowerMonitorArray::readGroup(DBusGroup& group, bool onlyNotReady)
+{
+    const size_t xfersPerChannel=5;
+    bool ret;
+
+    if (!onlyNotReady) {
+        ret=group.master->transferBatch(group.readBatch);
+    }
+    else {
+        group.retryBatch.clear();
+        for (size_t ixC=0; ixC<group.channels.size(); ixC++) {
+            if (!channels[group.channels[ixC]].ready) {
+                auto first=group.readBatch.begin()+ixC*xfersPerChannel;
+                group.retryBatch.insert(group.retryBatch.end(), first, first+xfersPerChannel);
+            }
+        }
+        ret=group.master->transferBatch(group.retryBatch);
+    }
+    if (!ret) {
+        return false;
+    }
+
+    for (size_t ixCh : group.channels) {
+        DChannel& channel=channels[ixCh];
+        if (channel.info.type == DEVICE_INA226) {
+            channel.ready|=INA226::Regs::Cvrf::get(unpack<INA226::Regs::MaskEnable>(channel.rxBuf));
+        }
+        else {
+            channel.ready|=INA228::Regs::Cnvrf::get(unpack<INA228::Regs::DiagAlrt>(channel.rxBuf));
+        }
+    }
+    return true;
+}
+
+void DPowerMonitorArray::decode(DChannel& channel, DReading& reading)
+{
+    const uint8_t *buf=&channel.rxBuf[2];
+    float lsb=channel.info.currentLsb;
+
+    reading.valid=channel.ready;
+    if (channel.info.type == DEVICE_INA226) {
+        using Regs=INA226::Regs;
+        const size_t w=Regs::ShuntVoltage::width;
+        reading.shuntVoltage=Regs::ShuntValue::get(unpack<Regs::ShuntVoltage>(&buf[0])) * INA226::SHUNT_VOLTAGE_LSB * 1000;
+        reading.busVoltage=unpack<Regs::BusVoltage>(&buf[w]) * INA226::BUS_VOLTAGE_LSB;
+        reading.current=Regs::CurrentValue::get(unpack<Regs::Current>(&buf[2*w])) * lsb;
+        reading.power=unpack<Regs::Power>(&buf[3*w]) * INA226::POWER_LSB_FACTOR * lsb;
+    }
+    else {
+        using Regs=INA228::Regs;
+        const size_t w=Regs::Vshunt::width;
+        reading.shuntVoltage=Regs::VshuntValue::get(unpack<Regs::Vshunt>(&buf[0])) * INA228::SHUNT_VOLTAGE_LSB * 1000;
+        reading.busVoltage=Regs::VbusValue::get(unpack<Regs::Vbus>(&buf[w])) * INA228::BUS_VOLTAGE_LSB;
+        reading.current=Regs::CurrentValue::get(unpack<Regs::Current>(&buf[2*w])) * lsb;
+        reading.power=unpack<Regs::Power>(&buf[3*w]) * INA228::POWER_LSB_FACTOR * lsb;
+    }
+}
+
+uint64_t DPowerMonitorArray::nowUs(void)
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
@@ -0,0 +1,109 @@
+/*
+ * DPowerMonitorArray - synchronized sampling of INA226/INA228 arrays
+ *
+ * Copyright (C) 2025 Fabio Durigon.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ */
+
+#ifndef DPowerMonitorArray_H
+#define DPowerMonitorArray_H
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include <di2cmaster>
+
+class DPowerMonitorArray {
+    public:
+        static constexpr size_t MAX_CHANNELS = 16;
+
+        enum DDeviceType {
+            DEVICE_INA226,
+            DEVICE_INA228
+        };
+
+        //! Channel configuration.
+        struct DChannelInfo {
+            DI2CBusHandle busHandle;
+            uint8_t devAddr;
+            DDeviceType type;
+            float shuntOhm;
+            float currentLsb;       // A/bit
+            uint32_t conversionUs;  // shunt + bus conversion time (set by begin())
+        };
+
+        //! Measurement of one channel.
+        struct DReading {
+            float shuntVoltage;     // mV
+            float busVoltage;       // V
+            float current;          // A
+            float power;            // W
+            uint64_t timestampUs;   // steady clock, middle of the conversion
+            bool valid;             // false if the channel failed or was not ready
+        };
+
+        //! One sampling cycle of all channels.
+        struct DFrame {
+            uint64_t sequence;
+            uint64_t timestampUs;   // steady clock, middle of the conversions
+            uint32_t skewUs;        // time between first and last channel trigger
+            size_t channelsCount;
+            std::array<DReading, MAX_CHANNELS> readings;
+        };
+
+        DPowerMonitorArray();
+        ~DPowerMonitorArray();
+
+        int addDevice(DI2CBusHandle busHandle, uint8_t devAddr, DDeviceType type, float shuntOhm, float maxCurrent);
+        int discover(DI2CBusHandle busHandle, float shuntOhm, float maxCurrent, uint8_t firstAddr = 0x40, uint8_t lastAddr = 0x4F);
+        bool begin(uint32_t conversionTimeUs = 1100);
+        bool sample(DFrame& frame);
+
+        size_t channelsCount(void);
+        bool getChannelInfo(size_t channel, DChannelInfo& info);
+        std::string getLastError(void);
+
+    private:
+        struct DChannel {
+            DChannelInfo info;
+            uint16_t calibration;       // CALIBRATION/SHUNT_CAL register value
+            uint8_t triggerBuf[3];      // register + trigger value
+            uint8_t readyReg;           // MASK_ENABLE (INA226), DIAG_ALRT (INA228)
+            uint8_t regs[4];            // VSHUNT, VBUS, CURRENT, POWER
+            uint8_t rxBuf[2 + 4 * 3];   // ready flags + registers (24 bit max)
+            bool ready;
+        };
+
+        // Channels of a bus, triggered and read in batch
+        struct DBusGroup {
+            DI2CBusHandle busHandle;
+            std::unique_ptr<DI2CMaster> master;
+            std::vector<size_t> channels;
+            std::vector<DI2CTransfer> triggerBatch;
+            std::vector<DI2CTransfer> readBatch;
+            std::vector<DI2CTransfer> retryBatch;   // not ready channels (capacity of readBatch)
+            uint64_t triggerUs;
+            bool ok;                                // no bus error in this sample() cycle
+        };
+
+        DBusGroup& getBusGroup(DI2CBusHandle busHandle);
+        bool configure(DBusGroup& group, DChannel& channel, uint32_t conversionTimeUs);
+        bool readGroup(DBusGroup& group, bool onlyNotReady);
+        void decode(DChannel& channel, DReading& reading);
+        static uint64_t nowUs(void);
+
+        std::vector<DChannel> channels;
+        std::vector<std::unique_ptr<DBusGroup>> groups;
+        uint32_t maxConversionUs;
+        uint64_t sequence;
+        bool begun;
+        std::string lastErrorString;
+};
+
+#endif
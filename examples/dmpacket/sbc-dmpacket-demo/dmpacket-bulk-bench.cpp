@@ -0,0 +1,137 @@
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <span>
+#include <dmpacket>
+
+// A block of 16 bit ADC samples and of float readings, as in a telemetry burst
+#define SAMPLES 512
+#define ROUNDS 20000
+
+static uint16_t samples[SAMPLES];
+static float readings[SAMPLES];
+static uint16_t samplesOut[SAMPLES];
+static float readingsOut[SAMPLES];
+
+static void report(const char *name, size_t bytes, double seconds)
+{
+    printf("%-34s %8.1f MB/s  %6.2f ns/value\n", name, double(bytes) * ROUNDS / seconds / 1e6,
+           seconds * 1e9 / (double(ROUNDS) * SAMPLES));
+}
+
+template<typename F>
+static double measure(F f)
+{
+    auto t0=std::chrono::steady_clock::now();
+    for (int ixR=0; ixR<ROUNDS; ixR++) {
+        f(ixR);
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now()-t0).count();
+}
+
+int main()
+{
+    for (int ixS=0; ixS<SAMPLES; ixS++) {
+        samples[ixS]=(ixS * 40503u) & 0xFFF;
+        readings[ixS]=ixS * 0.25f - 3.0f;
+    }
+
+    // Correctness: bulk and per-element paths produce the same bytes and values
+    DMPacket a, b;
+    for (int ixS=0; ixS<SAMPLES; ixS++) {
+        a.pushWord(samples[ixS]);
+    }
+    for (int ixS=0; ixS<SAMPLES; ixS++) {
+        a.pushFloat(readings[ixS]);
+    }
+    b.pushWords(samples, SAMPLES);
+    b.pushFloats(std::span<const float>(readings));
+    bool ok=a.size() == b.size() && memcmp(a.rawBuffer(), b.rawBuffer(), a.size()) == 0;
+    ok=ok && b.readWordsInto(samplesOut, 0) == SAMPLES && memcmp(samples, samplesOut, sizeof(samples)) == 0;
+    ok=ok && b.readFloatsInto(readingsOut, SAMPLES * 2) == SAMPLES && memcmp(readings, readingsOut, sizeof(readings)) == 0;
+    ok=ok && b.readWords(0, SAMPLES) == std::vector<uint16_t>(samples, samples + SAMPLES);
+    DMPacketView view=b.view();
+    ok=ok && view.shiftWordsInto(samplesOut) == SAMPLES && view.shiftFloatsInto(readingsOut) == SAMPLES && view.remaining() == 0;
+    ok=ok && view.shiftWordsInto(samplesOut, 1) == 0 && view.overflow();
+    ok=ok && b.readWordsInto(samplesOut, b.size() - 3, 4) == 1;    // truncated to the end of the packet
+    printf("Bulk against per-element: %s\n", ok ? "OK" : "FAILED");
+
+    volatile uint32_t sink=0;
+    DMPacket packet;
+    packet.reserve(SAMPLES * 4);
+    report("DMPacket pushWord() loop", SAMPLES * 2, measure([&](int) {
+        packet.clear();
+        for (int ixS=0; ixS<SAMPLES; ixS++) {
+            packet.pushWord(samples[ixS]);
+        }
+        sink=sink+packet.size();
+    }));
+    report("DMPacket pushWords()", SAMPLES * 2, measure([&](int) {
+        packet.clear();
+        packet.pushWords(samples, SAMPLES);
+        sink=sink+packet.size();
+    }));
+    report("DMPacket readWord() loop", SAMPLES * 2, measure([&](int ixR) {
+        for (int ixS=0; ixS<SAMPLES; ixS++) {
+            samplesOut[ixS]=packet.readWord(ixS * 2);
+        }
+        sink=sink+samplesOut[ixR & (SAMPLES - 1)];
+    }));
+    report("DMPacket readWordsInto()", SAMPLES * 2, measure([&](int ixR) {
+        packet.readWordsInto(samplesOut, 0, SAMPLES);
+        sink=sink+samplesOut[ixR & (SAMPLES - 1)];
+    }));
+
+    packet.clear();
+    report("DMPacket pushFloat() loop", SAMPLES * 4, measure([&](int) {
+        packet.clear();
+        for (int ixS=0; ixS<SAMPLES; ixS++) {
+            packet.pushFloat(readings[ixS]);
+        }
+        sink=sink+packet.size();
+    }));
+    report("DMPacket pushFloats()", SAMPLES * 4, measure([&](int) {
+        packet.clear();
+        packet.pushFloats(readings, SAMPLES);
+        sink=sink+packet.size();
+    }));
+    report("DMPacket readFloat() loop", SAMPLES * 4, measure([&](int ixR) {
+        for (int ixS=0; ixS<SAMPLES; ixS++) {
+            readingsOut[ixS]=packet.readFloat(ixS * 4);
+        }
+        sink=sink+readingsOut[ixR & (SAMPLES - 1)];
+    }));
+    report("DMPacket readFloatsInto()", SAMPLES * 4, measure([&](int ixR) {
+        packet.readFloatsInto(readingsOut, 0, SAMPLES);
+        sink=sink+readingsOut[ixR & (SAMPLES - 1)];
+    }));
+
+    static uint8_t tx[SAMPLES * 2];
+    DMPacketWriter writer(tx);
+    report("DMPacketWriter pushWord() loop", SAMPLES * 2, measure([&](int ixR) {
+        writer.clear();
+        for (int ixS=0; ixS<SAMPLES; ixS++) {
+            writer.pushWord(samples[ixS]);
+        }
+        sink=sink+tx[ixR & (SAMPLES - 1)];
+    }));
+    report("DMPacketWriter pushWords()", SAMPLES * 2, measure([&](int ixR) {
+        writer.clear();
+        writer.pushWords(samples, SAMPLES);
+        sink=sink+tx[ixR & (SAMPLES - 1)];
+    }));
+    report("DMPacketView shiftWord() loop", SAMPLES * 2, measure([&](int ixR) {
+        DMPacketView v(tx, sizeof(tx));
+        for (int ixS=0; ixS<SAMPLES; ixS++) {
+            samplesOut[ixS]=v.shiftWord();
+        }
+        sink=sink+samplesOut[ixR & (SAMPLES - 1)];
+    }));
+    report("DMPacketView shiftWordsInto()", SAMPLES * 2, measure([&](int ixR) {
+        DMPacketView v(tx, sizeof(tx));
+        v.shiftWordsInto(samplesOut, SAMPLES);
+        sink=sink+samplesOut[ixR & (SAMPLES - 1)];
+    }));
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,137 @@
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <dmpacket>
+
+#define VALUES 512
+#define ROUNDS 20000
+
+struct Reading {
+    uint16_t id;
+    int32_t raw;
+    float value;
+};
+
+typedef DMPacketSchema<Reading,
+    DMPACKET_FIELD(Reading, id),
+    DMPACKET_FIELD(Reading, raw),
+    DMPACKET_FIELD(Reading, value)> ReadingSchema;
+
+static const char* orderName(DMPacketByteOrder order)
+{
+    return order == DMPACKET_LITTLE_ENDIAN ? "little endian" : "big endian";
+}
+
+// Wire bytes of each byte order: big endian must be the historical DMPacket format
+static bool checkWire(void)
+{
+    const uint8_t be[]={0x12, 0x34, 0xDE, 0xAD, 0xBE, 0xEF, 0x3F, 0x80, 0x00, 0x00};
+    const uint8_t le[]={0x34, 0x12, 0xEF, 0xBE, 0xAD, 0xDE, 0x00, 0x00, 0x80, 0x3F};
+    bool ok=true;
+    for (int ixO=0; ixO<2; ixO++) {
+        DMPacketByteOrder order=ixO ? DMPACKET_LITTLE_ENDIAN : DMPACKET_BIG_ENDIAN;
+        const uint8_t *expected=ixO ? le : be;
+        DMPacket packet(order);
+        packet.pushWord(0x1234);
+        packet.pushDWord(0xDEADBEEF);
+        packet.pushFloat(1.0f);
+        uint8_t tx[16];
+        DMPacketWriter writer(tx, order);
+        writer.pushWord(0x1234);
+        writer.pushDWord(0xDEADBEEF);
+        writer.pushFloat(1.0f);
+        uint16_t words[]={0x1234};
+        uint32_t dwords[]={0xDEADBEEF};
+        float floats[]={1.0f};
+        DMPacket bulk(order);
+        bulk.pushWords(words, 1);
+        bulk.pushDWords(dwords, 1);
+        bulk.pushFloats(floats, 1);
+        ok=ok && packet.size() == 10 && memcmp(packet.rawBuffer(), expected, 10) == 0;
+        ok=ok && writer.size() == 10 && memcmp(tx, expected, 10) == 0;
+        ok=ok && bulk.size() == 10 && memcmp(bulk.rawBuffer(), expected, 10) == 0;
+
+        DMPacketView view(expected, 10, order);
+        uint32_t dw=0;
+        ok=ok && view.shiftWord() == 0x1234 && view.shiftDWord() == 0xDEADBEEF && view.shiftFloat() == 1.0f;
+        ok=ok && packet.readWord(0) == 0x1234 && packet.readDWord(2) == 0xDEADBEEF && packet.readFloat(6) == 1.0f;
+        ok=ok && bulk.readDWordsInto(&dw, 2, 1) == 1 && dw == 0xDEADBEEF;
+
+        Reading r={0x1234, -2, 1.0f}, back;
+        DMPacket schemaPacket(order);
+        ReadingSchema::pack(schemaPacket, r);
+        DMPacketView schemaView=schemaPacket.view();
+        ok=ok && ReadingSchema::unpack(schemaView, back) && back.id == r.id && back.raw == r.raw && back.value == r.value;
+        ok=ok && schemaPacket.readWord(0) == 0x1234;
+    }
+    return ok;
+}
+
+template<typename F>
+static double measure(F f)
+{
+    auto t0=std::chrono::steady_clock::now();
+    for (int ixR=0; ixR<ROUNDS; ixR++) {
+        f(ixR);
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now()-t0).count();
+}
+
+static void report(const char *name, DMPacketByteOrder order, double seconds)
+{
+    printf("%-30s %-14s %6.2f ns/value\n", name, orderName(order), seconds * 1e9 / (double(ROUNDS) * VALUES));
+}
+
+int main()
+{
+    printf("Wire format of both byte orders: %s\n", checkWire() ? "OK" : "FAILED");
+
+    static uint32_t values[VALUES];
+    static uint32_t out[VALUES];
+    static uint8_t buff[VALUES * 4];
+    for (int ixV=0; ixV<VALUES; ixV++) {
+        values[ixV]=ixV * 2654435761u;
+    }
+    volatile uint32_t sink=0;
+
+    for (int ixO=0; ixO<2; ixO++) {
+        DMPacketByteOrder order=ixO ? DMPACKET_LITTLE_ENDIAN : DMPACKET_BIG_ENDIAN;
+        DMPacket packet(order);
+        packet.reserve(sizeof(buff));
+        report("DMPacket pushDWord() loop", order, measure([&](int) {
+            packet.clear();
+            for (int ixV=0; ixV<VALUES; ixV++) {
+                packet.pushDWord(values[ixV]);
+            }
+            sink=sink+packet.size();
+        }));
+        report("DMPacket readDWord() loop", order, measure([&](int ixR) {
+            for (int ixV=0; ixV<VALUES; ixV++) {
+                out[ixV]=packet.readDWord(ixV * 4);
+            }
+            sink=sink+out[ixR & (VALUES - 1)];
+        }));
+        DMPacketWriter writer(buff, order);
+        report("DMPacketWriter pushDWord() loop", order, measure([&](int ixR) {
+            writer.clear();
+            for (int ixV=0; ixV<VALUES; ixV++) {
+                writer.pushDWord(values[ixV]);
+            }
+            sink=sink+buff[ixR & (VALUES - 1)];
+        }));
+        report("DMPacketView shiftDWord() loop", order, measure([&](int ixR) {
+            DMPacketView view(buff, sizeof(buff), order);
+            for (int ixV=0; ixV<VALUES; ixV++) {
+                out[ixV]=view.shiftDWord();
+            }
+            sink=sink+out[ixR & (VALUES - 1)];
+        }));
+        report("DMPacketView shiftDWordsInto()", order, measure([&](int ixR) {
+            DMPacketView view(buff, sizeof(buff), order);
+            view.shiftDWordsInto(out, VALUES);
+            sink=sink+out[ixR & (VALUES - 1)];
+        }));
+    }
+
+    return 0;
+}
@@ -0,0 +1,176 @@
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+#include <dmpacket>
+
+#define PAYLOAD_MAX 1024
+#define FRAMES 20000
+
+// Bitwise references of the table driven CRCs
+static uint16_t crc16Ref(const uint8_t *buff, size_t size)
+{
+    uint16_t crc=0xFFFF;
+    for (size_t ixB=0; ixB<size; ixB++) {
+        crc^=(uint16_t) (buff[ixB] << 8);
+        for (int ixBit=0; ixBit<8; ixBit++) {
+            crc=(crc & 0x8000) ? (uint16_t) ((crc << 1) ^ 0x1021) : (uint16_t) (crc << 1);
+        }
+    }
+    return crc;
+}
+
+static uint32_t crc32Ref(const uint8_t *buff, size_t size)
+{
+    uint32_t crc=0xFFFFFFFF;
+    for (size_t ixB=0; ixB<size; ixB++) {
+        crc^=buff[ixB];
+        for (int ixBit=0; ixBit<8; ixBit++) {
+            crc=(crc & 1) ? (crc >> 1) ^ 0xEDB88320 : crc >> 1;
+        }
+    }
+    return ~crc;
+}
+
+static bool checkCRC(std::mt19937& rng)
+{
+    const uint8_t check[]="123456789";
+    bool ok=DMPacketCRC::crc16(check, 9) == 0x29B1 && DMPacketCRC::crc32(check, 9) == 0xCBF43926;
+    uint8_t buff[300];
+    for (size_t size=0; size<sizeof(buff) && ok; size++) {
+        for (size_t ixB=0; ixB<size; ixB++) {
+            buff[ixB]=rng();
+        }
+        // Whole buffer and in two parts
+        size_t half=size / 3;
+        ok=DMPacketCRC::crc16(buff, size) == crc16Ref(buff, size) &&
+           DMPacketCRC::crc32(buff, size) == crc32Ref(buff, size) &&
+           DMPacketCRC::crc16(buff + half, size - half, DMPacketCRC::crc16(buff, half)) == crc16Ref(buff, size) &&
+           DMPacketCRC::crc32(buff + half, size - half, DMPacketCRC::crc32(buff, half)) == crc32Ref(buff, size);
+    }
+    return ok;
+}
+
+// Random payloads (sparse zeros, runs of 254+ non zero bytes and all zeros too), encoded back to back, noise between
+// some frames, received in random chunks: every clean frame must come out, every damaged one must be rejected
+static bool checkStream(std::mt19937& rng, DMPacketFrame::CRCType crc)
+{
+    std::vector<std::vector<uint8_t>> sent;
+    std::vector<uint8_t> stream;
+    std::vector<bool> damaged;
+    uint8_t frame[DMPacketFrame::maxFrameSize(PAYLOAD_MAX, DMPacketFrame::CRC_32)];
+    for (int ixF=0; ixF<2000; ixF++) {
+        std::vector<uint8_t> payload(rng() % (PAYLOAD_MAX + 1));
+        int kind=rng() % 4;
+        for (auto& b : payload) {
+            b=kind == 0 ? 0 : kind == 1 ? (rng() % 255) + 1 : rng();
+        }
+        size_t frameSize=DMPacketFrame::encode(payload.data(), payload.size(), frame, sizeof(frame), crc);
+        if (frameSize == 0 || memchr(frame, 0, frameSize - 1) != nullptr || frame[frameSize - 1] != 0) {
+            printf("Bad encoding of frame %d\n", ixF);
+            return false;
+        }
+        bool noise=(rng() % 10) == 0;
+        if (noise) {
+            // Flip a byte inside the frame
+            frame[rng() % (frameSize - 1)]^=(rng() % 255) + 1;
+        }
+        stream.insert(stream.end(), frame, frame + frameSize);
+        sent.push_back(payload);
+        damaged.push_back(noise);
+    }
+
+    static uint8_t rxFrame[PAYLOAD_MAX + 4];
+    DMPacketFrameDecoder decoder(rxFrame, sizeof(rxFrame), crc);
+    size_t next=0;
+    size_t offset=0;
+    while (offset < stream.size()) {
+        size_t chunkSize=std::min<size_t>(rng() % 300 + 1, stream.size() - offset);
+        const uint8_t *chunk=stream.data() + offset;
+        offset+=chunkSize;
+        while (decoder.decode(chunk, chunkSize)) {
+            // Skip the damaged frames (a flipped byte can also split a frame in two)
+            while (next < sent.size() && damaged[next]) {
+                next++;
+            }
+            DMPacketView view=decoder.frame();
+            if (next == sent.size() || view.size() != sent[next].size() || memcmp(view.data(), sent[next].data(), view.size()) != 0) {
+                printf("Wrong frame %zu\n", next);
+                return false;
+            }
+            next++;
+        }
+    }
+    size_t clean=0;
+    for (bool d : damaged) {
+        clean+=!d;
+    }
+    printf("  %s: %u good frames (%zu sent clean), %u CRC errors, %u framing errors, %u overflows\n",
+           crc == DMPacketFrame::CRC_16 ? "CRC-16" : crc == DMPacketFrame::CRC_32 ? "CRC-32" : "no CRC",
+           decoder.getFramesCount(), clean, decoder.getCRCErrorsCount(), decoder.getFramingErrorsCount(), decoder.getOverflowsCount());
+    return crc == DMPacketFrame::CRC_NONE || decoder.getFramesCount() == clean;
+}
+
+int main()
+{
+    using namespace std::chrono;
+    std::mt19937 rng(42);
+
+    printf("CRC against bitwise reference: %s\n", checkCRC(rng) ? "OK" : "FAILED");
+    bool ok=checkStream(rng, DMPacketFrame::CRC_16) && checkStream(rng, DMPacketFrame::CRC_32);
+    printf("Noisy stream in random chunks: %s\n", ok ? "OK" : "FAILED");
+
+    // Throughput over 256 bytes telemetry-like payloads
+    static uint8_t payload[256];
+    for (size_t ixB=0; ixB<sizeof(payload); ixB++) {
+        payload[ixB]=(rng() % 8) == 0 ? 0 : rng();
+    }
+    static uint8_t data[1 << 20];
+    for (size_t ixB=0; ixB<sizeof(data); ixB++) {
+        data[ixB]=rng();
+    }
+    volatile uint32_t sink=0;
+
+    auto t0=steady_clock::now();
+    for (int ixR=0; ixR<100; ixR++) {
+        sink=sink+DMPacketCRC::crc16(data, sizeof(data));
+    }
+    double s=duration<double>(steady_clock::now()-t0).count();
+    printf("CRC-16                       %7.1f MB/s\n", 100.0 * sizeof(data) / s / 1e6);
+    t0=steady_clock::now();
+    for (int ixR=0; ixR<100; ixR++) {
+        sink=sink+DMPacketCRC::crc32(data, sizeof(data));
+    }
+    s=duration<double>(steady_clock::now()-t0).count();
+    printf("CRC-32                       %7.1f MB/s\n", 100.0 * sizeof(data) / s / 1e6);
+
+    DMPacketFrame::CRCType crcs[]={DMPacketFrame::CRC_16, DMPacketFrame::CRC_32};
+    for (auto crc : crcs) {
+        static uint8_t stream[FRAMES * DMPacketFrame::maxFrameSize(sizeof(payload), DMPacketFrame::CRC_32)];
+        size_t streamSize=0;
+        t0=steady_clock::now();
+        for (int ixF=0; ixF<FRAMES; ixF++) {
+            streamSize+=DMPacketFrame::encode(payload, sizeof(payload), stream + streamSize, sizeof(stream) - streamSize, crc);
+        }
+        s=duration<double>(steady_clock::now()-t0).count();
+        printf("Encode 256 B frames (%s)   %7.1f MB/s\n", crc == DMPacketFrame::CRC_16 ? "CRC-16" : "CRC-32",
+               double(FRAMES) * sizeof(payload) / s / 1e6);
+
+        static uint8_t rxFrame[sizeof(payload) + 4];
+        DMPacketFrameDecoder decoder(rxFrame, sizeof(rxFrame), crc);
+        t0=steady_clock::now();
+        for (size_t offset=0; offset<streamSize; offset+=64) {
+            const uint8_t *chunk=stream + offset;
+            size_t chunkSize=std::min<size_t>(64, streamSize - offset);
+            while (decoder.decode(chunk, chunkSize)) {
+                sink=sink+decoder.frame().size();
+            }
+        }
+        s=duration<double>(steady_clock::now()-t0).count();
+        printf("Decode 256 B frames (%s)   %7.1f MB/s  (%u frames)\n", crc == DMPacketFrame::CRC_16 ? "CRC-16" : "CRC-32",
+               double(FRAMES) * sizeof(payload) / s / 1e6, decoder.getFramesCount());
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,78 @@
+#include <chrono>
+#include <cstdio>
+#include <dmpacket>
+
+// Mixed fields record: 1 + 2 + 4 + 4 + 1 + 4 = 16 bytes
+#define RECORD_SIZE 16
+#define PACKET_SIZE (64 * 1024)
+#define RECORDS (PACKET_SIZE / RECORD_SIZE)
+#define ROUNDS 200
+
+static void pushRecords(DMPacket& packet, size_t& reallocs)
+{
+    size_t capacity=packet.capacity();
+    for (uint32_t ixR=0; ixR<RECORDS; ixR++) {
+        packet.pushByte(ixR & 0xFF);
+        packet.pushWord(ixR & 0xFFFF);
+        packet.pushDWord(ixR * 2654435761u);
+        packet.pushFloat(ixR * 0.5f);
+        packet.pushBool(ixR & 1);
+        packet.pushString("abcd");
+        if (packet.capacity() != capacity) {
+            capacity=packet.capacity();
+            reallocs++;
+        }
+    }
+}
+
+static bool checkRecords(DMPacket& packet)
+{
+    if (packet.size() != PACKET_SIZE) {
+        printf("Wrong size %zu\n", packet.size());
+        return false;
+    }
+    for (uint32_t ixR=0; ixR<RECORDS; ixR++) {
+        uint8_t b=packet.shiftByte();
+        uint16_t w=packet.shiftWord();
+        uint32_t dw=packet.shiftDWord();
+        float f=packet.readFloat(ixR * RECORD_SIZE + 7);
+        packet.shiftDWord();
+        bool bo=packet.shiftBool();
+        std::string s=packet.shiftString(4);
+        if (b != (ixR & 0xFF) || w != (ixR & 0xFFFF) || dw != ixR * 2654435761u || f != ixR * 0.5f || bo != bool(ixR & 1) || s != "abcd") {
+            printf("Mismatch at record %u (offset %u)\n", ixR, ixR * RECORD_SIZE);
+            return false;
+        }
+    }
+    return true;
+}
+
+int main()
+{
+    using namespace std::chrono;
+
+    // Correctness: every field must round trip, also past 255 and 65535 bytes
+    DMPacket packet;
+    size_t reallocs=0;
+    pushRecords(packet, reallocs);
+    printf("64 KB packet of %u records: %s, %zu reallocations while growing\n", RECORDS,
+           checkRecords(packet) ? "OK" : "FAILED", reallocs);
+
+    // Throughput: new packet each round (geometric growth) against reserve()
+    for (int reserve=0; reserve<2; reserve++) {
+        reallocs=0;
+        auto start=steady_clock::now();
+        for (int ixR=0; ixR<ROUNDS; ixR++) {
+            DMPacket p;
+            if (reserve) {
+                p.reserve(PACKET_SIZE);
+            }
+            pushRecords(p, reallocs);
+        }
+        double s=duration<double>(steady_clock::now() - start).count();
+        printf("%-10s %7.1f MB/s  %6.1f ns/field  %5.1f reallocations/packet\n", reserve ? "reserve()" : "growing",
+               ROUNDS * double(PACKET_SIZE) / s / 1e6, s * 1e9 / (ROUNDS * RECORDS * 6.0), double(reallocs) / ROUNDS);
+    }
+
+    return 0;
+}
@@ -0,0 +1,164 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <thread>
+#include <dmpacket>
+
+// Count every heap allocation of the process
+static std::atomic<size_t> allocations{0};
+
+void* operator new(size_t size)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    void *p=malloc(size ? size : 1);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void *p) noexcept
+{
+    free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+    free(p);
+}
+
+#define MESSAGES 100000
+#define WARMUP 1000
+
+// A typical telemetry message: command, sequence, 8 floats
+template<typename P>
+static void build(P& packet, uint32_t seq)
+{
+    packet.pushByte(0x42);
+    packet.pushDWord(seq);
+    for (int ixF=0; ixF<8; ixF++) {
+        packet.pushFloat(seq * 0.1f + ixF);
+    }
+}
+
+// Single producer / single consumer queue of move-only packets (fixed size, no heap)
+template<size_t N>
+class PacketQueue {
+    public:
+        bool push(DMPooledPacket& packet) {
+            size_t h=head.load(std::memory_order_relaxed);
+            if (h - tail.load(std::memory_order_acquire) == N) {
+                return false;
+            }
+            items[h % N]=static_cast<DMPooledPacket&&>(packet);
+            head.store(h+1, std::memory_order_release);
+            return true;
+        }
+        bool pop(DMPooledPacket& packet) {
+            size_t t=tail.load(std::memory_order_relaxed);
+            if (t == head.load(std::memory_order_acquire)) {
+                return false;
+            }
+            packet=static_cast<DMPooledPacket&&>(items[t % N]);
+            tail.store(t+1, std::memory_order_release);
+            return true;
+        }
+    private:
+        DMPooledPacket items[N];
+        std::atomic<size_t> head{0};
+        std::atomic<size_t> tail{0};
+};
+
+static void report(const char *name, size_t allocs, double seconds)
+{
+    printf("%-28s %8.3f allocations/message  %6.0f ns/message\n", name, double(allocs) / MESSAGES, seconds * 1e9 / MESSAGES);
+}
+
+int main()
+{
+    using namespace std::chrono;
+    static DMPacketPool<64, 32> pool;
+    volatile uint32_t sink=0;
+
+    // New DMPacket for each message
+    {
+        size_t start=allocations;
+        auto t0=steady_clock::now();
+        for (uint32_t ixM=0; ixM<MESSAGES; ixM++) {
+            DMPacket packet;
+            build(packet, ixM);
+            sink=sink+packet.size();
+        }
+        report("new DMPacket", allocations-start, duration<double>(steady_clock::now()-t0).count());
+    }
+
+    // Reused DMPacket (clear() keeps capacity)
+    {
+        DMPacket packet;
+        for (uint32_t ixM=0; ixM<WARMUP; ixM++) {
+            packet.clear();
+            build(packet, ixM);
+        }
+        size_t start=allocations;
+        auto t0=steady_clock::now();
+        for (uint32_t ixM=0; ixM<MESSAGES; ixM++) {
+            packet.clear();
+            build(packet, ixM);
+            sink=sink+packet.size();
+        }
+        report("reused DMPacket", allocations-start, duration<double>(steady_clock::now()-t0).count());
+    }
+
+    // Pooled packets, one thread
+    {
+        size_t start=allocations;
+        auto t0=steady_clock::now();
+        for (uint32_t ixM=0; ixM<MESSAGES; ixM++) {
+            DMPooledPacket packet=pool.acquire();
+            build(packet.packet(), ixM);
+            sink=sink+packet.size();
+        }
+        report("DMPacketPool", allocations-start, duration<double>(steady_clock::now()-t0).count());
+    }
+
+    // Pooled packets, producer thread fills, consumer thread checks and drops
+    {
+        static PacketQueue<16> queue;
+        std::atomic<uint32_t> errors{0};
+        std::thread consumer;
+        size_t start=allocations;
+        auto t0=steady_clock::now();
+        consumer=std::thread([&]() {
+            DMPooledPacket packet;
+            for (uint32_t ixM=0; ixM<MESSAGES; ixM++) {
+                while (!queue.pop(packet)) {
+                    std::this_thread::yield();
+                }
+                DMPacketView view=packet.view();
+                if (view.shiftByte() != 0x42 || view.shiftDWord() != ixM) {
+                    errors++;
+                }
+                packet.release();
+            }
+        });
+        for (uint32_t ixM=0; ixM<MESSAGES; ixM++) {
+            DMPooledPacket packet;
+            while (!(packet=pool.acquire())) {
+                std::this_thread::yield();
+            }
+            build(packet.packet(), ixM);
+            while (!queue.push(packet)) {
+                std::this_thread::yield();
+            }
+        }
+        consumer.join();
+        double seconds=duration<double>(steady_clock::now()-t0).count();
+        // std::thread start is the only allocation
+        report("DMPacketPool 2 threads", allocations-start, seconds);
+        printf("%u errors, %zu of %zu slabs free\n", errors.load(), pool.getFreeCount(), pool.getSlabsCount());
+    }
+
+    return 0;
+}
@@ -0,0 +1,183 @@
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <dmpacket>
+
+// A slave with 32 commands (0x10-0x2F): each one reads a word, updates its register and replies with it.
+// The same handlers are dispatched by an if/else chain (the usual application code), a switch and DMPacketRouter.
+#define COMMANDS 32
+#define FIRST_COMMAND 0x10
+#define REQUESTS 65536
+
+#define FOR_COMMANDS(X) \
+    X(0x10) X(0x11) X(0x12) X(0x13) X(0x14) X(0x15) X(0x16) X(0x17) X(0x18) X(0x19) X(0x1A) X(0x1B) X(0x1C) X(0x1D) X(0x1E) X(0x1F) \
+    X(0x20) X(0x21) X(0x22) X(0x23) X(0x24) X(0x25) X(0x26) X(0x27) X(0x28) X(0x29) X(0x2A) X(0x2B) X(0x2C) X(0x2D) X(0x2E) X(0x2F)
+
+struct Registers {
+    uint32_t values[COMMANDS];
+};
+
+template<uint8_t Command>
+static bool handle(DMPacketView& request, DMPacketWriter& reply, void *context)
+{
+    Registers *regs=(Registers *) context;
+    uint32_t& reg=regs->values[Command - FIRST_COMMAND];
+    reg=reg * 31 + request.shiftWord() * (Command + 1u);
+    reply.pushByte(Command);
+    reply.pushDWord(reg);
+    return true;
+}
+
+static DMPacketDispatch dispatchChain(DMPacketView request, DMPacketWriter& reply, Registers *regs)
+{
+    reply.clear();
+    uint8_t command=request.shiftByte();
+    bool ok;
+#define IF_ELSE(C) if (command == C) { ok=handle<C>(request, reply, regs); } else
+    FOR_COMMANDS(IF_ELSE)
+#undef IF_ELSE
+    {
+        return DMPACKET_DISPATCH_UNKNOWN;
+    }
+    return ok && !request.overflow() ? DMPACKET_DISPATCH_OK : DMPACKET_DISPATCH_MALFORMED;
+}
+
+static DMPacketDispatch dispatchSwitch(DMPacketView request, DMPacketWriter& reply, Registers *regs)
+{
+    reply.clear();
+    bool ok;
+    switch (request.shiftByte()) {
+#define CASE(C) case C: ok=handle<C>(request, reply, regs); break;
+        FOR_COMMANDS(CASE)
+#undef CASE
+        default:
+            return DMPACKET_DISPATCH_UNKNOWN;
+    }
+    return ok && !request.overflow() ? DMPACKET_DISPATCH_OK : DMPACKET_DISPATCH_MALFORMED;
+}
+
+// Typed request/reply
+struct AddRequest {
+    int32_t a;
+    int32_t b;
+};
+struct AddReply {
+    int32_t sum;
+};
+typedef DMPacketSchema<AddRequest, DMPACKET_FIELD(AddRequest, a), DMPACKET_FIELD(AddRequest, b)> AddRequestSchema;
+typedef DMPacketSchema<AddReply, DMPACKET_FIELD(AddReply, sum)> AddReplySchema;
+
+static bool onAdd(const AddRequest& request, AddReply& reply, void *)
+{
+    reply.sum=request.a + request.b;
+    return true;
+}
+
+static bool onEcho(const AddRequest& request, DMPacketWriter& reply, void *)
+{
+    reply.pushInt32(request.b);
+    reply.pushInt32(request.a);
+    return true;
+}
+
+static bool onUnknown(DMPacketView& request, DMPacketWriter& reply, void *)
+{
+    reply.pushByte(0xEE);
+    reply.pushByte(request.readByte(request.getShiftIndex() - 1));
+    return true;
+}
+
+static bool checkRouter(void)
+{
+    bool ok=true;
+    uint8_t replyBuff[16];
+    DMPacketWriter reply(replyBuff);
+    DMPacketRouter<> router;
+    router.onRequest<AddRequestSchema, AddReplySchema, onAdd>(0x80);
+    router.onMessage<AddRequestSchema, onEcho>(0x81);
+
+    // Typed request and reply
+    const uint8_t add[]={0x80, 0, 0, 0, 40, 0xFF, 0xFF, 0xFF, 0xFE};
+    ok=ok && router.dispatch(add, sizeof(add), reply) == DMPACKET_DISPATCH_OK && reply.size() == 4 && reply.view().readInt32(0) == 38;
+    const uint8_t echo[]={0x81, 0, 0, 0, 1, 0, 0, 0, 2};
+    ok=ok && router.dispatch(echo, sizeof(echo), reply) == DMPACKET_DISPATCH_OK && reply.view().readInt32(0) == 2 && reply.view().readInt32(4) == 1;
+    // Short payload, unknown command, empty request
+    ok=ok && router.dispatch(add, 5, reply) == DMPACKET_DISPATCH_MALFORMED;
+    const uint8_t unknown[]={0x42, 1, 2};
+    ok=ok && router.dispatch(unknown, sizeof(unknown), reply) == DMPACKET_DISPATCH_UNKNOWN;
+    ok=ok && router.dispatch(unknown, 0, reply) == DMPACKET_DISPATCH_UNKNOWN;
+    router.onUnknown(onUnknown);
+    ok=ok && router.dispatch(unknown, sizeof(unknown), reply) == DMPACKET_DISPATCH_OK && reply.size() == 2 && replyBuff[1] == 0x42;
+    // Reply larger than the buffer
+    DMPacketWriter small(replyBuff, 3);
+    ok=ok && router.dispatch(add, sizeof(add), small) == DMPACKET_DISPATCH_REPLY_OVERFLOW;
+    // Little endian, command after a 2 bytes header (address, sequence), small table
+    DMPacketRouter<0x90> headed(2);
+    headed.onRequest<AddRequestSchema, AddReplySchema, onAdd>(0x80);
+    const uint8_t addLE[]={0x05, 0x07, 0x80, 40, 0, 0, 0, 0xFE, 0xFF, 0xFF, 0xFF};
+    DMPacketWriter replyLE(replyBuff, DMPACKET_LITTLE_ENDIAN);
+    ok=ok && headed.dispatch(addLE, sizeof(addLE), replyLE) == DMPACKET_DISPATCH_OK && replyBuff[0] == 38 && replyBuff[3] == 0;
+    ok=ok && headed.dispatch(addLE, 2, replyLE) == DMPACKET_DISPATCH_UNKNOWN && headed.handler(0xA0) == nullptr;
+    return ok;
+}
+
+int main()
+{
+    using namespace std::chrono;
+    printf("Router: %s\n", checkRouter() ? "OK" : "FAILED");
+
+    static DMPacketRouter<> router;
+#define ON(C) router.on(C, handle<C>);
+    FOR_COMMANDS(ON)
+#undef ON
+
+    // Requests of random commands (3 bytes: command, word)
+    std::mt19937 rng(3);
+    static uint8_t requests[REQUESTS][3];
+    for (auto& r : requests) {
+        r[0]=FIRST_COMMAND + rng() % COMMANDS;
+        r[1]=(uint8_t) rng();
+        r[2]=(uint8_t) rng();
+    }
+
+    static uint8_t replyBuff[16];
+    DMPacketWriter reply(replyBuff);
+    Registers regs[3]={};
+    uint32_t checksum[3]={0, 0, 0};
+    double seconds[3];
+    const int rounds=20;
+    for (int ixM=0; ixM<3; ixM++) {
+        auto t0=steady_clock::now();
+        for (int ixR=0; ixR<rounds; ixR++) {
+            for (auto& r : requests) {
+                DMPacketView request(r, sizeof(r));
+                DMPacketDispatch result;
+                if (ixM == 0) {
+                    result=dispatchChain(request, reply, &regs[0]);
+                }
+                else if (ixM == 1) {
+                    result=dispatchSwitch(request, reply, &regs[1]);
+                }
+                else {
+                    router.setContext(&regs[2]);
+                    result=router.dispatch(request, reply);
+                }
+                checksum[ixM]+=result + replyBuff[4] + reply.size();
+            }
+        }
+        seconds[ixM]=duration<double>(steady_clock::now()-t0).count();
+    }
+    bool same=checksum[0] == checksum[1] && checksum[1] == checksum[2] && memcmp(&regs[0], &regs[1], sizeof(Registers)) == 0 &&
+              memcmp(&regs[1], &regs[2], sizeof(Registers)) == 0;
+    printf("Same replies and registers: %s\n", same ? "OK" : "FAILED");
+
+    const double count=double(REQUESTS) * rounds;
+    const char *names[]={"if/else chain", "switch", "DMPacketRouter"};
+    for (int ixM=0; ixM<3; ixM++) {
+        printf("%-15s %6.2f ns/request\n", names[ixM], seconds[ixM] * 1e9 / count);
+    }
+    printf("Table: %zu bytes for 256 commands\n", sizeof(router));
+
+    return same ? 0 : 1;
+}
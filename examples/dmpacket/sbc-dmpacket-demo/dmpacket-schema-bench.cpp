@@ -0,0 +1,240 @@
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <dmpacket>
+
+// Typical telemetry message: 20 fields, 55 bytes on the wire
+struct Telemetry {
+    uint8_t cmd;
+    uint8_t flags;
+    uint16_t seq;
+    uint32_t timestampMs;
+    float busVoltage;
+    float shuntVoltage;
+    float current;
+    float power;
+    float energy;
+    float charge;
+    int16_t dieTemp;
+    int16_t boardTemp;
+    uint16_t alerts;
+    uint16_t conversionUs;
+    int32_t encoder;
+    uint32_t uptimeS;
+    uint8_t mode;
+    bool charging;
+    bool fault;
+    float setpoint;
+};
+
+typedef DMPacketSchema<Telemetry,
+    DMPACKET_FIELD(Telemetry, cmd),
+    DMPACKET_FIELD(Telemetry, flags),
+    DMPACKET_FIELD(Telemetry, seq),
+    DMPACKET_FIELD(Telemetry, timestampMs),
+    DMPACKET_FIELD(Telemetry, busVoltage),
+    DMPACKET_FIELD(Telemetry, shuntVoltage),
+    DMPACKET_FIELD(Telemetry, current),
+    DMPACKET_FIELD(Telemetry, power),
+    DMPACKET_FIELD(Telemetry, energy),
+    DMPACKET_FIELD(Telemetry, charge),
+    DMPACKET_FIELD(Telemetry, dieTemp),
+    DMPACKET_FIELD(Telemetry, boardTemp),
+    DMPACKET_FIELD(Telemetry, alerts),
+    DMPACKET_FIELD(Telemetry, conversionUs),
+    DMPACKET_FIELD(Telemetry, encoder),
+    DMPACKET_FIELD(Telemetry, uptimeS),
+    DMPACKET_FIELD(Telemetry, mode),
+    DMPACKET_FIELD(Telemetry, charging),
+    DMPACKET_FIELD(Telemetry, fault),
+    DMPACKET_FIELD(Telemetry, setpoint)> TelemetrySchema;
+
+static_assert(TelemetrySchema::SIZE == 55, "wire size");
+
+#define MESSAGES 2000000
+
+// Hand-written per-field calls (the schema must produce the same bytes)
+template<typename P>
+static void pushFields(P& packet, const Telemetry& t)
+{
+    packet.pushByte(t.cmd);
+    packet.pushByte(t.flags);
+    packet.pushWord(t.seq);
+    packet.pushDWord(t.timestampMs);
+    packet.pushFloat(t.busVoltage);
+    packet.pushFloat(t.shuntVoltage);
+    packet.pushFloat(t.current);
+    packet.pushFloat(t.power);
+    packet.pushFloat(t.energy);
+    packet.pushFloat(t.charge);
+    packet.pushInt16(t.dieTemp);
+    packet.pushInt16(t.boardTemp);
+    packet.pushWord(t.alerts);
+    packet.pushWord(t.conversionUs);
+    packet.pushDWord((uint32_t) t.encoder);
+    packet.pushDWord(t.uptimeS);
+    packet.pushByte(t.mode);
+    packet.pushBool(t.charging);
+    packet.pushBool(t.fault);
+    packet.pushFloat(t.setpoint);
+}
+
+static bool shiftFields(DMPacketView& view, Telemetry& t)
+{
+    t.cmd=view.shiftByte();
+    t.flags=view.shiftByte();
+    t.seq=view.shiftWord();
+    t.timestampMs=view.shiftDWord();
+    t.busVoltage=view.shiftFloat();
+    t.shuntVoltage=view.shiftFloat();
+    t.current=view.shiftFloat();
+    t.power=view.shiftFloat();
+    t.energy=view.shiftFloat();
+    t.charge=view.shiftFloat();
+    t.dieTemp=view.shiftInt16();
+    t.boardTemp=view.shiftInt16();
+    t.alerts=view.shiftWord();
+    t.conversionUs=view.shiftWord();
+    t.encoder=view.shiftInt32();
+    t.uptimeS=view.shiftDWord();
+    t.mode=view.shiftByte();
+    t.charging=view.shiftBool();
+    t.fault=view.shiftBool();
+    t.setpoint=view.shiftFloat();
+    return !view.overflow();
+}
+
+static void fill(Telemetry& t, uint32_t seq)
+{
+    t.cmd=0x42;
+    t.flags=seq & 0x0F;
+    t.seq=seq & 0xFFFF;
+    t.timestampMs=seq * 10;
+    t.busVoltage=12.0f + seq * 0.001f;
+    t.shuntVoltage=0.002f;
+    t.current=1.5f;
+    t.power=18.0f;
+    t.energy=seq * 0.18f;
+    t.charge=seq * 0.015f;
+    t.dieTemp=2500;
+    t.boardTemp=-120;
+    t.alerts=0;
+    t.conversionUs=1052;
+    t.encoder=-(int32_t) seq;
+    t.uptimeS=seq / 100;
+    t.mode=3;
+    t.charging=seq & 1;
+    t.fault=false;
+    t.setpoint=13.8f;
+}
+
+static bool same(const Telemetry& a, const Telemetry& b)
+{
+    return a.cmd == b.cmd && a.flags == b.flags && a.seq == b.seq && a.timestampMs == b.timestampMs &&
+           a.busVoltage == b.busVoltage && a.shuntVoltage == b.shuntVoltage && a.current == b.current &&
+           a.power == b.power && a.energy == b.energy && a.charge == b.charge && a.dieTemp == b.dieTemp &&
+           a.boardTemp == b.boardTemp && a.alerts == b.alerts && a.conversionUs == b.conversionUs &&
+           a.encoder == b.encoder && a.uptimeS == b.uptimeS && a.mode == b.mode && a.charging == b.charging &&
+           a.fault == b.fault && a.setpoint == b.setpoint;
+}
+
+static bool checkAll(Telemetry *out, const Telemetry *expected)
+{
+    bool ok=true;
+    for (int ixM=0; ixM<256; ixM++) {
+        ok=ok && same(out[ixM], expected[ixM]);
+        out[ixM]=Telemetry();
+    }
+    return ok;
+}
+
+static void report(const char *name, double seconds)
+{
+    printf("%-34s %6.1f ns/message  %7.1f MB/s\n", name, seconds * 1e9 / MESSAGES,
+           double(MESSAGES) * TelemetrySchema::SIZE / seconds / 1e6);
+}
+
+int main()
+{
+    using namespace std::chrono;
+    static Telemetry messages[256];
+    for (uint32_t ixM=0; ixM<256; ixM++) {
+        fill(messages[ixM], ixM);
+    }
+
+    // Correctness: same bytes of the per-field calls, round trip, short buffer rejected
+    uint8_t a[TelemetrySchema::SIZE], b[TelemetrySchema::SIZE];
+    DMPacketWriter wa(a), wb(b);
+    pushFields(wa, messages[7]);
+    bool ok=TelemetrySchema::pack(wb, messages[7]) && wa.size() == wb.size() && memcmp(a, b, sizeof(a)) == 0;
+    Telemetry t;
+    DMPacketView view(b, sizeof(b));
+    ok=ok && TelemetrySchema::unpack(view, t) && same(t, messages[7]) && view.remaining() == 0;
+    DMPacketView shortView(b, sizeof(b) - 1);
+    ok=ok && !TelemetrySchema::unpack(shortView, t) && shortView.overflow();
+    printf("Schema of %zu bytes: %s\n", TelemetrySchema::SIZE, ok ? "OK" : "FAILED");
+
+    uint8_t tx[TelemetrySchema::SIZE];
+    DMPacketWriter writer(tx);
+    volatile uint32_t sink=0;
+    auto t0=steady_clock::now();
+    for (uint32_t ixM=0; ixM<MESSAGES; ixM++) {
+        writer.clear();
+        pushFields(writer, messages[ixM & 0xFF]);
+        sink=sink+tx[ixM & 0x1F];
+    }
+    report("DMPacketWriter per-field pack", duration<double>(steady_clock::now()-t0).count());
+
+    t0=steady_clock::now();
+    for (uint32_t ixM=0; ixM<MESSAGES; ixM++) {
+        writer.clear();
+        TelemetrySchema::pack(writer, messages[ixM & 0xFF]);
+        sink=sink+tx[ixM & 0x1F];
+    }
+    report("DMPacketWriter schema pack", duration<double>(steady_clock::now()-t0).count());
+
+    DMPacket packet;
+    t0=steady_clock::now();
+    for (uint32_t ixM=0; ixM<MESSAGES; ixM++) {
+        packet.clear();
+        pushFields(packet, messages[ixM & 0xFF]);
+        sink=sink+packet.size();
+    }
+    report("DMPacket per-field pack", duration<double>(steady_clock::now()-t0).count());
+
+    t0=steady_clock::now();
+    for (uint32_t ixM=0; ixM<MESSAGES; ixM++) {
+        packet.clear();
+        TelemetrySchema::pack(packet, messages[ixM & 0xFF]);
+        sink=sink+packet.size();
+    }
+    report("DMPacket schema pack", duration<double>(steady_clock::now()-t0).count());
+
+    // Unpack all 256 messages packed back to back
+    static Telemetry out[256];
+    static uint8_t rx[256 * TelemetrySchema::SIZE];
+    DMPacketWriter rxWriter(rx);
+    for (uint32_t ixM=0; ixM<256; ixM++) {
+        TelemetrySchema::pack(rxWriter, messages[ixM]);
+    }
+    t0=steady_clock::now();
+    for (uint32_t ixM=0; ixM<MESSAGES; ixM++) {
+        DMPacketView v(rx + (ixM & 0xFF) * TelemetrySchema::SIZE, TelemetrySchema::SIZE);
+        shiftFields(v, out[ixM & 0xFF]);
+        sink=sink+out[ixM & 0xFF].seq;
+    }
+    report("DMPacketView per-field unpack", duration<double>(steady_clock::now()-t0).count());
+    ok=ok && checkAll(out, messages);
+
+    t0=steady_clock::now();
+    for (uint32_t ixM=0; ixM<MESSAGES; ixM++) {
+        DMPacketView v(rx + (ixM & 0xFF) * TelemetrySchema::SIZE, TelemetrySchema::SIZE);
+        TelemetrySchema::unpack(v, out[ixM & 0xFF]);
+        sink=sink+out[ixM & 0xFF].seq;
+    }
+    report("DMPacketView schema unpack", duration<double>(steady_clock::now()-t0).count());
+    ok=ok && checkAll(out, messages);
+    printf("Unpacked messages: %s\n", ok ? "OK" : "FAILED");
+
+    return 0;
+}
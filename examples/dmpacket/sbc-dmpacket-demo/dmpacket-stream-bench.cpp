@@ -0,0 +1,164 @@
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+#include <dmpacket>
+
+// Packets of random length sent back to back on a stream, received in chunks of random size (as read_some() returns
+// them): every packet must come out whole, in order, whatever the chunk boundaries
+#define CAPACITY 256
+
+static const DMPacketStream::LengthType LENGTH_TYPES[]={DMPacketStream::LENGTH_VARINT, DMPacketStream::LENGTH_8,
+                                                        DMPacketStream::LENGTH_16, DMPacketStream::LENGTH_32};
+static const char *LENGTH_NAMES[]={"varint", "8 bit", "16 bit", "32 bit"};
+
+struct Sent {
+    size_t offset;  // payload in the stream
+    size_t size;
+};
+
+//! Build a stream of packets (about 1 in 20 longer than the buffer of the receiver, not with 8 bit lengths): @return the packets sent.
+static std::vector<Sent> makeStream(std::vector<uint8_t>& stream, size_t count, size_t maxSize, const DMPacketStream& sender, std::mt19937& rng)
+{
+    std::vector<Sent> sent;
+    std::vector<uint8_t> payload(CAPACITY * 2);
+    stream.assign(count * (CAPACITY * 2 + 5), 0);
+    DMPacketWriter writer(stream.data(), stream.size());
+    for (size_t ixP=0; ixP<count; ixP++) {
+        size_t size=rng() % 20 == 0 ? CAPACITY + 1 + rng() % CAPACITY : rng() % (maxSize + 1);
+        for (size_t ixB=0; ixB<size; ixB++) {
+            payload[ixB]=(uint8_t) rng();
+        }
+        if (sender.push(writer, payload.data(), size)) {
+            sent.push_back({writer.size() - size, size});
+        }
+    }
+    stream.resize(writer.size());
+    return sent;
+}
+
+static bool fuzz(DMPacketStream::LengthType lengthType, DMPacketByteOrder byteOrder, std::mt19937& rng)
+{
+    static uint8_t buff[CAPACITY];
+    DMPacketStream stream(buff, lengthType, byteOrder);
+    std::vector<uint8_t> bytes;
+    size_t maxSize=lengthType == DMPacketStream::LENGTH_8 ? 255 : CAPACITY;
+    std::vector<Sent> sent=makeStream(bytes, 5000, maxSize, stream, rng);
+
+    // Chunks of 1 byte to a few packets, through a reused receive buffer (views of the chunk die with it)
+    std::vector<uint8_t> chunk(4096);
+    size_t ixSent=0, skipped=0;
+    bool ok=true;
+    for (size_t offset=0; offset<bytes.size() && ok; ) {
+        size_t chunkSize=rng() % 4 == 0 ? 1 + rng() % 4 : 1 + rng() % chunk.size();
+        chunkSize=std::min(chunkSize, bytes.size() - offset);
+        memcpy(chunk.data(), bytes.data() + offset, chunkSize);
+        offset+=chunkSize;
+        const uint8_t *data=chunk.data();
+        size_t dataSize=chunkSize;
+        while (stream.parse(data, dataSize)) {
+            while (ixSent < sent.size() && sent[ixSent].size > CAPACITY) {
+                ixSent++;
+                skipped++;
+            }
+            DMPacketView packet=stream.packet();
+            ok=ok && ixSent < sent.size() && packet.size() == sent[ixSent].size &&
+               memcmp(packet.data(), bytes.data() + sent[ixSent].offset, packet.size()) == 0;
+            ixSent++;
+        }
+        ok=ok && dataSize == 0;
+    }
+    while (ixSent < sent.size() && sent[ixSent].size > CAPACITY) {
+        ixSent++;
+        skipped++;
+    }
+    ok=ok && ixSent == sent.size() && stream.getOverflowsCount() == skipped && stream.getErrorsCount() == 0 &&
+       stream.getPacketsCount() == sent.size() - skipped;
+
+    // Garbage: lengths are wrong, but nothing is read or written out of the buffers and every byte is consumed
+    std::vector<uint8_t> noise(1 << 16);
+    for (auto& b : noise) {
+        b=(uint8_t) rng();
+    }
+    stream.reset();
+    for (size_t offset=0; offset<noise.size() && ok; ) {
+        size_t chunkSize=std::min<size_t>(1 + rng() % 700, noise.size() - offset);
+        const uint8_t *data=noise.data() + offset;
+        size_t dataSize=chunkSize;
+        while (stream.parse(data, dataSize)) {
+            DMPacketView packet=stream.packet();
+            bool inChunk=packet.data() >= noise.data() + offset && packet.data() + packet.size() <= noise.data() + offset + chunkSize;
+            bool inBuff=packet.data() == buff && packet.size() <= CAPACITY;
+            ok=ok && (inChunk || inBuff);
+        }
+        ok=ok && dataSize == 0;
+        offset+=chunkSize;
+    }
+    return ok;
+}
+
+int main()
+{
+    using namespace std::chrono;
+    std::mt19937 rng(11);
+    for (int ixT=0; ixT<4; ixT++) {
+        bool ok=fuzz(LENGTH_TYPES[ixT], DMPACKET_BIG_ENDIAN, rng) && fuzz(LENGTH_TYPES[ixT], DMPACKET_LITTLE_ENDIAN, rng);
+        printf("Fuzz %-6s lengths: %s\n", LENGTH_NAMES[ixT], ok ? "OK" : "FAILED");
+        if (!ok) {
+            return 1;
+        }
+    }
+
+    // Truncated and malformed lengths, packets longer than a 8 bit length
+    static uint8_t buff[CAPACITY];
+    DMPacketStream varint(buff, DMPacketStream::LENGTH_VARINT);
+    const uint8_t malformed[]={0xFF, 0xFF, 0xFF, 0xFF, 0x7F, 0x02, 'h', 'i'};
+    const uint8_t *data=malformed;
+    size_t dataSize=sizeof(malformed);
+    bool ok=varint.parse(data, dataSize) && varint.getErrorsCount() == 1 && varint.packet().size() == 2 && dataSize == 0;
+    const uint8_t tail[]={0x01, 'x'};
+    data=tail;
+    dataSize=sizeof(tail);
+    ok=ok && varint.parse(data, dataSize) && varint.packet().size() == 1 && varint.packet().data() == tail + 1;
+    uint8_t tx[600];
+    DMPacketWriter writer(tx);
+    DMPacketStream small(buff, DMPacketStream::LENGTH_8);
+    ok=ok && !small.push(writer, tx, 300) && writer.size() == 0 && !writer.overflow();
+    printf("Errors: %s\n", ok ? "OK" : "FAILED");
+
+    // Throughput: 64 and 512 byte packets, read in chunks of a TCP segment and of a large socket read
+    for (size_t packetSize : {64, 512}) {
+        static uint8_t rxBuff[1024];
+        DMPacketStream sender(rxBuff);
+        std::vector<uint8_t> bytes(32 << 20);
+        DMPacketWriter w(bytes.data(), bytes.size());
+        std::vector<uint8_t> payload(packetSize, 0x5A);
+        size_t packets=0;
+        while (sender.push(w, payload.data(), payload.size())) {
+            packets++;
+        }
+        size_t streamSize=packets * (packetSize + 2);
+        for (size_t chunkSize : {1460, 65536}) {
+            DMPacketStream stream(rxBuff);
+            size_t received=0, sum=0;
+            auto t0=steady_clock::now();
+            for (size_t offset=0; offset<streamSize; offset+=chunkSize) {
+                const uint8_t *chunk=bytes.data() + offset;
+                size_t left=std::min(chunkSize, streamSize - offset);
+                while (stream.parse(chunk, left)) {
+                    DMPacketView packet=stream.packet();
+                    sum+=packet.size() + packet.data()[0];
+                    received++;
+                }
+            }
+            double seconds=duration<double>(steady_clock::now()-t0).count();
+            ok=ok && received == packets && sum == packets * (packetSize + 0x5A);
+            printf("%3zu byte packets, %5zu byte chunks: %6.0f MB/s, %5.1f M packets/s, %4.1f%% reassembled\n", packetSize,
+                   chunkSize, streamSize / seconds / 1e6, packets / seconds / 1e6, 100.0 * stream.getReassembledCount() / packets);
+        }
+    }
+    printf("Throughput run: %s\n", ok ? "OK" : "FAILED");
+
+    return ok ? 0 : 1;
+}
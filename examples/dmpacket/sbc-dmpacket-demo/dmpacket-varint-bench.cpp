@@ -0,0 +1,220 @@
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <dmpacket>
+
+// A telemetry frame of an INA226 streaming at about 1 kHz: 64 conversions of shunt and bus voltage registers, plus
+// the conversion timestamps in microseconds
+#define SAMPLES 64
+#define ROUNDS 20000
+
+struct Series {
+    uint32_t timestampUs[SAMPLES];
+    int16_t shunt[SAMPLES];     // 2.5 uV/LSB: 1 A on 2 mOhm is about 800 LSB, with noise
+    uint16_t bus[SAMPLES];      // 1.25 mV/LSB: 12 V is about 9600 LSB, with noise
+};
+
+static void makeSeries(Series& s, std::mt19937& rng)
+{
+    std::normal_distribution<double> noise(0.0, 1.0);
+    uint32_t t=1000000 + rng() % 1000;
+    for (int ixS=0; ixS<SAMPLES; ixS++) {
+        t+=1100 + (int) (noise(rng) * 3);
+        s.timestampUs[ixS]=t;
+        s.shunt[ixS]=(int16_t) (800 + 100 * sin(ixS * 0.1) + noise(rng) * 4);
+        s.bus[ixS]=(uint16_t) (9600 - ixS / 8 + noise(rng) * 1.5);
+    }
+}
+
+static void packFixed(DMPacketWriter& w, const Series& s)
+{
+    for (int ixS=0; ixS<SAMPLES; ixS++) {
+        w.pushDWord(s.timestampUs[ixS]);
+        w.pushInt16(s.shunt[ixS]);
+        w.pushWord(s.bus[ixS]);
+    }
+}
+
+static void unpackFixed(DMPacketView& v, Series& s)
+{
+    for (int ixS=0; ixS<SAMPLES; ixS++) {
+        s.timestampUs[ixS]=v.shiftDWord();
+        s.shunt[ixS]=v.shiftInt16();
+        s.bus[ixS]=v.shiftWord();
+    }
+}
+
+static void packDeltas(DMPacketWriter& w, const Series& s)
+{
+    // Base of timestamps in full, the rest as differences
+    w.pushVarUInt(s.timestampUs[0]);
+    w.pushDeltas(s.timestampUs + 1, SAMPLES - 1, s.timestampUs[0]);
+    w.pushDeltas(s.shunt, SAMPLES);
+    w.pushDeltas(s.bus, SAMPLES);
+}
+
+static void unpackDeltas(DMPacketView& v, Series& s)
+{
+    s.timestampUs[0]=v.shiftVarUInt();
+    v.shiftDeltasInto(s.timestampUs + 1, SAMPLES - 1, s.timestampUs[0]);
+    v.shiftDeltasInto(s.shunt, SAMPLES);
+    v.shiftDeltasInto(s.bus, SAMPLES);
+}
+
+static bool same(const Series& a, const Series& b)
+{
+    for (int ixS=0; ixS<SAMPLES; ixS++) {
+        if (a.timestampUs[ixS] != b.timestampUs[ixS] || a.shunt[ixS] != b.shunt[ixS] || a.bus[ixS] != b.bus[ixS]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool checkVarints(std::mt19937& rng)
+{
+    // Every length, both decode paths (with 8+ bytes after the value and at the end of the buffer), extremes
+    bool ok=true;
+    uint8_t buff[16];
+    for (int ixT=0; ixT<200000 && ok; ixT++) {
+        uint32_t v=rng() >> (rng() % 32);
+        int32_t sv=(int32_t) v;
+        if (ixT < 6) {
+            const uint32_t edge[]={0, 127, 128, 16383, 16384, 0xFFFFFFFF};
+            v=edge[ixT];
+            sv=ixT == 5 ? INT32_MIN : -(int32_t) v;
+        }
+        for (int tail=0; tail<2; tail++) {
+            memset(buff, 0xAA, sizeof(buff));
+            DMPacketWriter w(buff, tail ? sizeof(buff) : DMPacketVarint::size(v));
+            w.pushVarUInt(v);
+            DMPacketView view(buff, tail ? sizeof(buff) : w.size());
+            ok=ok && !w.overflow() && w.size() == DMPacketVarint::size(v) && view.shiftVarUInt() == v && view.getShiftIndex() == w.size();
+            DMPacketWriter ws(buff, sizeof(buff));
+            ws.pushVarInt(sv);
+            DMPacketView views(buff, tail ? sizeof(buff) : ws.size());
+            ok=ok && views.shiftVarInt() == sv && views.getShiftIndex() == ws.size();
+        }
+    }
+    // Truncated and too long encodings are rejected
+    const uint8_t truncated[]={0x80, 0x80};
+    const uint8_t tooLong[]={0xFF, 0xFF, 0xFF, 0xFF, 0x1F, 0, 0, 0, 0};
+    DMPacketView t(truncated, sizeof(truncated)), l(tooLong, sizeof(tooLong)), ls(tooLong, 5);
+    ok=ok && t.shiftVarUInt() == 0xFFFFFFFF && t.overflow() && l.shiftVarUInt() == 0xFFFFFFFF && l.overflow();
+    ok=ok && ls.shiftVarUInt() == 0xFFFFFFFF && ls.overflow();
+    // DMPacket
+    DMPacket p;
+    p.pushVarUInt(300);
+    p.pushVarInt(-3);
+    int16_t series[]={100, 98, 99, -20000, 32767};
+    int16_t back[5];
+    p.pushDeltas(series, 5);
+    ok=ok && p.shiftVarUInt() == 300 && p.shiftVarInt() == -3 && p.shiftDeltasInto(back, 5) == 5 && memcmp(series, back, sizeof(series)) == 0;
+    ok=ok && p.shiftDeltasInto(back, 1) == 0;
+    // Series after a shift that went past the end of the view (shiftIndex beyond the buffer)
+    uint8_t *three=new uint8_t[3]{1, 2, 3};
+    DMPacketView past(three, 3);
+    past.shiftWord();
+    past.shiftWord();
+    ok=ok && past.shiftDeltasInto(back, 4) == 0 && past.overflow();
+    delete[] three;
+    return ok;
+}
+
+int main()
+{
+    using namespace std::chrono;
+    std::mt19937 rng(7);
+    printf("Varint encoding/decoding: %s\n", checkVarints(rng) ? "OK" : "FAILED");
+
+    static Series series[64];
+    for (auto& s : series) {
+        makeSeries(s, rng);
+    }
+    static uint8_t tx[SAMPLES * 16];
+    Series out;
+
+    // Sizes (average over all series)
+    size_t fixedBytes=0, deltaBytes=0;
+    bool ok=true;
+    for (auto& s : series) {
+        DMPacketWriter wf(tx);
+        packFixed(wf, s);
+        fixedBytes+=wf.size();
+        DMPacketWriter wd(tx);
+        packDeltas(wd, s);
+        deltaBytes+=wd.size();
+        DMPacketView v=wd.view();
+        unpackDeltas(v, out);
+        ok=ok && !v.overflow() && v.remaining() == 0 && same(s, out);
+    }
+    printf("Delta series round trip: %s\n", ok ? "OK" : "FAILED");
+    printf("%d samples (timestamp, shunt, bus): fixed %zu bytes, varint deltas %.1f bytes (%.2fx smaller)\n", SAMPLES,
+           fixedBytes / 64, deltaBytes / 64.0, double(fixedBytes) / deltaBytes);
+
+    // Without timestamps (regular sampling, only the first one sent)
+    size_t fixedValues=0, deltaValues=0;
+    for (auto& s : series) {
+        DMPacketWriter wf(tx);
+        wf.pushDWord(s.timestampUs[0]);
+        for (int ixS=0; ixS<SAMPLES; ixS++) {
+            wf.pushInt16(s.shunt[ixS]);
+            wf.pushWord(s.bus[ixS]);
+        }
+        fixedValues+=wf.size();
+        DMPacketWriter wd(tx);
+        wd.pushVarUInt(s.timestampUs[0]);
+        wd.pushDeltas(s.shunt, SAMPLES);
+        wd.pushDeltas(s.bus, SAMPLES);
+        deltaValues+=wd.size();
+    }
+    printf("%d samples (shunt, bus):            fixed %zu bytes, varint deltas %.1f bytes (%.2fx smaller)\n", SAMPLES,
+           fixedValues / 64, deltaValues / 64.0, double(fixedValues) / deltaValues);
+
+    // Cost per value
+    volatile uint32_t sink=0;
+    const double values=double(ROUNDS) * SAMPLES * 3;
+    auto t0=steady_clock::now();
+    for (int ixR=0; ixR<ROUNDS; ixR++) {
+        DMPacketWriter w(tx);
+        packFixed(w, series[ixR & 63]);
+        sink=sink+w.size();
+    }
+    double fixedPack=duration<double>(steady_clock::now()-t0).count();
+    t0=steady_clock::now();
+    for (int ixR=0; ixR<ROUNDS; ixR++) {
+        DMPacketWriter w(tx);
+        packDeltas(w, series[ixR & 63]);
+        sink=sink+w.size();
+    }
+    double deltaPack=duration<double>(steady_clock::now()-t0).count();
+
+    static uint8_t fixedRx[64][SAMPLES * 8], deltaRx[64][SAMPLES * 16];
+    size_t deltaSize[64];
+    for (int ixS=0; ixS<64; ixS++) {
+        DMPacketWriter wf(fixedRx[ixS]);
+        packFixed(wf, series[ixS]);
+        DMPacketWriter wd(deltaRx[ixS]);
+        packDeltas(wd, series[ixS]);
+        deltaSize[ixS]=wd.size();
+    }
+    t0=steady_clock::now();
+    for (int ixR=0; ixR<ROUNDS; ixR++) {
+        DMPacketView v(fixedRx[ixR & 63], SAMPLES * 8);
+        unpackFixed(v, out);
+        sink=sink+out.bus[ixR & (SAMPLES - 1)];
+    }
+    double fixedUnpack=duration<double>(steady_clock::now()-t0).count();
+    t0=steady_clock::now();
+    for (int ixR=0; ixR<ROUNDS; ixR++) {
+        DMPacketView v(deltaRx[ixR & 63], deltaSize[ixR & 63]);
+        unpackDeltas(v, out);
+        sink=sink+out.bus[ixR & (SAMPLES - 1)];
+    }
+    double deltaUnpack=duration<double>(steady_clock::now()-t0).count();
+    printf("Encode: fixed %.2f ns/value, varint deltas %.2f ns/value\n", fixedPack * 1e9 / values, deltaPack * 1e9 / values);
+    printf("Decode: fixed %.2f ns/value, varint deltas %.2f ns/value\n", fixedUnpack * 1e9 / values, deltaUnpack * 1e9 / values);
+
+    return ok ? 0 : 1;
+}
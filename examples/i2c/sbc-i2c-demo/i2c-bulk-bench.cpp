@@ -0,0 +1,75 @@
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <chrono>
+#include <di2c>
+
+int main(int argc, char** argv) {
+
+    int busID=0;
+    int devAddr=0x50;
+    int cmdReg=0x00;
+    size_t totalLen=4096;
+    int loops=10;
+
+    if (argc >= 4) {
+        busID=atoi(argv[1]);
+        std::istringstream(argv[2]) >> std::hex >> devAddr;
+        std::istringstream(argv[3]) >> std::hex >> cmdReg;
+        if (argc >= 5) {
+            totalLen=atoi(argv[4]);
+        }
+        if (argc >= 6) {
+            loops=atoi(argv[5]);
+        }
+    }
+    else {
+        std::cout <<
+            "Usage: " << argv[0] << " <i2c bus> <device address> <register> [<bytes> [<loops>]]" << std::endl <<
+            "    <i2c bus> is the id of i2c device handled by /dev/i2c-..." << std::endl <<
+            "    <device address> is the i2c address of the device" << std::endl <<
+            "    <register> is the first register to read, it advances with chunk offset" << std::endl <<
+            "    <bytes> bytes to read each loop, default 4096" << std::endl <<
+            "    <loops> number of reads for each chunk size, default 10" << std::endl <<
+            "Measures bulk read throughput (askForBulk) against chunk size (i2cMaxBufferLength)." << std::endl <<
+            "Example:" << std::endl <<
+            "Read 4096 bytes from an eeprom on /dev/i2c-1 at address 0x50" << std::endl <<
+            argv[0] << " 1 0x50 0x00" << std::endl;
+
+        exit(1);
+    }
+
+    DI2CBus i2c(busID);
+    if (!i2c.isReady()) {
+        std::cerr << "Failed to open bus: " << i2c.getLastError() << std::endl;
+        return 1;
+    }
+
+    std::vector<uint8_t> recvBuf(totalLen);
+    const size_t chunkSizes[]={ 8, 16, 32, 64, 128, 256, 1024, 0 };
+
+    printf("Chunk\tioctl\tTime(ms)\tBytes/s\r\n");
+    for (size_t chunkLen : chunkSizes) {
+        DI2CMaster master(i2c.handle(),chunkLen);
+        DI2CBusStats::DSnapshot before, after;
+        master.getBusStats()->getSnapshot(devAddr,before);
+
+        auto start=std::chrono::steady_clock::now();
+        for (int ixL=0; ixL<loops; ixL++) {
+            if (!master.askForBulk(devAddr,cmdReg,recvBuf.data(),recvBuf.size())) {
+                std::cerr << "Read failed: " << master.getLastError() << std::endl;
+                return 1;
+            }
+        }
+        double elapsed=std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+
+        master.getBusStats()->getSnapshot(devAddr,after);
+        printf("%s\t%llu\t%.02f\t\t%.0f\r\n",
+            chunkLen == 0 ? "none" : std::to_string(chunkLen).c_str(),
+            (unsigned long long) (after.transactions-before.transactions)/loops,
+            elapsed*1000.0/loops,
+            totalLen*loops/elapsed);
+    }
+
+    return 0;
+}
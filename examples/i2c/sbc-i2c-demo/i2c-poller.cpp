@@ -0,0 +1,72 @@
+#include <iostream>
+#include <sstream>
+#include <memory>
+#include <map>
+#include <vector>
+#include <dutils>
+#include <di2cpoller>
+#include <INA226/INA226.h>
+
+int main(int argc, char** argv) {
+
+    if (argc < 2) {
+        std::cout <<
+            "Usage: " << argv[0] << " <i2c bus>:<INA226 address> [<i2c bus>:<INA226 address> ...]" << std::endl <<
+            "    <i2c bus> is the id of i2c device handled by /dev/i2c-..." << std::endl <<
+            "    <INA226 address> is the i2c address of the sensor" << std::endl <<
+            "Each bus is polled by its own thread, so the cycle time is the one of the slowest bus." << std::endl <<
+            "Example:" << std::endl <<
+            "Read 3 INA226 on /dev/i2c-1, /dev/i2c-3, /dev/i2c-4" << std::endl <<
+            argv[0] << " 1:0x40 3:0x40 4:0x41" << std::endl;
+
+        exit(1);
+    }
+
+    std::map<int, std::unique_ptr<DI2CBus>> buses;
+    std::vector<std::unique_ptr<INA226>> sensors;
+    std::vector<int> tasks;
+    DI2CPoller poller;
+
+    for (int ixA=1; ixA<argc; ixA++) {
+        int busID=0;
+        int devAddr=0x40;
+        char sep;
+        std::istringstream arg(argv[ixA]);
+        arg >> std::dec >> busID >> sep >> std::hex >> devAddr;
+
+        // One DI2CBus for each bus
+        if (buses.find(busID) == buses.end()) {
+            buses[busID]=std::make_unique<DI2CBus>(busID);
+        }
+        DI2CBus *bus=buses[busID].get();
+
+        sensors.push_back(std::make_unique<INA226>(devAddr,0.002,bus->handle()));
+        INA226 *ina226=sensors.back().get();
+        if (!ina226->begin(10.0)) {
+            std::cerr << "Failed to initialize INA226 on " << argv[ixA] << ": " << ina226->getLastError() << std::endl;
+            return 1;
+        }
+        tasks.push_back(poller.addTask(bus->handle(), [ina226](double& value) {
+            value=ina226->getCurrent();
+            return ina226->getLastError() == "Success";
+        }));
+    }
+
+    if (!poller.start()) {
+        std::cerr << "Poller start failed: " << poller.getLastError() << std::endl;
+        return 1;
+    }
+
+    std::cout << "Polling " << sensors.size() << " sensors on " << poller.busesCount() << " buses" << std::endl;
+    std::cout << "Press CTRL+C to stop" << std::endl;
+
+    do{
+        for (size_t ixT=0; ixT<tasks.size(); ixT++) {
+            printf("%s = %.03f A  ", argv[ixT+1], poller.getValue(tasks[ixT]));
+        }
+        printf("cycle = %lu us\r\n", (unsigned long) poller.getCycleTime());
+        delay(1000);
+    }while(true);
+
+    return 0;
+}
@@ -0,0 +1,57 @@
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <INAScale/INAScale.h>
+
+// Run f loops times, returns million of samples per second
+template<typename F>
+double bench(F f, size_t samples, int loops) {
+    auto start=std::chrono::steady_clock::now();
+    for (int ixL=0; ixL<loops; ixL++) {
+        f();
+    }
+    double elapsed=std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+    return samples*loops/elapsed/1e6;
+}
+
+int main(int argc, char** argv) {
+
+    size_t samples=4096;
+    int loops=20000;
+    if (argc >= 2) {
+        samples=atoi(argv[1]);
+    }
+    if (argc >= 3) {
+        loops=atoi(argv[2]);
+    }
+    std::cout << "Scale " << samples << " raw samples " << loops << " times (usage: " << argv[0] << " [samples [loops]])" << std::endl;
+
+    // INA226 shunt voltage like values
+    std::vector<int32_t> raw(samples);
+    for (size_t ixS=0; ixS<samples; ixS++) {
+        raw[ixS]=(rand() % 65536) - 32768;
+    }
+    std::vector<float> outFloat(samples);
+    std::vector<int32_t> outFixed(samples);
+    const float lsb=2.5e-6f;
+    const INAFixedScale scale=INAScale::fixedScale(lsb,1e-6);
+
+    printf("Kernel\t\t\tMsamples/s\r\n");
+    printf("toFloatScalar\t\t%.1f\r\n", bench([&]() { INAScale::toFloatScalar(raw,lsb,outFloat); }, samples, loops));
+    printf("toFloat (SIMD)\t\t%.1f\r\n", bench([&]() { INAScale::toFloat(raw,lsb,outFloat); }, samples, loops));
+    printf("toFixedScalar\t\t%.1f\r\n", bench([&]() { INAScale::toFixedScalar(raw,scale,outFixed); }, samples, loops));
+    printf("toFixed (SIMD)\t\t%.1f\r\n", bench([&]() { INAScale::toFixed(raw,scale,outFixed); }, samples, loops));
+
+    // Check fixed point against float
+    int32_t maxErr=0;
+    INAScale::toFloat(raw,lsb,outFloat);
+    INAScale::toFixed(raw,scale,outFixed);
+    for (size_t ixS=0; ixS<samples; ixS++) {
+        maxErr=std::max(maxErr,std::abs(outFixed[ixS]-int32_t(std::lround(outFloat[ixS]*1e6))));
+    }
+    printf("Fixed point max error: %d uV\r\n", maxErr);
+
+    return 0;
+}
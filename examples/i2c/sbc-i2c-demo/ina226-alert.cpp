@@ -0,0 +1,76 @@
+#include <iostream>
+#include <sstream>
+#include <atomic>
+#include <chrono>
+#include <dutils>
+#include <dgpiochip>
+#include <INA226/INA226.h>
+
+int main(int argc, char** argv) {
+
+    int busID=0;
+    int devAddr=0x40;
+    int alertPin=0;
+    float limit=0;
+
+    if (argc == 5) {
+        busID=atoi(argv[1]);
+        std::istringstream(argv[2]) >> std::hex >> devAddr;
+        alertPin=atoi(argv[3]);
+        limit=atof(argv[4]);
+    }
+    else {
+        std::cout <<
+            "Usage: " << argv[0] << " <i2c bus> <INA226 address> <ALERT gpio> <max current>" << std::endl <<
+            "    <i2c bus> is the id of i2c device handled by /dev/i2c-..." << std::endl <<
+            "    <INA226 address> is the i2c address of the sensor, default 0x40" << std::endl <<
+            "    <ALERT gpio> is the gpio (of chip 0) connected to INA226 ALERT pin" << std::endl <<
+            "    <max current> over-current limit in A, checked by the chip at every conversion" << std::endl <<
+            "Example:" << std::endl <<
+            "Alert over 5 A from INA226 on /dev/i2c-1 at address 0x40, ALERT on gpio 17" << std::endl <<
+            argv[0] << " 1 0x40 17 5.0" << std::endl;
+
+        exit(1);
+    }
+
+    DI2CBus i2c(busID);
+    DGpioChip chip(0);
+    if (!chip.isReady()) {
+        std::cerr << "DGpioChip not ready: " << chip.getLastError() << std::endl;
+        return 1;
+    }
+
+    INA226 ina226(devAddr,0.002,i2c.handle());
+    if (!ina226.begin(10.0)) {
+        std::cerr << "Failed to initialize INA226: " << ina226.getLastError() << std::endl;
+        return 1;
+    }
+
+    // The handler runs in lgpio alert thread: just take note, i2c is done by main loop
+    std::atomic<uint64_t> faultUs{0};
+    bool ret=ina226.attachAlertHandler(alertPin, chip.handle(), [&faultUs](const INA226::AlertEvent& event) {
+        faultUs=event.timestampUs;
+    });
+    ret=ret && ina226.setAlert(INA226::ALERT_SHUNT_OVER, limit);
+    if (!ret) {
+        std::cerr << "Failed to set alert: " << ina226.getLastError() << std::endl;
+        return 1;
+    }
+    std::cout << "Over-current alert at " << limit << " A, telemetry every second" << std::endl;
+    std::cout << "Press CTRL+C to stop" << std::endl;
+
+    do{
+        uint64_t eventUs=faultUs.exchange(0);
+        if (eventUs) {
+            uint64_t nowUs=std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+            float current=ina226.getCurrent();
+            bool active=false;
+            ina226.acknowledgeAlert(active);
+            printf("OVER-CURRENT: %.03f A, fault %llu us ago (alerts = %u)\r\n", current, (unsigned long long) (nowUs-eventUs), ina226.getAlertCount());
+        }
+        printf("Current = %.03f A\r\n", ina226.getCurrent());
+        delay(1000);
+    }while(true);
+
+    return 0;
+}
@@ -35,13 +35,18 @@ int main(int argc, char** argv) {
     std::cout << "Press CTRL+C to stop" << std::endl;
 
     do{
-        printf("Voltage = %.02f V ", ina228.voltage());
-        printf("Current = %.02f A ", ina228.current());
-        printf("Power   = %.02f W\r\n", ina228.power());
-        printf("Die Temp = %.02f V ", ina228.dietemp());
-        printf("Shunt Voltage = %.02f A ", ina228.shuntvoltage());
-        printf("Energy   = %.02f W", ina228.energy());
-        printf("Charge   = %.02f W\r\n", ina228.charge());
+        // All measurement registers in one transaction
+        INA228::Measurements values;
+        if (!ina228.readAll(values)) {
+            std::cerr << "Read failed: " << ina228.getLastError() << std::endl;
+        }
+        printf("Voltage = %.02f V ", values.busVoltage);
+        printf("Current = %.02f A ", values.current);
+        printf("Power   = %.02f W\r\n", values.power);
+        printf("Die Temp = %.02f C ", values.dieTemp);
+        printf("Shunt Voltage = %.04f mV ", values.shuntVoltage);
+        printf("Energy   = %.02f J ", values.energy);
+        printf("Charge   = %.02f C\r\n", values.charge);
         delay(1000);
     }while(true);
 
@@ -0,0 +1,64 @@
+#include <iostream>
+#include <memory>
+#include <map>
+#include <dutils>
+#include <PowerMonitorArray/DPowerMonitorArray.h>
+
+int main(int argc, char** argv) {
+
+    if (argc < 2) {
+        std::cout <<
+            "Usage: " << argv[0] << " <i2c bus> [<i2c bus> ...]" << std::endl <<
+            "    <i2c bus> is the id of i2c device handled by /dev/i2c-..." << std::endl <<
+            "All INA226/INA228 found at 0x40..0x4F of each bus (shunt 0.1 Ohm, 0.8 A max) are sampled together." << std::endl <<
+            "Example:" << std::endl <<
+            "Sample all sensors on /dev/i2c-1 and /dev/i2c-3" << std::endl <<
+            argv[0] << " 1 3" << std::endl;
+
+        exit(1);
+    }
+
+    std::map<int, std::unique_ptr<DI2CBus>> buses;
+    DPowerMonitorArray array;
+
+    for (int ixA=1; ixA<argc; ixA++) {
+        int busID=atoi(argv[ixA]);
+        if (buses.find(busID) == buses.end()) {
+            buses[busID]=std::make_unique<DI2CBus>(busID);
+        }
+        int found=array.discover(buses[busID]->handle(), 0.1, 0.8);
+        std::cout << "/dev/i2c-" << busID << ": " << found << " sensors" << std::endl;
+    }
+
+    if (array.channelsCount() == 0) {
+        std::cerr << "No sensors found" << std::endl;
+        return 1;
+    }
+    if (!array.begin(1100)) {
+        std::cerr << "Failed to initialize sensors: " << array.getLastError() << std::endl;
+        return 1;
+    }
+
+    std::cout << "Press CTRL+C to stop" << std::endl;
+
+    DPowerMonitorArray::DFrame frame;
+    do{
+        if (!array.sample(frame)) {
+            std::cerr << "Sample failed: " << array.getLastError() << std::endl;
+        }
+        printf("#%llu skew = %u us  ", (unsigned long long) frame.sequence, frame.skewUs);
+        for (size_t ixCh=0; ixCh<frame.channelsCount; ixCh++) {
+            const DPowerMonitorArray::DReading& reading=frame.readings[ixCh];
+            if (reading.valid) {
+                printf("[%zu] %.03f V %.04f A  ", ixCh, reading.busVoltage, reading.current);
+            }
+            else {
+                printf("[%zu] ---  ", ixCh);
+            }
+        }
+        printf("\r\n");
+        delay(1000);
+    }while(true);
+
+    return 0;
+}
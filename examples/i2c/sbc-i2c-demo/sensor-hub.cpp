@@ -0,0 +1,73 @@
+#include <iostream>
+#include <dutils>
+#include <dsensorhub>
+#include <INA226/INA226.h>
+#include <INA228/INA228.h>
+
+int main(int argc, char** argv) {
+
+    if (argc < 4) {
+        std::cout <<
+            "Usage: " << argv[0] << " <i2c bus> <INA226 address> <INA228 address>" << std::endl <<
+            "    <i2c bus> is the id of i2c device handled by /dev/i2c-..." << std::endl <<
+            "Both sensors are read at their conversion rate and their samples merged in one stream." << std::endl <<
+            "Example:" << std::endl <<
+            "INA226 at 0x40 and INA228 at 0x41 on /dev/i2c-1" << std::endl <<
+            argv[0] << " 1 0x40 0x41" << std::endl;
+
+        exit(1);
+    }
+
+    DI2CBus bus(atoi(argv[1]));
+    INA226 ina226(strtol(argv[2], NULL, 0), 0.1, bus.handle());
+    INA228 ina228(strtol(argv[3], NULL, 0), bus.handle());
+
+    if (!ina226.begin(0.8) || !ina226.tuneAdc(100)) {
+        std::cerr << "INA226 init failed: " << ina226.getLastError() << std::endl;
+        return 1;
+    }
+    ina228.setShunt(0.1, 0.8);
+    if (!ina228.begin() || !ina228.tuneAdc(10)) {
+        std::cerr << "INA228 init failed: " << ina228.getLastError() << std::endl;
+        return 1;
+    }
+
+    DSensorHub hub(4096);
+    DSensor *sensors[]={ &ina226, &ina228 };
+    for (DSensor *sensor : sensors) {
+        hub.addSensor(sensor);
+    }
+    if (!hub.start()) {
+        std::cerr << "Hub start failed: " << hub.getLastError() << std::endl;
+        return 1;
+    }
+
+    std::cout << "Press CTRL+C to stop" << std::endl;
+
+    DSensorSample batch[256];
+    do{
+        delay(1000);
+        size_t count=hub.popSamples(batch);
+        // Print the latest value of each channel
+        double latest[2][8]={};
+        for (size_t ixS=0; ixS<count; ixS++) {
+            latest[batch[ixS].sensorID][batch[ixS].channel]=batch[ixS].value;
+        }
+        for (size_t ixS=0; ixS<2; ixS++) {
+            std::span<const DSensorChannel> channels=sensors[ixS]->getChannels();
+            for (size_t ixC=0; ixC<channels.size(); ixC++) {
+                printf("[%zu] %s = %.4f %s\r\n", ixS, channels[ixC].name, latest[ixS][ixC], channels[ixC].unit);
+            }
+        }
+        for (size_t ixS=0; ixS<hub.sensorsCount(); ixS++) {
+            DSensorHub::DSensorTiming timing;
+            hub.getTiming(ixS, timing);
+            printf("[%zu] period %u us, read %llu us (max %llu), late max %llu us, %u reads, %u errors\r\n", ixS,
+                   timing.periodUs, (unsigned long long) timing.avgReadUs, (unsigned long long) timing.maxReadUs,
+                   (unsigned long long) timing.maxLateUs, timing.reads, timing.errors);
+        }
+        printf("%zu samples, %zu dropped\r\n\r\n", count, hub.getDroppedCount());
+    }while(true);
+
+    return 0;
+}
@@ -0,0 +1,86 @@
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <dstats>
+
+static uint64_t timestampUs=0;
+
+// Push all samples loops times, returns nanoseconds per sample
+template<typename F>
+double bench(F f, const std::vector<double>& values, int loops) {
+    // Timestamps go on from previous bench: windows keep sliding
+    auto start=std::chrono::steady_clock::now();
+    for (int ixL=0; ixL<loops; ixL++) {
+        for (double value : values) {
+            f(timestampUs,value);
+            timestampUs+=100;   // 10 kHz
+        }
+    }
+    double elapsed=std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+    return elapsed*1e9/(values.size()*loops);
+}
+
+// Windows are static: sliding windows hold 48 bytes each sample
+static DSlidingStats<1000> sliding(100000);     // last 100 ms (1000 samples at 10 kHz)
+static DSlidingStats<64> check;
+
+int main(int argc, char** argv) {
+
+    size_t samples=10000;
+    int loops=100;
+    if (argc >= 2) {
+        samples=atoi(argv[1]);
+    }
+    if (argc >= 3) {
+        loops=atoi(argv[2]);
+    }
+    std::cout << "Push " << samples << " samples (10 kHz timestamps) " << loops << " times (usage: " << argv[0] << " [samples [loops]])" << std::endl;
+
+    // INA226 current like values: 1 A with 50 Hz ripple and noise
+    std::vector<double> values(samples);
+    for (size_t ixS=0; ixS<samples; ixS++) {
+        values[ixS]=1.0+0.2*std::sin(ixS*2*M_PI*50/10000)+(rand() % 1000)*1e-5;
+    }
+
+    DRunningStats running;
+    DTumblingStats tumbling(1000000);
+    DEma ema=DEma::withTimeConstant(10000);
+
+    printf("Statistics\t\tns/sample\r\n");
+    printf("DRunningStats\t\t%.1f\r\n", bench([&](uint64_t ts, double v) { running.push(ts,v); }, values, loops));
+    printf("DTumblingStats\t\t%.1f\r\n", bench([&](uint64_t ts, double v) { tumbling.push(ts,v); }, values, loops));
+    printf("DSlidingStats<1000>\t%.1f\r\n", bench([&](uint64_t ts, double v) { sliding.push(ts,v); }, values, loops));
+    printf("DEma\t\t\t%.1f\r\n", bench([&](uint64_t ts, double v) { ema.push(ts,v); }, values, loops));
+    double allNs=bench([&](uint64_t ts, double v) {
+        running.push(ts,v);
+        tumbling.push(ts,v);
+        sliding.push(ts,v);
+        ema.push(ts,v);
+    }, values, loops);
+    printf("All of them\t\t%.1f (max %.0f kHz, %.2f%% of a core at 10 kHz)\r\n", allNs, 1e6/allNs, allNs*1e-3);
+
+    // Check sliding window against a direct computation of last 64 samples
+    double maxErr=0;
+    for (size_t ixS=0; ixS<samples; ixS++) {
+        check.push(ixS,values[ixS]);
+        size_t first=ixS >= 63 ? ixS-63 : 0;
+        double sum=0, sumSq=0, minV=values[first], maxV=values[first];
+        for (size_t ixW=first; ixW<=ixS; ixW++) {
+            sum+=values[ixW];
+            sumSq+=values[ixW]*values[ixW];
+            minV=std::min(minV,values[ixW]);
+            maxV=std::max(maxV,values[ixW]);
+        }
+        size_t count=ixS-first+1;
+        DStatsResult result=check.getResult();
+        maxErr=std::max({ maxErr, std::abs(result.mean-sum/count), std::abs(result.rms-std::sqrt(sumSq/count)),
+                          std::abs(result.min-minV), std::abs(result.max-maxV) });
+    }
+    printf("Sliding window max error: %.3g\r\n", maxErr);
+    printf("Mean %.4f A, last second %.4f A (rms %.4f A), last 100 ms %.4f A, EMA %.4f A\r\n", running.getResult().mean,
+           tumbling.getLastWindow().mean, tumbling.getLastWindow().rms, sliding.getResult().mean, ema.getValue());
+
+    return 0;
+}
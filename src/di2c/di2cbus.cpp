@@ -8,6 +8,7 @@
 #include <map>
 #include <iostream>
 #include "di2cbus.h"
+#include "di2cstats.h"
 #include <dutils>
 #include <fstream>
 #include <filesystem>
@@ -43,6 +44,10 @@ DI2CBus::DI2CBus(uint8_t busID)
     busHandle = open(busName.c_str(), O_RDWR);
     //std::cout << strerror(errno) << std::endl;
     lastErrorString=strerror(errno);
+    if (busHandle >= 0) {
+        // Handle can be reused by system after a close: start with clean statistics
+        DI2CBusStats::forBus(busHandle).reset();
+    }
 }
 
 DI2CBus::~DI2CBus()
@@ -141,6 +146,31 @@ int DI2CBus::openI2CBus(int busID)
     return busHandle;
 }
 
+/**
+ * @brief Get the bus number of an open bus handle (handles change between runs, bus numbers don't).
+ * 
+ * @param busHandle -> handle of an open /dev/i2c-N or /dev/i2c/N device.
+ * @return bus number N, or -1 if the handle is not an i2c bus device.
+ */
+int DI2CBus::busIDFromHandle(DI2CBusHandle busHandle)
+{
+    std::error_code ec;
+    fs::path devPath=fs::read_symlink("/proc/self/fd/" + std::to_string(busHandle), ec);
+    if (ec) {
+        return -1;
+    }
+
+    std::string devName=devPath.string();
+    for (const char *prefix : { DI2C_BUS_DEV_PREFIX "-", DI2C_BUS_DEV_PREFIX "/" }) {
+        size_t prefixLen=strlen(prefix);
+        if (devName.compare(0, prefixLen, prefix) == 0 && devName.size() > prefixLen &&
+            devName.find_first_not_of("0123456789", prefixLen) == std::string::npos) {
+            return std::stoi(devName.substr(prefixLen));
+        }
+    }
+    return -1;
+}
+
 int DI2CBus::scanI2CBusses(std::vector<DI2CBus::DI2CAdaper> &resultList)
 {
     // Devices path where to search
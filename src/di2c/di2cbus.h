@@ -27,6 +27,7 @@ class DI2CBus {
         std::string getInfo(void);
 
         static int openI2CBus(int busID);
+        static int busIDFromHandle(DI2CBusHandle busHandle);
         static int scanI2CBusses(std::vector<DI2CAdaper> &resultList);
 
         std::vector<uint8_t> devices;
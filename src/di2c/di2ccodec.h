@@ -0,0 +1,155 @@
+#ifndef DI2CCodec_H
+#define DI2CCodec_H
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <type_traits>
+
+/**
+ * @brief Typed codec for i2c register content.
+ *
+ * Converts typed values from/to the raw bytes of a register directly inside the caller buffer (i.e. the i2c message
+ * buffer itself), so no temporary copies are made: on gcc/clang -O2 decode<uint32_t>() compiles to a single load
+ * plus a bswap instruction.
+ *
+ * Template parameters:
+ * - T  ->  value type (any integral or floating point type).
+ * - E  ->  byte order of the register (std::endian::big for most of sensors, MSB first).
+ * - N  ->  register width in bytes (default sizeof(T)). Can be lower than sizeof(T) for 24 bit (N=3) or 40 bit (N=5)
+ *          registers, like INA228 VSHUNT/CURRENT/ENERGY: signed types are sign-extended from N*8 bits (branch-free).
+ *
+ * @code
+ * uint8_t raw[3]={ 0xFF, 0xFF, 0xF0 };
+ * int32_t v=DI2CCodec::decode<int32_t,std::endian::big,3>(raw);   // v = -16
+ * @endcode
+ */
+class DI2CCodec {
+    public:
+        //! Unsigned integer with same size of T.
+        template<typename T>
+        using RawType = std::conditional_t<sizeof(T) == 1, uint8_t,
+                        std::conditional_t<sizeof(T) == 2, uint16_t,
+                        std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>>>;
+
+        /**
+         * @brief Reverse bytes of an unsigned integer.
+         */
+        template<typename U>
+        static constexpr U byteswap(U value)
+        {
+            static_assert(std::is_unsigned_v<U>, "byteswap() needs an unsigned type");
+            #ifdef __cpp_lib_byteswap
+                return std::byteswap(value);
+            #else
+                if constexpr (sizeof(U) == 1) {
+                    return value;
+                }
+                else if constexpr (sizeof(U) == 2) {
+                    return __builtin_bswap16(value);
+                }
+                else if constexpr (sizeof(U) == 4) {
+                    return __builtin_bswap32(value);
+                }
+                else {
+                    return __builtin_bswap64(value);
+                }
+            #endif
+        }
+
+        /**
+         * @brief Decode a register value.
+         *
+         * @param buf   ->  N bytes of the register as received from device.
+         * @return decoded value.
+         */
+        template<typename T, std::endian E = std::endian::big, size_t N = sizeof(T)>
+        static constexpr T decode(std::span<const uint8_t, N> buf)
+        {
+            checkTypes<T,N>();
+            using U = RawType<T>;
+            constexpr unsigned int shift = (sizeof(U) - N) * 8;
+
+            // Left-aligned raw value: register MSB is the MSB of raw
+            U raw = 0;
+            if (std::is_constant_evaluated()) {
+                for (size_t ixB=0; ixB<N; ixB++) {
+                    raw = static_cast<U>((static_cast<uint64_t>(raw) << 8) | buf[E == std::endian::big ? ixB : N-1-ixB]);
+                }
+                raw = static_cast<U>(static_cast<uint64_t>(raw) << shift);
+            }
+            else {
+                std::memcpy(&raw, buf.data(), N);
+                if constexpr (E != std::endian::native) {
+                    raw = byteswap(raw);
+                }
+                if constexpr (E == std::endian::little) {
+                    // Register bytes are now the lower ones
+                    raw = static_cast<U>(static_cast<uint64_t>(raw) << shift);
+                }
+            }
+
+            if constexpr (std::is_floating_point_v<T>) {
+                return std::bit_cast<T>(raw);
+            }
+            else if constexpr (std::is_signed_v<T>) {
+                // Arithmetic shift right: sign extension from N*8 bits
+                return static_cast<T>(static_cast<std::make_signed_t<U>>(raw) >> shift);
+            }
+            else {
+                return static_cast<T>(raw >> shift);
+            }
+        }
+
+        /**
+         * @brief Encode a value into register bytes.
+         *
+         * @param value ->  value to encode (if N < sizeof(T) upper bytes are discarded).
+         * @param buf   ->  N bytes destination (i.e. the i2c message buffer).
+         */
+        template<typename T, std::endian E = std::endian::big, size_t N = sizeof(T)>
+        static constexpr void encode(T value, std::span<uint8_t, N> buf)
+        {
+            checkTypes<T,N>();
+            using U = RawType<T>;
+            constexpr unsigned int shift = (sizeof(U) - N) * 8;
+
+            U raw = std::bit_cast<U>(value);
+            if (std::is_constant_evaluated()) {
+                for (size_t ixB=0; ixB<N; ixB++) {
+                    buf[E == std::endian::little ? ixB : N-1-ixB] = static_cast<uint8_t>(static_cast<uint64_t>(raw) >> (ixB * 8));
+                }
+            }
+            else {
+                if constexpr (E == std::endian::big) {
+                    // Register bytes are the upper ones
+                    raw = static_cast<U>(static_cast<uint64_t>(raw) << shift);
+                }
+                if constexpr (E != std::endian::native) {
+                    raw = byteswap(raw);
+                }
+                std::memcpy(buf.data(), &raw, N);
+            }
+        }
+
+    private:
+        template<typename T, size_t N>
+        static constexpr void checkTypes(void)
+        {
+            static_assert(std::is_integral_v<T> || std::is_floating_point_v<T>, "T must be an integral or floating point type");
+            static_assert(!std::is_same_v<T, bool>, "bool is not a register type");
+            static_assert(N > 0 && N <= sizeof(T), "register width N must be 1..sizeof(T)");
+            static_assert(!std::is_floating_point_v<T> || N == sizeof(T), "floating point registers must be full width");
+        }
+};
+
+// Compile time self check of 24 and 40 bit registers decoding
+static_assert(DI2CCodec::decode<int32_t,std::endian::big,3>(std::span<const uint8_t,3>(std::array<uint8_t,3>{ 0xFF, 0xFF, 0xF0 })) == -16);
+static_assert(DI2CCodec::decode<uint32_t,std::endian::big,3>(std::span<const uint8_t,3>(std::array<uint8_t,3>{ 0xFF, 0xFF, 0xF0 })) == 0xFFFFF0);
+static_assert(DI2CCodec::decode<int64_t,std::endian::big,5>(std::span<const uint8_t,5>(std::array<uint8_t,5>{ 0x80, 0x00, 0x00, 0x00, 0x01 })) == -549755813887LL);
+static_assert(DI2CCodec::decode<uint16_t,std::endian::little>(std::span<const uint8_t,2>(std::array<uint8_t,2>{ 0x34, 0x12 })) == 0x1234);
+
+#endif
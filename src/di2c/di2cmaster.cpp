@@ -12,6 +12,8 @@
  * Arduino Wire library set limit of each i2c transaction to 32 bytes, in this case, setting i2cMaxBufferLength to 32, the class handle it by it self:
  * - If value is 0, no limit are set.
  * - If value is greater than 0, write...() and askFor...() API truncate buffer of each transaction to this value (like arduino do), send...() API do as many transaction as need to send all data.
+ * - ...Bulk() API (askForBulk(), writeBulk(), recvBulk()) never truncate: data is split in chunks of this length, chunks
+ *   are packed in as few ioctl as the kernel message limit allows.
  * 
  * How to use:
  *
@@ -42,17 +44,12 @@
 #include <iostream>
 #include <map>
 #include <cstring>
-
-#define LOWORD(l) ((unsigned short)(l))
-#define HIWORD(l) ((unsigned short)(((unsigned int)(l) >> 16) & 0xFFFF))
-#define LOBYTE(w) ((uint8_t)(w&0x00FF))
-#define HIBYTE(w) ((uint8_t)((w>>8)&0x00FF))
-#define WORD(msb,lsb) ((msb << 8) | lsb)
-#define DWORD(msw,lsw) ((msw << 16) | lsw)
-#define DWORD_B(msb,next_msb,next_lsb,lsb) (msb << 24) | (next_msb << 16) | (next_lsb << 8) | lsb
+#include <algorithm>
+#include <chrono>
 
 #define ERR_TXT_SUCCESS "Success"
 #define ERR_BUS_HANDLE_NOT_VALID "Bus handle not valid"
+#define DI2C_MAX_MSG_LEN 8192
 
 
 /**
@@ -67,7 +64,9 @@ DI2CMaster::DI2CMaster(DI2CBusHandle i2cBusHandle, uint16_t i2cMaxBufferLength)
 {
     busHandle=i2cBusHandle;
     maxBufLength=i2cMaxBufferLength;
+    busStats=nullptr;
     if (busHandle >= 0) {
+        busStats=&DI2CBusStats::forBus(busHandle);
         lastErrorString=ERR_TXT_SUCCESS;
     }
     else {
@@ -95,6 +94,22 @@ std::string DI2CMaster::getLastError(void)
     return lastErrorString.empty() ? ERR_TXT_SUCCESS : lastErrorString;
 }
 
+/**
+ * @return statistics of the bus (shared by all DI2CMaster on same bus), nullptr if bus handle is not valid.
+ */
+DI2CBusStats* DI2CMaster::getBusStats(void)
+{
+    return busStats;
+}
+
+/**
+ * @return the bus handle passed to constructor.
+ */
+DI2CBusHandle DI2CMaster::getBusHandle(void)
+{
+    return busHandle;
+}
+
 /**
  * @brief Write a BYTE at specified i2c register of the slave device.
  * ...that means "send 1 command byte followed by 1 data byte"...
@@ -106,20 +121,7 @@ std::string DI2CMaster::getLastError(void)
  */
 bool DI2CMaster::writeByte(uint8_t slaveAddr, uint8_t cmdReg, uint8_t data)
 {
-    // Compose i2c message (2 bytes)
-    uint8_t sendBuf[2]={
-        cmdReg, // 1 byte command
-        data    // 1 byte data
-    };
-    struct i2c_msg message={slaveAddr, 0, 2, sendBuf};
-    struct i2c_rdwr_ioctl_data ioctlData={&message, 1};
-
-    // Perform I/O
-    if (!performIoctl(busHandle, I2C_RDWR, &ioctlData)) {
-        return false;
-    }
-
-    return true;
+    return write<uint8_t>(slaveAddr,cmdReg,data);
 }
 
 /**
@@ -133,20 +135,7 @@ bool DI2CMaster::writeByte(uint8_t slaveAddr, uint8_t cmdReg, uint8_t data)
  */
 bool DI2CMaster::writeWord(uint8_t slaveAddr, uint8_t cmdReg, uint16_t data)
 {
-    // Compose i2c message ( 3 bytes)
-    uint8_t sendBuf[3]={
-        cmdReg,                     // 1 byte command (aka register)
-        HIBYTE(data), LOBYTE(data)  // 2 bytes data
-    };
-    struct i2c_msg message={slaveAddr, 0, 3, sendBuf};
-    struct i2c_rdwr_ioctl_data ioctlData={&message, 1};
-
-    // Perform I/O
-    if (!performIoctl(busHandle, I2C_RDWR, &ioctlData)) {
-        return false;
-    }
-
-    return true;
+    return write<uint16_t>(slaveAddr,cmdReg,data);
 }
 
 /**
@@ -160,30 +149,7 @@ bool DI2CMaster::writeWord(uint8_t slaveAddr, uint8_t cmdReg, uint16_t data)
  */
 bool DI2CMaster::writeDWord(uint8_t slaveAddr, uint8_t cmdReg, uint32_t data)
 {
-    // Compose i2c message ( 5 bytes)
-    uint8_t sendBuf[5]={
-        cmdReg,                         // 1 byte command (aka register)
-        /*
-        HIWORD(HIBYTE(data)),
-        HIWORD(LOBYTE(data)),
-        LOWORD(HIBYTE(data)),
-        LOWORD(LOBYTE(data))            // 4 bytes data
-        */
-        // Più veloce
-        (uint8_t)(data >> 24),          // 4 bytes data
-        (uint8_t)(data >> 16),
-        (uint8_t)(data >> 8),
-        (uint8_t)(data & 0x000000FF)
-    };
-    struct i2c_msg message={slaveAddr, 0, 5, sendBuf};
-    struct i2c_rdwr_ioctl_data ioctlData={&message, 1};
-
-    // Perform I/O
-    if (!performIoctl(busHandle, I2C_RDWR, &ioctlData)) {
-        return false;
-    }
-
-    return true;
+    return write<uint32_t>(slaveAddr,cmdReg,data);
 }
 
 /**
@@ -197,12 +163,7 @@ bool DI2CMaster::writeDWord(uint8_t slaveAddr, uint8_t cmdReg, uint32_t data)
  */
 bool DI2CMaster::writeFloat(uint8_t slaveAddr, uint8_t cmdReg, float data)
 {
-    union {
-        float ff;
-        uint32_t ii;
-    }d;
-    d.ff=data;
-    return writeDWord(slaveAddr,cmdReg,d.ii);
+    return write<float>(slaveAddr,cmdReg,data);
 }
 
 /**
@@ -252,20 +213,9 @@ bool DI2CMaster::writeFloat(uint8_t slaveAddr, uint8_t cmdReg, float data)
  */
 uint8_t DI2CMaster::recvByte(uint8_t slaveAddr)
 {
-    // Recv byte
-    uint8_t recvByte=0xFF;
-
-    // Compose i2c message
-    struct i2c_msg message={slaveAddr, I2C_M_RD, 1, &recvByte};
-    struct i2c_rdwr_ioctl_data ioctlData={&message, 1};
-
-    // Perform I/O
-    if (!performIoctl(busHandle, I2C_RDWR, &ioctlData)) {
-        return 0xFF;
-    }
-
-    //printf("recvWord: %02X %02X\r\n",recvWord[0],recvWord[1]);
-    return recvByte;
+    uint8_t data=0xFF;
+    recv<uint8_t>(slaveAddr,data);
+    return data;
 }
 
 /**
@@ -276,20 +226,9 @@ uint8_t DI2CMaster::recvByte(uint8_t slaveAddr)
  */
 uint16_t DI2CMaster::recvWord(uint8_t slaveAddr)
 {
-    // Create recv buffer (2 bytes)
-    uint8_t recvWord[2]={ 0xFF, 0xFF };
-
-    // Compose i2c message
-    struct i2c_msg message={slaveAddr, I2C_M_RD, 2, recvWord};
-    struct i2c_rdwr_ioctl_data ioctlData={&message, 1};
-
-    // Perform I/O
-    if (!performIoctl(busHandle, I2C_RDWR, &ioctlData)) {
-        return 0xFFFF;
-    }
-
-    //printf("recvWord: %02X %02X\r\n",recvWord[0],recvWord[1]);
-    return WORD(recvWord[0],recvWord[1]);
+    uint16_t data=0xFFFF;
+    recv<uint16_t>(slaveAddr,data);
+    return data;
 }
 
 /**
@@ -300,20 +239,9 @@ uint16_t DI2CMaster::recvWord(uint8_t slaveAddr)
  */
 uint32_t DI2CMaster::recvDWord(uint8_t slaveAddr)
 {
-    // Create recv buffer (4 bytes)
-    uint8_t recvDWord[4]={ 0xFF, 0xFF, 0xFF, 0xFF };
-
-    // Compose i2c message
-    struct i2c_msg message={slaveAddr, I2C_M_RD, 4, recvDWord};
-    struct i2c_rdwr_ioctl_data ioctlData={&message, 1};
-
-    // Perform I/O
-    if (!performIoctl(busHandle, I2C_RDWR, &ioctlData)) {
-        return 0xFFFFFFFF;
-    }
-
-    //printf("recvWord: %02X %02X %02X %02X\r\n",recvDWord[0],recvDWord[1],recvDWord[2],recvDWord[3]);
-    return DWORD_B(recvDWord[0],recvDWord[1],recvDWord[2],recvDWord[3]);
+    uint32_t data=0xFFFFFFFF;
+    recv<uint32_t>(slaveAddr,data);
+    return data;
 }
 
 /**
@@ -324,12 +252,7 @@ uint32_t DI2CMaster::recvDWord(uint8_t slaveAddr)
  */
 float DI2CMaster::recvFloat(uint8_t slaveAddr)
 {
-    union {
-        float ff;
-        uint32_t ii;
-    }d;
-    d.ii=recvDWord(slaveAddr);
-    return d.ff;
+    return std::bit_cast<float>(recvDWord(slaveAddr));
 }
 
 /**
@@ -372,23 +295,9 @@ float DI2CMaster::recvFloat(uint8_t slaveAddr)
  */
 uint8_t DI2CMaster::askForByte(uint8_t slaveAddr, uint8_t cmdReg)
 {
-    // Recv byte
-    uint8_t recvByte=0xFF;
-
-    // Compose i2c messages array
-    struct i2c_msg messages[]={
-        {slaveAddr, 0, 1,  &cmdReg},
-        {slaveAddr, I2C_M_RD | I2C_M_NOSTART, 1, &recvByte},
-    };
-    struct i2c_rdwr_ioctl_data ioctlData = {messages, 2};
-
-    // Perform I/O
-    if (!performIoctl(busHandle, I2C_RDWR, &ioctlData)) {
-        return 0xFF;
-    }
-
-    //printf("recvWord: %02X %02X\r\n",recvWord[0],recvWord[1]);
-    return recvByte;
+    uint8_t data=0xFF;
+    askFor<uint8_t>(slaveAddr,cmdReg,data);
+    return data;
 }
 
 /**
@@ -401,23 +310,9 @@ uint8_t DI2CMaster::askForByte(uint8_t slaveAddr, uint8_t cmdReg)
  */
 uint16_t DI2CMaster::askForWord(uint8_t slaveAddr, uint8_t cmdReg)
 {
-    // Create recv buffer (2 bytes)
-    uint8_t recvWord[2] = { 0xFF, 0xFF };
-
-    // Compose i2c messages array (write + read)
-    struct i2c_msg messages[] = {
-        { slaveAddr, 0,        1, &cmdReg },
-        { slaveAddr, I2C_M_RD, 2, recvWord }
-    };
-
-    struct i2c_rdwr_ioctl_data ioctlData = { messages, 2 };
-
-    // Perform I/O
-    if (!performIoctl(busHandle, I2C_RDWR, &ioctlData)) {
-        return 0xFFFF;
-    }
-
-    return WORD(recvWord[0], recvWord[1]);
+    uint16_t data=0xFFFF;
+    askFor<uint16_t>(slaveAddr,cmdReg,data);
+    return data;
 }
 
 /**
@@ -430,38 +325,21 @@ uint16_t DI2CMaster::askForWord(uint8_t slaveAddr, uint8_t cmdReg)
  */
 uint32_t DI2CMaster::askForDWord(uint8_t slaveAddr, uint8_t cmdReg)
 {
-    // Create recv buffer (4 bytes)
-    uint8_t recvDWord[4]={ 0xFF, 0xFF, 0xFF, 0xFF };
-
-    // Compose i2c messages array
-    struct i2c_msg messages[]={
-        {slaveAddr, 0, 1,  &cmdReg},
-        {slaveAddr, I2C_M_RD | I2C_M_NOSTART, 4, recvDWord},
-    };
-    struct i2c_rdwr_ioctl_data ioctlData = {messages, 2};
-
-    // Perform I/O
-    if (!performIoctl(busHandle, I2C_RDWR, &ioctlData)) {
-        return 0xFFFFFFFF;
-    }
-
-    //printf("recvWord: %02X %02X %02X %02X\r\n",recvDWord[0],recvDWord[1],recvDWord[2],recvDWord[3]);
-    return DWORD_B(recvDWord[0],recvDWord[1],recvDWord[2],recvDWord[3]);
+    uint32_t data=0xFFFFFFFF;
+    askFor<uint32_t>(slaveAddr,cmdReg,data);
+    return data;
 }
 
 float DI2CMaster::askForFloat(uint8_t slaveAddr, uint8_t cmdReg)
 {
-    uint32_t dword=askForDWord(slaveAddr,cmdReg);
-    // To float
-    float f;
-    std::memcpy(&f, &dword, sizeof(f));
-
-    return f;
+    return std::bit_cast<float>(askForDWord(slaveAddr,cmdReg));
 }
 
 int16_t DI2CMaster::askForInt16(uint8_t slaveAddr, uint8_t cmdReg)
 {
-    return static_cast<int16_t>(askForWord(slaveAddr,cmdReg));
+    int16_t data=-1;
+    askFor<int16_t>(slaveAddr,cmdReg,data);
+    return data;
 }
 
 /**
@@ -498,6 +376,39 @@ bool DI2CMaster::askForBuf(uint8_t slaveAddr, uint8_t cmdReg, uint8_t *recvBuffe
     return true;
 }
 
+/**
+ * @brief Read many BUFFERs from specified i2c registers of the slave device.
+ * ...that means "for each request send 1 command byte and read N bytes"...
+ * All requests are chained with repeated start in a single I2C_RDWR ioctl (more ioctl only if requests are more than
+ * the kernel limit of I2C_RDWR_IOCTL_MAX_MSGS messages).
+ * 
+ * @param slaveAddr     -> i2c slave device address.
+ * @param requests      -> list of (register, buffer, length) to read.
+ * @return true on success, otherwise false (you can retrieve the error by calling getLastError()).
+ */
+bool DI2CMaster::askForBufs(uint8_t slaveAddr, std::span<const DI2CReadRequest> requests)
+{
+    struct i2c_msg messages[I2C_RDWR_IOCTL_MAX_MSGS];
+    const size_t maxRequests=I2C_RDWR_IOCTL_MAX_MSGS/2;
+
+    for (size_t ixStart=0; ixStart<requests.size(); ixStart+=maxRequests) {
+        size_t reqCount=std::min(maxRequests,requests.size()-ixStart);
+        for (size_t ixR=0; ixR<reqCount; ixR++) {
+            const DI2CReadRequest& req=requests[ixStart+ixR];
+            messages[ixR*2]={slaveAddr, 0, 1, const_cast<uint8_t *>(&req.cmdReg)};
+            messages[ixR*2+1]={slaveAddr, I2C_M_RD, req.recvLen, req.recvBuf};
+        }
+        struct i2c_rdwr_ioctl_data ioctlData={messages, static_cast<uint32_t>(reqCount*2)};
+
+        // Perform I/O
+        if (!performIoctl(busHandle, I2C_RDWR, &ioctlData)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 /**
  * @brief Read a STRING from specified i2c register of the slave device (aka read register).
  * ...that means "send 1 command byte and read N bytes"...
@@ -540,16 +451,7 @@ std::string DI2CMaster::askForString(uint8_t slaveAddr, uint8_t cmdReg)
  */
 bool DI2CMaster::sendByte(uint8_t slaveAddr, uint8_t data)
 {
-    // Create i2c message
-    i2c_msg message={slaveAddr, 0, 1, &data};
-    struct i2c_rdwr_ioctl_data ioctlData={&message, 1};
-
-    // Perform I/O
-    if (!performIoctl(busHandle, I2C_RDWR, &ioctlData)) {
-        return false;
-    }
-
-    return true;
+    return send<uint8_t>(slaveAddr,data);
 }
 
 /**
@@ -561,19 +463,7 @@ bool DI2CMaster::sendByte(uint8_t slaveAddr, uint8_t data)
  */
 bool DI2CMaster::sendWord(uint8_t slaveAddr, uint16_t data)
 {
-    // Create send buffer
-    uint8_t sendWord[2]={HIBYTE(data), LOBYTE(data)};
-
-    // Create i2c message
-    i2c_msg message={slaveAddr, 0, 2, sendWord};
-    struct i2c_rdwr_ioctl_data ioctlData={&message, 1};
-
-    // Perform I/O
-    if (!performIoctl(busHandle, I2C_RDWR, &ioctlData)) {
-        return false;
-    }
-
-    return true;
+    return send<uint16_t>(slaveAddr,data);
 }
 
 /**
@@ -586,44 +476,121 @@ bool DI2CMaster::sendWord(uint8_t slaveAddr, uint16_t data)
  */
 bool DI2CMaster::sendBuf(uint8_t slaveAddr, uint8_t *data, uint16_t dataLen)
 {
-    //printf("datalen=%d\r\n",dataLen);
-    //for (int i=0; i<dataLen; i++) printf("%c",data[i]);printf("\r\n");
+    return bulkTransfer(slaveAddr,false,0,BULK_REG_FIXED,data,dataLen,false);
+}
+
+/**
+ * @brief Write a BUFFER of any length starting from specified i2c register of the slave device.
+ * If i2cMaxBufferLength is set, data is split in chunks of i2cMaxBufferLength bytes, each one preceded by its
+ * register: cmdReg + offset of chunk (BULK_REG_ADVANCE) or always cmdReg (BULK_REG_FIXED).
+ * Chunks are packed in as few ioctl as possible (up to I2C_RDWR_IOCTL_MAX_MSGS chunks each).
+ * 
+ * @param slaveAddr -> i2c slave device address.
+ * @param cmdReg    -> i2c device command (aka register) of first chunk (8 bit, it wraps around).
+ * @param data      -> the buffer to send.
+ * @param dataLen   -> the length of the buffer.
+ * @param mode      -> register of next chunks.
+ * @return true on success, otherwise false (you can retrieve the error by calling getLastError()).
+ */
+bool DI2CMaster::writeBulk(uint8_t slaveAddr, uint8_t cmdReg, const uint8_t *data, size_t dataLen, DBulkMode mode)
+{
+    return bulkTransfer(slaveAddr,true,cmdReg,mode,const_cast<uint8_t *>(data),dataLen,false);
+}
 
-    // Default: only one transaction
-    uint16_t msgCount=1;
-    uint16_t msgLen=dataLen;
-    uint16_t lastMsgLen;
+/**
+ * @brief Read a BUFFER of any length from an i2c slave device (no command).
+ * If i2cMaxBufferLength is set, data is read in chunks of i2cMaxBufferLength bytes packed in as few ioctl as possible.
+ * 
+ * @param slaveAddr     -> i2c slave device address.
+ * @param recvBuffer    -> pointer to a buffer for received data.
+ * @param recvLen       -> length of data to read.
+ * @return true on success, otherwise false (you can retrieve the error by calling getLastError()).
+ */
+bool DI2CMaster::recvBulk(uint8_t slaveAddr, uint8_t *recvBuffer, size_t recvLen)
+{
+    return bulkTransfer(slaveAddr,false,0,BULK_REG_FIXED,recvBuffer,recvLen,true);
+}
 
-    if (maxBufLength > 0) {
-        // 1 transaction each maxBufLength bytes
-        msgCount=dataLen/maxBufLength;
-        msgLen=maxBufLength;
-        lastMsgLen=dataLen%maxBufLength;
-        if (lastMsgLen > 0) {
-            msgCount++;
-        }
+/**
+ * @brief Read a BUFFER of any length starting from specified i2c register of the slave device.
+ * Unlike askForBuf(), the read is not truncated to i2cMaxBufferLength: it is split in chunks, each one preceded by its
+ * register: cmdReg + offset of chunk (BULK_REG_ADVANCE) or always cmdReg (BULK_REG_FIXED).
+ * Chunks are chained with repeated start in as few ioctl as possible (up to I2C_RDWR_IOCTL_MAX_MSGS/2 chunks each).
+ * 
+ * @param slaveAddr     -> i2c slave device address.
+ * @param cmdReg        -> i2c device command (aka register) of first chunk (8 bit, it wraps around).
+ * @param recvBuffer    -> pointer to a buffer for received data.
+ * @param recvLen       -> length of data to read.
+ * @param mode          -> register of next chunks.
+ * @return true on success, otherwise false (you can retrieve the error by calling getLastError()).
+ */
+bool DI2CMaster::askForBulk(uint8_t slaveAddr, uint8_t cmdReg, uint8_t *recvBuffer, size_t recvLen, DBulkMode mode)
+{
+    return bulkTransfer(slaveAddr,true,cmdReg,mode,recvBuffer,recvLen,true);
+}
+
+/**
+ * @brief Core of bulk methods: split data in chunks of maxBufLength bytes and pack them in as few ioctl as possible.
+ * 
+ * @param slaveAddr -> i2c slave device address.
+ * @param useReg    -> true if each chunk is preceded by its register.
+ * @param cmdReg    -> register of first chunk.
+ * @param mode      -> register of next chunks.
+ * @param data      -> data to send or buffer for received data.
+ * @param dataLen   -> length of data.
+ * @param isRead    -> true to read, false to write.
+ * @return true on success, otherwise false (you can retrieve the error by calling getLastError()).
+ */
+bool DI2CMaster::bulkTransfer(uint8_t slaveAddr, bool useReg, uint8_t cmdReg, DBulkMode mode, uint8_t *data, size_t dataLen, bool isRead)
+{
+    if (dataLen == 0) {
+        return true;
     }
 
-    // Create i2c message/s
-    i2c_msg messages[msgCount];
-    uint8_t *txData=data;
-    uint16_t flags=0;
-    for (size_t ixMsg=0; ixMsg<msgCount; ixMsg++) {
-        if (ixMsg == msgCount-1) {
-            msgLen=lastMsgLen;
-        }
-        if (ixMsg == 1) {
-            flags=I2C_M_NOSTART;
+    // Kernel refuses messages longer than 8192 bytes (register byte included)
+    size_t chunkLen=maxBufLength > 0 ? maxBufLength : dataLen;
+    chunkLen=std::min<size_t>(chunkLen,DI2C_MAX_MSG_LEN-1);
+    size_t chunkCount=(dataLen+chunkLen-1)/chunkLen;
+    size_t msgsPerChunk=(useReg && isRead) ? 2 : 1;
+    size_t chunksPerIoctl=I2C_RDWR_IOCTL_MAX_MSGS/msgsPerChunk;
+
+    struct i2c_msg messages[I2C_RDWR_IOCTL_MAX_MSGS];
+    uint8_t regs[I2C_RDWR_IOCTL_MAX_MSGS];
+    if (useReg && !isRead) {
+        size_t bulkLen=std::min(chunkCount,chunksPerIoctl)*(chunkLen+1);
+        if (bulkBuf.size() < bulkLen) {
+            bulkBuf.resize(bulkLen);
         }
-        //printf("flags=%d\r\n",flags);
-        messages[ixMsg]={slaveAddr, 0, msgLen, txData};
-        txData+=msgLen;
     }
-    struct i2c_rdwr_ioctl_data ioctlData={messages, msgCount};
 
-    // Perform I/O
-    if (!performIoctl(busHandle, I2C_RDWR, &ioctlData)) {
-        return false;
+    for (size_t ixFirst=0; ixFirst<chunkCount; ixFirst+=chunksPerIoctl) {
+        size_t count=std::min(chunksPerIoctl,chunkCount-ixFirst);
+        uint32_t msgCount=0;
+        for (size_t ixC=0; ixC<count; ixC++) {
+            size_t offset=(ixFirst+ixC)*chunkLen;
+            uint16_t len=std::min(chunkLen,dataLen-offset);
+            uint8_t reg=cmdReg+(mode == BULK_REG_ADVANCE ? offset : 0);
+            if (!useReg) {
+                messages[msgCount++]={slaveAddr, static_cast<uint16_t>(isRead ? I2C_M_RD : 0), len, data+offset};
+            }
+            else if (isRead) {
+                regs[ixC]=reg;
+                messages[msgCount++]={slaveAddr, 0, 1, &regs[ixC]};
+                messages[msgCount++]={slaveAddr, I2C_M_RD, len, data+offset};
+            }
+            else {
+                uint8_t *txBuf=&bulkBuf[ixC*(chunkLen+1)];
+                txBuf[0]=reg;
+                memcpy(&txBuf[1],data+offset,len);
+                messages[msgCount++]={slaveAddr, 0, static_cast<uint16_t>(len+1), txBuf};
+            }
+        }
+        struct i2c_rdwr_ioctl_data ioctlData={messages, msgCount};
+
+        // Perform I/O
+        if (!performIoctl(busHandle, I2C_RDWR, &ioctlData)) {
+            return false;
+        }
     }
 
     return true;
@@ -646,11 +613,114 @@ bool DI2CMaster::checkIoctl(int ret, int expectedMsgs, std::string source)
 }
 */
 
+/**
+ * @brief Perform a write and/or read transaction (with repeated start between them).
+ * Core of all typed methods.
+ * 
+ * @param slaveAddr -> i2c slave device address.
+ * @param txBuf     -> data to write (can be nullptr if txLen is 0).
+ * @param txLen     -> length of data to write (0 = read only).
+ * @param rxBuf     -> buffer for received data (can be nullptr if rxLen is 0).
+ * @param rxLen     -> length of data to read (0 = write only).
+ * @return true on success, otherwise false (you can retrieve the error by calling getLastError()).
+ */
+bool DI2CMaster::transfer(uint8_t slaveAddr, const uint8_t *txBuf, uint16_t txLen, uint8_t *rxBuf, uint16_t rxLen)
+{
+    struct i2c_msg messages[2];
+    uint32_t msgCount=0;
+    if (txLen > 0) {
+        messages[msgCount++]={slaveAddr, 0, txLen, const_cast<uint8_t *>(txBuf)};
+    }
+    if (rxLen > 0) {
+        messages[msgCount++]={slaveAddr, I2C_M_RD, rxLen, rxBuf};
+    }
+    struct i2c_rdwr_ioctl_data ioctlData={messages, msgCount};
+
+    // Perform I/O
+    return performIoctl(busHandle, I2C_RDWR, &ioctlData);
+}
+
+/**
+ * @brief Perform several transfers, also to different slave devices, in as few ioctl as possible.
+ * Transfers are packed in I2C_RDWR_IOCTL_MAX_MSGS messages ioctl (a transfer is never split), so devices on the same bus
+ * are reached back to back, without the syscall and scheduling gaps of a transaction each
+ * (i.e. triggering conversions of several sensors at the same time).
+ * 
+ * @param transfers -> transfers to perform, in order (txLen and rxLen can't be both 0).
+ * @return true on success, otherwise false (you can retrieve the error by calling getLastError()).
+ */
+bool DI2CMaster::transferBatch(std::span<const DI2CTransfer> transfers)
+{
+    struct i2c_msg messages[I2C_RDWR_IOCTL_MAX_MSGS];
+    uint32_t msgCount=0;
+
+    for (size_t ixT=0; ixT<transfers.size(); ixT++) {
+        const DI2CTransfer& xfer=transfers[ixT];
+        uint32_t xferMsgs=(xfer.txLen > 0) + (xfer.rxLen > 0);
+        if (msgCount + xferMsgs > I2C_RDWR_IOCTL_MAX_MSGS) {
+            struct i2c_rdwr_ioctl_data ioctlData={messages, msgCount};
+            if (!performIoctl(busHandle, I2C_RDWR, &ioctlData)) {
+                return false;
+            }
+            msgCount=0;
+        }
+        if (xfer.txLen > 0) {
+            messages[msgCount++]={xfer.slaveAddr, 0, xfer.txLen, const_cast<uint8_t *>(xfer.txBuf)};
+        }
+        if (xfer.rxLen > 0) {
+            messages[msgCount++]={xfer.slaveAddr, I2C_M_RD, xfer.rxLen, xfer.rxBuf};
+        }
+    }
+
+    if (msgCount == 0) {
+        return true;
+    }
+    struct i2c_rdwr_ioctl_data ioctlData={messages, msgCount};
+    return performIoctl(busHandle, I2C_RDWR, &ioctlData);
+}
+
+/**
+ * @brief Perform the ioctl and record it in bus statistics.
+ * Each address of the ioctl records a transaction with the bytes of its own messages. When the ioctl reaches several
+ * addresses (transferBatch()) each one is marked as shared and gets the latency and the error of the whole ioctl:
+ * the adapter does not tell which message failed.
+ */
 bool DI2CMaster::performIoctl(int fd, unsigned long int request, struct i2c_rdwr_ioctl_data* data)
 {
+    auto start = std::chrono::steady_clock::now();
     int ret = ioctl(fd, request, data);
-    if (ret != data->nmsgs) {
-        lastErrorString = strerror(errno);
+    int err = ret == (int) data->nmsgs ? 0 : (ret < 0 ? errno : EIO);
+    uint64_t latencyUs = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+    if (busStats != nullptr && data->nmsgs > 0) {
+        // Bytes of each address, in order of first message
+        uint16_t addrs[I2C_RDWR_IOCTL_MAX_MSGS];
+        uint32_t txBytes[I2C_RDWR_IOCTL_MAX_MSGS] = {};
+        uint32_t rxBytes[I2C_RDWR_IOCTL_MAX_MSGS] = {};
+        uint32_t addrCount = 0;
+        for (uint32_t ixMsg=0; ixMsg<data->nmsgs && ixMsg<I2C_RDWR_IOCTL_MAX_MSGS; ixMsg++) {
+            const struct i2c_msg& msg = data->msgs[ixMsg];
+            uint32_t ixA = 0;
+            while (ixA < addrCount && addrs[ixA] != msg.addr) {
+                ixA++;
+            }
+            if (ixA == addrCount) {
+                addrs[addrCount++] = msg.addr;
+            }
+            if (msg.flags & I2C_M_RD) {
+                rxBytes[ixA] += msg.len;
+            }
+            else {
+                txBytes[ixA] += msg.len;
+            }
+        }
+        for (uint32_t ixA=0; ixA<addrCount; ixA++) {
+            busStats->record(addrs[ixA], txBytes[ixA], rxBytes[ixA], latencyUs, err, addrCount > 1);
+        }
+    }
+
+    if (err != 0) {
+        lastErrorString = strerror(err);
         return false;
     }
     return true;
@@ -2,16 +2,44 @@
 #define DI2CMaster_H
 
 #include <cstdint>
+#include <span>
 #include <string>
+#include <vector>
 #include <di2c>
+#include "di2ccodec.h"
+#include "di2cstats.h"
+
+//! A register read request for DI2CMaster::askForBufs().
+struct DI2CReadRequest {
+    uint8_t cmdReg;
+    uint8_t *recvBuf;
+    uint16_t recvLen;
+};
+
+//! A transfer (write, read or write + repeated start read) for DI2CMaster::transferBatch().
+struct DI2CTransfer {
+    uint8_t slaveAddr;
+    const uint8_t *txBuf;
+    uint16_t txLen;
+    uint8_t *rxBuf;
+    uint16_t rxLen;
+};
 
 class DI2CMaster {
     public:
+        //! Register handling of bulk transfers split in chunks.
+        enum DBulkMode {
+            BULK_REG_ADVANCE,   // each chunk starts at cmdReg + offset (memory like devices)
+            BULK_REG_FIXED      // each chunk uses cmdReg (fifo like devices)
+        };
+
         DI2CMaster(DI2CBusHandle i2cBusHandle, uint16_t i2cMaxBufferLength = 0);
         ~DI2CMaster();
 
         bool isReady(void);
         std::string getLastError(void);
+        DI2CBusStats* getBusStats(void);
+        DI2CBusHandle getBusHandle(void);
 
         // Write commands (aka registers) methods
         bool writeByte(uint8_t slaveAddr, uint8_t cmdReg, uint8_t data);
@@ -19,6 +47,7 @@ class DI2CMaster {
         bool writeDWord(uint8_t slaveAddr, uint8_t cmdReg, uint32_t data);
         bool writeFloat(uint8_t slaveAddr, uint8_t cmdReg, float data);
         bool writeBuf(uint8_t slaveAddr, uint8_t cmdReg, uint8_t *writeBuffer, uint16_t writeLen);
+        bool writeBulk(uint8_t slaveAddr, uint8_t cmdReg, const uint8_t *data, size_t dataLen, DBulkMode mode = BULK_REG_ADVANCE);
         
         // Read commands (aka registers) methods
         uint8_t recvByte(uint8_t slaveAddr);
@@ -26,6 +55,7 @@ class DI2CMaster {
         uint32_t recvDWord(uint8_t slaveAddr);
         float recvFloat(uint8_t slaveAddr);
         bool recvBuf(uint8_t slaveAddr, uint8_t *recvBuf, uint16_t recvLen);
+        bool recvBulk(uint8_t slaveAddr, uint8_t *recvBuf, size_t recvLen);
 
         // Ask (write + read) commands (aka registers) methods
         uint8_t askForByte(uint8_t slaveAddr, uint8_t cmdReg);
@@ -34,19 +64,96 @@ class DI2CMaster {
         float askForFloat(uint8_t slaveAddr, uint8_t cmdReg);
         int16_t askForInt16(uint8_t slaveAddr, uint8_t cmdReg);
         bool askForBuf(uint8_t slaveAddr, uint8_t cmdReg, uint8_t *recvBuf, uint16_t recvLen);
+        bool askForBufs(uint8_t slaveAddr, std::span<const DI2CReadRequest> requests);
+        bool askForBulk(uint8_t slaveAddr, uint8_t cmdReg, uint8_t *recvBuf, size_t recvLen, DBulkMode mode = BULK_REG_ADVANCE);
         std::string askForString(uint8_t slaveAddr, uint8_t cmdReg);
 
         // Raw send methods
         bool sendByte(uint8_t slaveAddr, uint8_t data);
         bool sendWord(uint8_t slaveAddr, uint16_t data);
         bool sendBuf(uint8_t slaveAddr, uint8_t *data, uint16_t dataLen);
-        
+
+        // Multi device methods
+        bool transferBatch(std::span<const DI2CTransfer> transfers);
+
+        // Typed methods (T = value type, E = register byte order, N = register width in bytes, see DI2CCodec)
+        /**
+         * @brief Write a typed value at specified i2c register of the slave device.
+         * Value is encoded directly into the i2c message buffer.
+         * 
+         * @param slaveAddr -> i2c slave device address.
+         * @param cmdReg    -> i2c device command (aka register).
+         * @param data      -> the value to send.
+         * @return true on success, otherwise false (you can retrieve the error by calling getLastError()).
+         */
+        template<typename T, std::endian E = std::endian::big, size_t N = sizeof(T)>
+        bool write(uint8_t slaveAddr, uint8_t cmdReg, T data) {
+            uint8_t txBuf[N+1];
+            txBuf[0]=cmdReg;
+            DI2CCodec::encode<T,E,N>(data,std::span<uint8_t,N>(&txBuf[1],N));
+            return transfer(slaveAddr,txBuf,N+1,nullptr,0);
+        }
+
+        /**
+         * @brief Read a typed value from specified i2c register of the slave device.
+         * Value is decoded directly from the i2c message buffer.
+         * 
+         * @param slaveAddr -> i2c slave device address.
+         * @param cmdReg    -> i2c device command (aka register).
+         * @param data      -> destination of read value (untouched on failure).
+         * @return true on success, otherwise false (you can retrieve the error by calling getLastError()).
+         */
+        template<typename T, std::endian E = std::endian::big, size_t N = sizeof(T)>
+        bool askFor(uint8_t slaveAddr, uint8_t cmdReg, T& data) {
+            uint8_t rxBuf[N];
+            if (!transfer(slaveAddr,&cmdReg,1,rxBuf,N)) {
+                return false;
+            }
+            data=DI2CCodec::decode<T,E,N>(std::span<const uint8_t,N>(rxBuf));
+            return true;
+        }
+
+        /**
+         * @brief Read a typed value from an i2c slave device (no command).
+         * 
+         * @param slaveAddr -> i2c slave device address.
+         * @param data      -> destination of read value (untouched on failure).
+         * @return true on success, otherwise false (you can retrieve the error by calling getLastError()).
+         */
+        template<typename T, std::endian E = std::endian::big, size_t N = sizeof(T)>
+        bool recv(uint8_t slaveAddr, T& data) {
+            uint8_t rxBuf[N];
+            if (!transfer(slaveAddr,nullptr,0,rxBuf,N)) {
+                return false;
+            }
+            data=DI2CCodec::decode<T,E,N>(std::span<const uint8_t,N>(rxBuf));
+            return true;
+        }
+
+        /**
+         * @brief Send a typed value to a slave device (no command).
+         * 
+         * @param slaveAddr -> i2c slave device address.
+         * @param data      -> the value to send.
+         * @return true on success, otherwise false (you can retrieve the error by calling getLastError()).
+         */
+        template<typename T, std::endian E = std::endian::big, size_t N = sizeof(T)>
+        bool send(uint8_t slaveAddr, T data) {
+            uint8_t txBuf[N];
+            DI2CCodec::encode<T,E,N>(data,std::span<uint8_t,N>(txBuf));
+            return transfer(slaveAddr,txBuf,N,nullptr,0);
+        }
+
     private:
         //bool checkIoctl(int ret, int expectedMsgs, std::string source);
         bool performIoctl(int fd, unsigned long int request, struct i2c_rdwr_ioctl_data* data);
+        bool transfer(uint8_t slaveAddr, const uint8_t *txBuf, uint16_t txLen, uint8_t *rxBuf, uint16_t rxLen);
+        bool bulkTransfer(uint8_t slaveAddr, bool useReg, uint8_t cmdReg, DBulkMode mode, uint8_t *data, size_t dataLen, bool isRead);
 
         DI2CBusHandle busHandle;
         size_t maxBufLength;
+        DI2CBusStats *busStats;
+        std::vector<uint8_t> bulkBuf;   // register + data of bulk write chunks (reused)
 
     protected:
         std::string lastErrorString;
@@ -0,0 +1,313 @@
+/**
+ * @file di2cpoller.cpp
+ * @brief Poll sensors on many i2c buses concurrently.
+ * 
+ * Each i2c bus is an independent hardware, so reading sensors on different buses one after an other from a single
+ * thread wastes time: the total cycle is the sum of all buses time.
+ * DI2CPoller runs one worker thread for each bus, so the cycle time is the one of the slowest bus.
+ * 
+ * Each task (a read function and its period) writes the read value to a latest-value table that can be read from
+ * any thread without locks (each slot is a seqlock with one writer, the bus worker).
+ * 
+ * How to use:
+ *
+ * @code
+ * DI2CBus bus1(1), bus3(3);
+ * INA226 ina1(0x40,0.002,bus1.handle()), ina3(0x41,0.002,bus3.handle());
+ * DI2CPoller poller;
+ * int current1=poller.addTask(bus1.handle(), [&](double& v) { v=ina1.getCurrent(); return true; }, 10000);
+ * int current3=poller.addTask(bus3.handle(), [&](double& v) { v=ina3.getCurrent(); return true; }, 10000);
+ * poller.start();
+ * ...
+ * double i1=poller.getValue(current1);
+ * @endcode
+ * 
+ * N.B.
+ * All tasks on the same bus MUST be added using the same bus handle.
+ * 
+ * @version 0.1
+ * @date 2025-02-10
+ * 
+ * @copyright Copyright (c) 2025
+ */
+
+#include "di2cpoller.h"
+#include <algorithm>
+#include <bit>
+#include <chrono>
+
+#define ERR_TXT_SUCCESS "Success"
+#define ERR_POLLER_RUNNING "Poller is running"
+#define ERR_NO_TASKS "No tasks to run"
+
+DI2CPoller::DI2CPoller()
+{
+    slotsCount=0;
+    running=false;
+    lastErrorString=ERR_TXT_SUCCESS;
+}
+
+DI2CPoller::~DI2CPoller()
+{
+    stop();
+}
+
+/**
+ * @brief Add a read task.
+ * Can be called only before start().
+ * 
+ * @param busHandle ->  handle of the bus where the sensor is (tasks with same handle run on same worker).
+ * @param readFunc  ->  function that reads the sensor.
+ * @param periodUs  ->  read period in microseconds (0 = at each cycle, as fast as possible).
+ * @return the task id used to read its value, or -1 on error (you can retrieve the error by calling getLastError()).
+ */
+int DI2CPoller::addTask(DI2CBusHandle busHandle, DReadFunc readFunc, uint32_t periodUs)
+{
+    if (running) {
+        lastErrorString=ERR_POLLER_RUNNING;
+        return -1;
+    }
+    tasks.push_back({ busHandle, tasks.size(), readFunc, periodUs, 0 });
+    return tasks.size()-1;
+}
+
+/**
+ * @brief Allocate the latest-value table and starts one worker for each bus.
+ * 
+ * @return true on success, otherwise false (you can retrieve the error by calling getLastError()).
+ */
+bool DI2CPoller::start(void)
+{
+    if (running) {
+        lastErrorString=ERR_POLLER_RUNNING;
+        return false;
+    }
+    if (tasks.empty()) {
+        lastErrorString=ERR_NO_TASKS;
+        return false;
+    }
+
+    // Preallocated table: it never changes while running
+    slotsCount=tasks.size();
+    slots=std::make_unique<DSlot[]>(slotsCount);
+
+    // Group tasks by bus
+    workers.clear();
+    for (const DTask& task : tasks) {
+        DBusWorker *worker=nullptr;
+        for (auto& w : workers) {
+            if (w->busHandle == task.busHandle) {
+                worker=w.get();
+                break;
+            }
+        }
+        if (worker == nullptr) {
+            workers.push_back(std::make_unique<DBusWorker>());
+            worker=workers.back().get();
+            worker->busHandle=task.busHandle;
+        }
+        worker->tasks.push_back(task);
+    }
+
+    running=true;
+    for (auto& worker : workers) {
+        DBusWorker& w=*worker;
+        w.thread=std::thread([this,&w]() { workerLoop(w); });
+    }
+
+    lastErrorString=ERR_TXT_SUCCESS;
+    return true;
+}
+
+/**
+ * @brief Stop all workers and wait for them.
+ */
+void DI2CPoller::stop(void)
+{
+    {
+        std::lock_guard<std::mutex> lock(waitMutex);
+        if (!running) {
+            return;
+        }
+        running=false;
+    }
+    waitCond.notify_all();
+    for (auto& worker : workers) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+    }
+}
+
+//! @return true if workers are running.
+bool DI2CPoller::isRunning(void)
+{
+    return running;
+}
+
+//! @return number of tasks added.
+size_t DI2CPoller::tasksCount(void)
+{
+    return tasks.size();
+}
+
+//! @return number of buses (aka workers), valid after start().
+size_t DI2CPoller::busesCount(void)
+{
+    return workers.size();
+}
+
+/**
+ * @brief Read the latest value of a task (lock-free, can be called from any thread).
+ * 
+ * @param taskID    ->  the id returned by addTask().
+ * @param sample    ->  destination of value, timestamp and counters.
+ * @return false if taskID is not valid or poller has never started.
+ */
+bool DI2CPoller::getSample(size_t taskID, DSample& sample)
+{
+    if (taskID >= slotsCount) {
+        return false;
+    }
+    DSlot& slot=slots[taskID];
+    uint32_t seqBegin;
+    uint32_t seqEnd;
+    uint64_t valueBits;
+    do {
+        seqBegin=slot.seq.load(std::memory_order_acquire);
+        valueBits=slot.valueBits.load(std::memory_order_relaxed);
+        sample.timestampUs=slot.timestampUs.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        seqEnd=slot.seq.load(std::memory_order_relaxed);
+    } while ((seqBegin & 1) || seqBegin != seqEnd);
+    sample.value=std::bit_cast<double>(valueBits);
+    sample.readCount=slot.readCount.load(std::memory_order_relaxed);
+    sample.errorCount=slot.errorCount.load(std::memory_order_relaxed);
+    return true;
+}
+
+/**
+ * @brief Read the latest value of a task (lock-free, can be called from any thread).
+ * 
+ * @param taskID    ->  the id returned by addTask().
+ * @return latest value (0 if never read).
+ */
+double DI2CPoller::getValue(size_t taskID)
+{
+    DSample sample={};
+    getSample(taskID,sample);
+    return sample.value;
+}
+
+/**
+ * @brief Get timing of a bus worker.
+ * 
+ * @param busIndex  ->  0..busesCount()-1.
+ * @param timing    ->  destination.
+ * @return false if busIndex is not valid.
+ */
+bool DI2CPoller::getBusTiming(size_t busIndex, DBusTiming& timing)
+{
+    if (busIndex >= workers.size()) {
+        return false;
+    }
+    DBusWorker& worker=*workers[busIndex];
+    timing.busHandle=worker.busHandle;
+    timing.lastCycleUs=worker.lastCycleUs.load(std::memory_order_relaxed);
+    timing.maxCycleUs=worker.maxCycleUs.load(std::memory_order_relaxed);
+    timing.cycles=worker.cycles.load(std::memory_order_relaxed);
+    return true;
+}
+
+/**
+ * @return the last cycle time of the slowest bus in microseconds (that is the cycle time of all buses).
+ */
+uint64_t DI2CPoller::getCycleTime(void)
+{
+    uint64_t cycleUs=0;
+    for (auto& worker : workers) {
+        cycleUs=std::max(cycleUs,worker->lastCycleUs.load(std::memory_order_relaxed));
+    }
+    return cycleUs;
+}
+
+/**
+ * @return last error.
+ */
+std::string DI2CPoller::getLastError(void)
+{
+    return lastErrorString;
+}
+
+/**
+ * @brief Bus worker: runs due tasks, publish results, sleep until next due task.
+ */
+void DI2CPoller::workerLoop(DBusWorker& worker)
+{
+    uint64_t startUs=nowUs();
+    for (DTask& task : worker.tasks) {
+        task.nextDueUs=startUs;
+    }
+
+    while (running) {
+        uint64_t cycleStartUs=nowUs();
+        uint64_t nextWakeUs=UINT64_MAX;
+        bool anyRun=false;
+
+        for (DTask& task : worker.tasks) {
+            if (task.nextDueUs <= cycleStartUs) {
+                double value=0;
+                DSlot& slot=slots[task.slotID];
+                if (task.readFunc(value)) {
+                    publish(slot,value,nowUs());
+                }
+                else {
+                    slot.errorCount.fetch_add(1,std::memory_order_relaxed);
+                }
+                anyRun=true;
+                // Next due time (if late more than a period, restart from now)
+                task.nextDueUs+=task.periodUs;
+                if (task.nextDueUs < cycleStartUs) {
+                    task.nextDueUs=cycleStartUs+task.periodUs;
+                }
+            }
+            nextWakeUs=std::min(nextWakeUs,task.nextDueUs);
+        }
+
+        if (anyRun) {
+            uint64_t cycleUs=nowUs()-cycleStartUs;
+            worker.lastCycleUs.store(cycleUs,std::memory_order_relaxed);
+            if (cycleUs > worker.maxCycleUs.load(std::memory_order_relaxed)) {
+                worker.maxCycleUs.store(cycleUs,std::memory_order_relaxed);
+            }
+            worker.cycles.fetch_add(1,std::memory_order_relaxed);
+        }
+
+        // Wait for next due task (or stop)
+        uint64_t now=nowUs();
+        if (nextWakeUs > now) {
+            std::unique_lock<std::mutex> lock(waitMutex);
+            waitCond.wait_for(lock,std::chrono::microseconds(nextWakeUs-now),[this]() { return !running; });
+        }
+    }
+}
+
+/**
+ * @brief Write a value in the latest-value table (seqlock writer side).
+ */
+void DI2CPoller::publish(DSlot& slot, double value, uint64_t timestampUs)
+{
+    uint32_t seq=slot.seq.load(std::memory_order_relaxed);
+    slot.seq.store(seq+1,std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.valueBits.store(std::bit_cast<uint64_t>(value),std::memory_order_relaxed);
+    slot.timestampUs.store(timestampUs,std::memory_order_relaxed);
+    slot.seq.store(seq+2,std::memory_order_release);
+    slot.readCount.fetch_add(1,std::memory_order_relaxed);
+}
+
+//! @return monotonic time in microseconds.
+uint64_t DI2CPoller::nowUs(void)
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
@@ -0,0 +1,94 @@
+#ifndef DI2CPoller_H
+#define DI2CPoller_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <di2c>
+
+class DI2CPoller {
+    public:
+        //! Read function of a task: returns true on success and put the read value in value.
+        typedef std::function<bool(double& value)> DReadFunc;
+
+        //! Latest published value of a task.
+        struct DSample {
+            double value;
+            uint64_t timestampUs;   // steady clock timestamp of the read (0 = never read)
+            uint32_t readCount;     // successful reads
+            uint32_t errorCount;    // failed reads
+        };
+
+        //! Timing of a bus worker.
+        struct DBusTiming {
+            DI2CBusHandle busHandle;
+            uint64_t lastCycleUs;
+            uint64_t maxCycleUs;
+            uint32_t cycles;
+        };
+
+        DI2CPoller();
+        ~DI2CPoller();
+
+        int addTask(DI2CBusHandle busHandle, DReadFunc readFunc, uint32_t periodUs = 0);
+        bool start(void);
+        void stop(void);
+        bool isRunning(void);
+
+        size_t tasksCount(void);
+        size_t busesCount(void);
+        bool getSample(size_t taskID, DSample& sample);
+        double getValue(size_t taskID);
+        bool getBusTiming(size_t busIndex, DBusTiming& timing);
+        uint64_t getCycleTime(void);
+        std::string getLastError(void);
+
+    private:
+        // Seqlock protected slot of the latest value table (one writer: the bus worker)
+        struct DSlot {
+            std::atomic<uint32_t> seq{0};
+            std::atomic<uint64_t> valueBits{0};
+            std::atomic<uint64_t> timestampUs{0};
+            std::atomic<uint32_t> readCount{0};
+            std::atomic<uint32_t> errorCount{0};
+        };
+
+        struct DTask {
+            DI2CBusHandle busHandle;
+            size_t slotID;
+            DReadFunc readFunc;
+            uint32_t periodUs;
+            uint64_t nextDueUs;
+        };
+
+        struct DBusWorker {
+            DI2CBusHandle busHandle;
+            std::vector<DTask> tasks;
+            std::thread thread;
+            std::atomic<uint64_t> lastCycleUs{0};
+            std::atomic<uint64_t> maxCycleUs{0};
+            std::atomic<uint32_t> cycles{0};
+        };
+
+        void workerLoop(DBusWorker& worker);
+        void publish(DSlot& slot, double value, uint64_t timestampUs);
+        static uint64_t nowUs(void);
+
+        std::vector<std::unique_ptr<DBusWorker>> workers;
+        std::unique_ptr<DSlot[]> slots;
+        size_t slotsCount;
+        std::vector<DTask> tasks;
+
+        std::atomic<bool> running;
+        std::mutex waitMutex;
+        std::condition_variable waitCond;
+        std::string lastErrorString;
+};
+
+#endif
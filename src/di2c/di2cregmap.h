@@ -0,0 +1,390 @@
+#ifndef DI2CRegMap_H
+#define DI2CRegMap_H
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include "di2ccodec.h"
+#include "di2cmaster.h"
+
+/**
+ * @brief Declarative compile-time register map for i2c device drivers.
+ *
+ * A driver describes its registers once (address, width, byte order, access mode, named bitfields) and gets:
+ * - type-safe field get/set (a field can only be used on the register that declares it).
+ * - compile time validation (fields inside register width, no overlapping fields, unique addresses).
+ * - a transaction planner that reads any set of registers/fields with the fewest bursts, executed in as few ioctl
+ *   as possible.
+ *
+ * @code
+ * struct Regs {
+ *     struct Mode : DI2CField<0,3> {};
+ *     struct Avg  : DI2CField<9,3> {};
+ *     struct Rst  : DI2CField<15,1,bool> {};
+ *     using Config  = DI2CRegister<0x00, 2, ACCESS_READ_WRITE, std::endian::big, Mode, Avg, Rst>;
+ *     using Current = DI2CRegister<0x04, 2, ACCESS_READ_ONLY>;
+ * };
+ * using Map = DI2CRegMap<false, Regs::Config, Regs::Current>;
+ *
+ * DI2CRegValue<Regs::Config> cfg;
+ * Map::read(master, 0x40, cfg);
+ * cfg.set<Regs::Avg>(3).set<Regs::Rst>(false);
+ * Map::write(master, 0x40, cfg);
+ *
+ * Map::Reader<Regs::Mode, Regs::Current> reader;     // 2 bursts, 1 ioctl
+ * reader.read(master, 0x40);
+ * uint16_t current=reader.get<Regs::Current>();
+ * @endcode
+ */
+
+//! Register access mode
+enum DI2CAccess { ACCESS_READ_ONLY, ACCESS_WRITE_ONLY, ACCESS_READ_WRITE };
+
+//! Smallest unsigned integer that can hold Bytes bytes.
+template<size_t Bytes>
+using DI2CUInt = std::conditional_t<Bytes == 1, uint8_t,
+                 std::conditional_t<Bytes == 2, uint16_t,
+                 std::conditional_t<(Bytes <= 4), uint32_t, uint64_t>>>;
+
+/**
+ * @brief A named bitfield of a register.
+ * Declare it as a distinct type (i.e. struct Mode : DI2CField<0,3> {}) so it cannot be mixed with other fields.
+ *
+ * @param Lsb   ->  first bit of the field.
+ * @param Bits  ->  field width in bits.
+ * @param V     ->  value type: unsigned, signed (sign-extended), bool or enum.
+ */
+template<unsigned int Lsb, unsigned int Bits, typename V = std::conditional_t<(Bits > 32), uint64_t, uint32_t>>
+struct DI2CField {
+    static_assert(Bits > 0 && Lsb + Bits <= 64, "field must fit in 64 bits");
+
+    static constexpr unsigned int lsb = Lsb;
+    static constexpr unsigned int bits = Bits;
+    static constexpr uint64_t mask = (Bits == 64 ? ~0ULL : ((1ULL << Bits) - 1)) << Lsb;
+    using ValueType = V;
+
+    template<typename R>
+    static constexpr V get(R raw) {
+        uint64_t value = (static_cast<uint64_t>(raw) & mask) >> Lsb;
+        if constexpr (std::is_enum_v<V>) {
+            return static_cast<V>(value);
+        }
+        else if constexpr (std::is_same_v<V, bool>) {
+            return value != 0;
+        }
+        else if constexpr (std::is_signed_v<V>) {
+            return static_cast<V>(static_cast<int64_t>(value << (64 - Bits)) >> (64 - Bits));
+        }
+        else {
+            return static_cast<V>(value);
+        }
+    }
+
+    template<typename R>
+    static constexpr R set(R raw, V value) {
+        uint64_t v;
+        if constexpr (std::is_enum_v<V>) {
+            v = static_cast<uint64_t>(static_cast<std::underlying_type_t<V>>(value));
+        }
+        else {
+            v = static_cast<uint64_t>(value);
+        }
+        return static_cast<R>((static_cast<uint64_t>(raw) & ~mask) | ((v << Lsb) & mask));
+    }
+};
+
+//! @return true if no fields overlap.
+template<typename... Fields>
+constexpr bool di2cFieldsDisjoint(void)
+{
+    uint64_t all = 0;
+    for (uint64_t mask : { Fields::mask..., uint64_t(0) }) {
+        if (all & mask) {
+            return false;
+        }
+        all |= mask;
+    }
+    return true;
+}
+
+/**
+ * @brief A device register.
+ *
+ * @param Addr      ->  register address (aka command).
+ * @param Width     ->  register width in bytes (1..8, i.e. 3 for 24 bit registers).
+ * @param Access    ->  one of DI2CAccess values.
+ * @param E         ->  register byte order.
+ * @param Fields    ->  named bitfields (DI2CField) of the register.
+ */
+template<uint8_t Addr, size_t Width, DI2CAccess Access = ACCESS_READ_WRITE, std::endian E = std::endian::big, typename... Fields>
+struct DI2CRegister {
+    static_assert(Width > 0 && Width <= 8, "register width must be 1..8 bytes");
+    static_assert(((Fields::lsb + Fields::bits <= Width * 8) && ...), "field exceeds register width");
+    static_assert(di2cFieldsDisjoint<Fields...>(), "overlapping fields in register");
+
+    static constexpr uint8_t address = Addr;
+    static constexpr size_t width = Width;
+    static constexpr DI2CAccess access = Access;
+    static constexpr std::endian endian = E;
+    static constexpr bool readable = Access != ACCESS_WRITE_ONLY;
+    static constexpr bool writable = Access != ACCESS_READ_ONLY;
+    using RawType = DI2CUInt<Width>;
+
+    template<typename F>
+    static constexpr bool hasField = (std::is_same_v<F, Fields> || ...);
+};
+
+/**
+ * @brief Raw value of a register with type-safe field access.
+ */
+template<typename Reg>
+struct DI2CRegValue {
+    typename Reg::RawType raw = 0;
+
+    template<typename F>
+    constexpr typename F::ValueType get(void) const {
+        static_assert(Reg::template hasField<F>, "field does not belong to this register");
+        return F::get(raw);
+    }
+
+    template<typename F>
+    constexpr DI2CRegValue& set(typename F::ValueType value) {
+        static_assert(Reg::template hasField<F>, "field does not belong to this register");
+        raw = F::set(raw, value);
+        return *this;
+    }
+};
+
+//! One planned read burst: regCount consecutive registers starting at cmdReg.
+struct DI2CBurst {
+    uint8_t cmdReg;
+    uint8_t regCount;
+    uint16_t offset;    // offset in the reader buffer
+    uint16_t length;    // bytes to read
+};
+
+/**
+ * @brief Register map of a device.
+ *
+ * @param AutoIncrement ->  true if the device auto-increments the register pointer on burst reads, so consecutive
+ *                          registers can be read in one message. If false, every register is a burst, but all of
+ *                          them are still sent in a single I2C_RDWR ioctl (one repeated-start chain).
+ * @param Registers     ->  the DI2CRegister types of the device.
+ */
+template<bool AutoIncrement, typename... Registers>
+class DI2CRegMap {
+    public:
+        static constexpr size_t count = sizeof...(Registers);
+        static_assert(count > 0, "empty register map");
+
+        //! Index in the map of a register, or of the register that declares a field (count if not found).
+        template<typename Item>
+        static constexpr size_t indexOf(void) {
+            constexpr bool isReg[] = { std::is_same_v<Item, Registers>... };
+            constexpr bool hasField[] = { Registers::template hasField<Item>... };
+            for (size_t ixR=0; ixR<count; ixR++) {
+                if (isReg[ixR] || hasField[ixR]) {
+                    return ixR;
+                }
+            }
+            return count;
+        }
+
+        //! Register type of a register or field.
+        template<typename Item>
+        using RegisterOf = std::tuple_element_t<indexOf<Item>(), std::tuple<Registers...>>;
+
+        /**
+         * @brief Read a register from device.
+         * @return true on success, otherwise false (you can retrieve the error by calling master.getLastError()).
+         */
+        template<typename Reg>
+        static bool read(DI2CMaster& master, uint8_t slaveAddr, DI2CRegValue<Reg>& value) {
+            static_assert(indexOf<Reg>() < count, "register not in map");
+            static_assert(Reg::readable, "register is write only");
+            return master.askFor<typename Reg::RawType, Reg::endian, Reg::width>(slaveAddr, Reg::address, value.raw);
+        }
+
+        /**
+         * @brief Write a register to device.
+         * @return true on success, otherwise false (you can retrieve the error by calling master.getLastError()).
+         */
+        template<typename Reg>
+        static bool write(DI2CMaster& master, uint8_t slaveAddr, const DI2CRegValue<Reg>& value) {
+            static_assert(indexOf<Reg>() < count, "register not in map");
+            static_assert(Reg::writable, "register is read only");
+            return master.write<typename Reg::RawType, Reg::endian, Reg::width>(slaveAddr, Reg::address, value.raw);
+        }
+
+        /**
+         * @brief Read-modify-write of a single field.
+         * @return true on success, otherwise false (you can retrieve the error by calling master.getLastError()).
+         */
+        template<typename Field>
+        static bool modify(DI2CMaster& master, uint8_t slaveAddr, typename Field::ValueType fieldValue) {
+            using Reg = RegisterOf<Field>;
+            DI2CRegValue<Reg> value;
+            if (!read(master, slaveAddr, value)) {
+                return false;
+            }
+            value.template set<Field>(fieldValue);
+            return write(master, slaveAddr, value);
+        }
+
+        /**
+         * @brief Plan the fewest read bursts needed to read a set of registers and/or fields.
+         * @return std::array of DI2CBurst.
+         */
+        template<typename... Items>
+        static constexpr auto plan(void) {
+            constexpr Plan p = makePlan<Items...>();
+            std::array<DI2CBurst, p.burstCount> bursts{};
+            for (size_t ixB=0; ixB<p.burstCount; ixB++) {
+                bursts[ixB] = p.bursts[ixB];
+            }
+            return bursts;
+        }
+
+    private:
+        static constexpr uint16_t NOT_READ = 0xFFFF;
+
+        struct Plan {
+            std::array<DI2CBurst, count> bursts{};
+            size_t burstCount = 0;
+            size_t bufferSize = 0;
+            std::array<uint16_t, count> offsets{};  // buffer offset of each register (NOT_READ if not read)
+        };
+
+        static constexpr std::array<uint8_t, count> addresses = { Registers::address... };
+        static constexpr std::array<uint8_t, count> widths = { static_cast<uint8_t>(Registers::width)... };
+        static constexpr std::array<bool, count> readables = { Registers::readable... };
+
+        static constexpr bool addressesUnique(void) {
+            for (size_t ixA=0; ixA<count; ixA++) {
+                for (size_t ixB=ixA+1; ixB<count; ixB++) {
+                    if (addresses[ixA] == addresses[ixB]) {
+                        return false;
+                    }
+                }
+            }
+            return true;
+        }
+        static_assert(addressesUnique(), "duplicated register address in map");
+
+        template<typename... Items>
+        static constexpr Plan makePlan(void) {
+            Plan p;
+            std::array<bool, count> needed{};
+            ((needed[indexOf<Items>()] = true), ...);
+
+            // Registers indexes sorted by address
+            std::array<size_t, count> order{};
+            for (size_t ixR=0; ixR<count; ixR++) {
+                order[ixR] = ixR;
+            }
+            for (size_t ixA=1; ixA<count; ixA++) {
+                for (size_t ixB=ixA; ixB>0 && addresses[order[ixB-1]] > addresses[order[ixB]]; ixB--) {
+                    std::swap(order[ixB-1], order[ixB]);
+                }
+            }
+
+            p.offsets.fill(NOT_READ);
+            bool open = false;          // a burst is open and can be extended
+            uint16_t pendingLen = 0;    // not needed registers after the last needed one of the open burst
+            uint8_t pendingRegs = 0;
+            for (size_t ixP=0; ixP<count; ixP++) {
+                size_t ixR = order[ixP];
+                bool contiguous = AutoIncrement && ixP > 0 && addresses[ixR] == addresses[order[ixP-1]] + 1;
+                if (!contiguous || !readables[ixR]) {
+                    open = false;
+                    pendingLen = 0;
+                    pendingRegs = 0;
+                }
+                if (!readables[ixR]) {
+                    continue;
+                }
+                if (needed[ixR]) {
+                    if (open) {
+                        DI2CBurst& b = p.bursts[p.burstCount-1];
+                        // Registers in between are read anyway (cheaper than a new burst)
+                        for (size_t ixS=ixP-pendingRegs; ixS<ixP; ixS++) {
+                            p.offsets[order[ixS]] = b.offset + b.length;
+                            b.length += widths[order[ixS]];
+                        }
+                        b.regCount += pendingRegs;
+                        p.offsets[ixR] = b.offset + b.length;
+                        b.length += widths[ixR];
+                        b.regCount++;
+                    }
+                    else {
+                        p.bursts[p.burstCount++] = { addresses[ixR], 1, static_cast<uint16_t>(p.bufferSize), widths[ixR] };
+                        p.offsets[ixR] = static_cast<uint16_t>(p.bufferSize);
+                        open = AutoIncrement;
+                    }
+                    p.bufferSize += pendingLen + widths[ixR];
+                    pendingLen = 0;
+                    pendingRegs = 0;
+                }
+                else if (open) {
+                    pendingLen += widths[ixR];
+                    pendingRegs++;
+                }
+            }
+            return p;
+        }
+
+    public:
+        /**
+         * @brief Reads a set of registers and/or fields with the planned bursts and decodes them.
+         */
+        template<typename... Items>
+        class Reader {
+            public:
+                static_assert(sizeof...(Items) > 0, "nothing to read");
+                static_assert(((indexOf<Items>() < count) && ...), "register or field not in map");
+
+                static constexpr auto bursts = plan<Items...>();
+                static constexpr size_t bufferSize = makePlan<Items...>().bufferSize;
+
+                /**
+                 * @brief Perform all bursts (one ioctl when possible).
+                 * @return true on success, otherwise false (you can retrieve the error by calling master.getLastError()).
+                 */
+                bool read(DI2CMaster& master, uint8_t slaveAddr) {
+                    std::array<DI2CReadRequest, bursts.size()> requests;
+                    for (size_t ixB=0; ixB<bursts.size(); ixB++) {
+                        requests[ixB]={ bursts[ixB].cmdReg, &buffer[bursts[ixB].offset], bursts[ixB].length };
+                    }
+                    return master.askForBufs(slaveAddr, std::span<const DI2CReadRequest>(requests));
+                }
+
+                //! @return decoded value of a register (raw) or a field, from last read().
+                template<typename Item>
+                auto get(void) const {
+                    using Reg = RegisterOf<Item>;
+                    constexpr size_t offset = makePlan<Items...>().offsets[indexOf<Item>()];
+                    static_assert(offset != NOT_READ, "register or field not read by this reader");
+                    auto raw=DI2CCodec::decode<typename Reg::RawType, Reg::endian, Reg::width>(std::span<const uint8_t, Reg::width>(&buffer[offset], Reg::width));
+                    if constexpr (std::is_same_v<Item, Reg>) {
+                        return raw;
+                    }
+                    else {
+                        return Item::get(raw);
+                    }
+                }
+
+                //! @return raw bytes read.
+                std::span<const uint8_t, bufferSize> data(void) const {
+                    return std::span<const uint8_t, bufferSize>(buffer);
+                }
+
+            private:
+                std::array<uint8_t, bufferSize> buffer{};
+        };
+};
+
+#endif
@@ -0,0 +1,285 @@
+/**
+ * @file di2cstats.cpp
+ * @brief Per-bus, per-address i2c statistics.
+ * 
+ * DI2CMaster records every ioctl in the DI2CBusStats of its bus: transactions, bytes sent/received, errors (grouped
+ * by errno class) and a log2 latency histogram, for each slave address.
+ * All counters are relaxed atomics, updated without locks from any thread (i.e. DI2CPoller workers) and read without
+ * locks too: a snapshot is not an atomic picture of all counters, but each counter is consistent, that is enough
+ * to find which sensor is slowing the bus or is flapping.
+ * 
+ * How to use:
+ *
+ * @code
+ * DI2CBus i2cBus(1);
+ * INA226 ina226(0x40,0.002,i2cBus.handle());
+ * ...
+ * DI2CBusStats::DSnapshot snap;
+ * DI2CBusStats::forBus(i2cBus.handle()).getSnapshot(0x40,snap);
+ * printf("errors %llu, p99 %llu us\n",snap.errors,snap.latencyPercentileUs(99.0));
+ * @endcode
+ * 
+ * @version 0.1
+ * @date 2025-02-14
+ * 
+ * @copyright Copyright (c) 2025
+ */
+
+#include "di2cstats.h"
+#include <errno.h>
+#include <algorithm>
+#include <bit>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+
+DI2CBusStats::DI2CBusStats()
+{
+}
+
+/**
+ * @brief Record one transaction (one ioctl).
+ * 
+ * @param slaveAddr     ->  i2c slave device address.
+ * @param txBytes       ->  bytes written.
+ * @param rxBytes       ->  bytes read.
+ * @param latencyUs     ->  duration of ioctl in microseconds.
+ * @param errnoValue    ->  0 on success, otherwise the errno of failure.
+ * @param shared        ->  the ioctl also reached other addresses (each one records it with its own bytes).
+ */
+void DI2CBusStats::record(uint8_t slaveAddr, uint32_t txBytes, uint32_t rxBytes, uint64_t latencyUs, int errnoValue, bool shared)
+{
+    DAddrCounters& counters=addrCounters[slaveAddr & (ADDR_COUNT-1)];
+
+    counters.transactions.fetch_add(1,std::memory_order_relaxed);
+    if (shared) {
+        counters.shared.fetch_add(1,std::memory_order_relaxed);
+    }
+    if (errnoValue != 0) {
+        counters.errors.fetch_add(1,std::memory_order_relaxed);
+        counters.errnoCount[errnoClass(errnoValue)].fetch_add(1,std::memory_order_relaxed);
+    }
+    else {
+        counters.txBytes.fetch_add(txBytes,std::memory_order_relaxed);
+        counters.rxBytes.fetch_add(rxBytes,std::memory_order_relaxed);
+    }
+
+    size_t bucket=std::min<size_t>(std::bit_width(latencyUs >> 4),LATENCY_BUCKETS-1);
+    counters.latencyHist[bucket].fetch_add(1,std::memory_order_relaxed);
+    counters.latencySumUs.fetch_add(latencyUs,std::memory_order_relaxed);
+    uint64_t maxUs=counters.latencyMaxUs.load(std::memory_order_relaxed);
+    while (latencyUs > maxUs && !counters.latencyMaxUs.compare_exchange_weak(maxUs,latencyUs,std::memory_order_relaxed)) {
+    }
+}
+
+/**
+ * @brief Read counters of a slave address.
+ * 
+ * @param slaveAddr ->  i2c slave device address.
+ * @param snapshot  ->  destination of counters.
+ * @return true if address had at least one transaction.
+ */
+bool DI2CBusStats::getSnapshot(uint8_t slaveAddr, DSnapshot& snapshot) const
+{
+    load(addrCounters[slaveAddr & (ADDR_COUNT-1)],snapshot);
+    return snapshot.transactions > 0;
+}
+
+/**
+ * @brief Read counters of all addresses summed up.
+ */
+void DI2CBusStats::getBusSnapshot(DSnapshot& snapshot) const
+{
+    snapshot={};
+    for (const DAddrCounters& counters : addrCounters) {
+        DSnapshot addrSnap;
+        load(counters,addrSnap);
+        snapshot.transactions+=addrSnap.transactions;
+        snapshot.txBytes+=addrSnap.txBytes;
+        snapshot.rxBytes+=addrSnap.rxBytes;
+        snapshot.errors+=addrSnap.errors;
+        snapshot.shared+=addrSnap.shared;
+        for (size_t ixE=0; ixE<ERRNO_CLASSES; ixE++) {
+            snapshot.errnoCount[ixE]+=addrSnap.errnoCount[ixE];
+        }
+        for (size_t ixB=0; ixB<LATENCY_BUCKETS; ixB++) {
+            snapshot.latencyHist[ixB]+=addrSnap.latencyHist[ixB];
+        }
+        snapshot.latencySumUs+=addrSnap.latencySumUs;
+        snapshot.latencyMaxUs=std::max(snapshot.latencyMaxUs,addrSnap.latencyMaxUs);
+    }
+}
+
+/**
+ * @return the list of addresses with at least one transaction.
+ */
+std::vector<uint8_t> DI2CBusStats::activeAddresses(void) const
+{
+    std::vector<uint8_t> addrList;
+    for (size_t ixA=0; ixA<ADDR_COUNT; ixA++) {
+        if (addrCounters[ixA].transactions.load(std::memory_order_relaxed) > 0) {
+            addrList.push_back(ixA);
+        }
+    }
+    return addrList;
+}
+
+/**
+ * @brief Clear all counters.
+ * N.B. transactions in progress on other threads can be partially counted.
+ */
+void DI2CBusStats::reset(void)
+{
+    for (DAddrCounters& counters : addrCounters) {
+        counters.transactions.store(0,std::memory_order_relaxed);
+        counters.txBytes.store(0,std::memory_order_relaxed);
+        counters.rxBytes.store(0,std::memory_order_relaxed);
+        counters.errors.store(0,std::memory_order_relaxed);
+        counters.shared.store(0,std::memory_order_relaxed);
+        for (auto& count : counters.errnoCount) {
+            count.store(0,std::memory_order_relaxed);
+        }
+        for (auto& count : counters.latencyHist) {
+            count.store(0,std::memory_order_relaxed);
+        }
+        counters.latencySumUs.store(0,std::memory_order_relaxed);
+        counters.latencyMaxUs.store(0,std::memory_order_relaxed);
+    }
+}
+
+/**
+ * @return a table of active addresses, useful for logs and dashboards.
+ */
+std::string DI2CBusStats::toString(void) const
+{
+    std::ostringstream out;
+    out << "Addr\tTrans\tShared\tTx\tRx\tErrors\tAvg(us)\tP99(us)\tMax(us)\tErrno" << std::endl;
+    for (uint8_t addr : activeAddresses()) {
+        DSnapshot snap;
+        getSnapshot(addr,snap);
+        char addrText[8];
+        snprintf(addrText,sizeof(addrText),"0x%02X",addr);
+        out << addrText << "\t" << snap.transactions << "\t" << snap.shared << "\t" << snap.txBytes << "\t" << snap.rxBytes << "\t" << snap.errors << "\t"
+            << snap.latencyAvgUs() << "\t" << snap.latencyPercentileUs(99.0) << "\t" << snap.latencyMaxUs << "\t";
+        for (size_t ixE=0; ixE<ERRNO_CLASSES; ixE++) {
+            if (snap.errnoCount[ixE] > 0) {
+                out << errnoClassName(DErrnoClass(ixE)) << "=" << snap.errnoCount[ixE] << " ";
+            }
+        }
+        out << std::endl;
+    }
+    return out.str();
+}
+
+/**
+ * @brief Get the statistics of a bus.
+ * The table is created at first call for each handle (only this call takes a lock: DI2CMaster calls it once in its
+ * constructor).
+ * 
+ * @param busHandle ->  handle of the bus (can obtained by DI2CBus() class).
+ * @return statistics of the bus.
+ */
+DI2CBusStats& DI2CBusStats::forBus(DI2CBusHandle busHandle)
+{
+    static std::mutex registryMutex;
+    static std::map<DI2CBusHandle, std::unique_ptr<DI2CBusStats>> registry;
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    std::unique_ptr<DI2CBusStats>& stats=registry[busHandle];
+    if (!stats) {
+        stats=std::make_unique<DI2CBusStats>();
+    }
+    return *stats;
+}
+
+/**
+ * @return the class of an errno value.
+ */
+DI2CBusStats::DErrnoClass DI2CBusStats::errnoClass(int errnoValue)
+{
+    switch (errnoValue) {
+        case ENXIO:     return ERRNO_NXIO;
+        case EREMOTEIO: return ERRNO_REMOTEIO;
+        case ETIMEDOUT: return ERRNO_TIMEDOUT;
+        case EAGAIN:    return ERRNO_AGAIN;
+        case EIO:       return ERRNO_IO;
+        default:        return ERRNO_OTHER;
+    }
+}
+
+/**
+ * @return a short name of an errno class.
+ */
+const char* DI2CBusStats::errnoClassName(DErrnoClass errnoClass)
+{
+    switch (errnoClass) {
+        case ERRNO_NXIO:     return "ENXIO";
+        case ERRNO_REMOTEIO: return "EREMOTEIO";
+        case ERRNO_TIMEDOUT: return "ETIMEDOUT";
+        case ERRNO_AGAIN:    return "EAGAIN";
+        case ERRNO_IO:       return "EIO";
+        default:             return "OTHER";
+    }
+}
+
+/**
+ * @return the upper limit (excluded) of a latency bucket in microseconds (UINT64_MAX for the last one).
+ */
+uint64_t DI2CBusStats::bucketUpperUs(size_t bucket)
+{
+    return bucket < LATENCY_BUCKETS-1 ? uint64_t(16) << bucket : UINT64_MAX;
+}
+
+/**
+ * @return average latency in microseconds.
+ */
+uint64_t DI2CBusStats::DSnapshot::latencyAvgUs(void) const
+{
+    return transactions > 0 ? latencySumUs / transactions : 0;
+}
+
+/**
+ * @brief Estimate a latency percentile from the histogram.
+ * 
+ * @param percentile    ->  0..100
+ * @return the upper limit of the bucket of percentile (max latency for the last bucket).
+ */
+uint64_t DI2CBusStats::DSnapshot::latencyPercentileUs(double percentile) const
+{
+    uint64_t total=0;
+    for (uint64_t count : latencyHist) {
+        total+=count;
+    }
+    if (total == 0) {
+        return 0;
+    }
+
+    uint64_t target=uint64_t(total * percentile / 100.0 + 0.5);
+    uint64_t sum=0;
+    for (size_t ixB=0; ixB<LATENCY_BUCKETS; ixB++) {
+        sum+=latencyHist[ixB];
+        if (sum >= target && sum > 0) {
+            return std::min(bucketUpperUs(ixB),latencyMaxUs);
+        }
+    }
+    return latencyMaxUs;
+}
+
+void DI2CBusStats::load(const DAddrCounters& counters, DSnapshot& snapshot) const
+{
+    snapshot.transactions=counters.transactions.load(std::memory_order_relaxed);
+    snapshot.txBytes=counters.txBytes.load(std::memory_order_relaxed);
+    snapshot.rxBytes=counters.rxBytes.load(std::memory_order_relaxed);
+    snapshot.errors=counters.errors.load(std::memory_order_relaxed);
+    snapshot.shared=counters.shared.load(std::memory_order_relaxed);
+    for (size_t ixE=0; ixE<ERRNO_CLASSES; ixE++) {
+        snapshot.errnoCount[ixE]=counters.errnoCount[ixE].load(std::memory_order_relaxed);
+    }
+    for (size_t ixB=0; ixB<LATENCY_BUCKETS; ixB++) {
+        snapshot.latencyHist[ixB]=counters.latencyHist[ixB].load(std::memory_order_relaxed);
+    }
+    snapshot.latencySumUs=counters.latencySumUs.load(std::memory_order_relaxed);
+    snapshot.latencyMaxUs=counters.latencyMaxUs.load(std::memory_order_relaxed);
+}
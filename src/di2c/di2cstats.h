@@ -0,0 +1,80 @@
+#ifndef DI2CStats_H
+#define DI2CStats_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "di2cbus.h"
+
+/**
+ * @brief Statistics of an i2c bus, collected for each slave address.
+ *
+ * Counters are updated by DI2CMaster for every ioctl and can be read from any thread without locks.
+ */
+class DI2CBusStats {
+    public:
+        static constexpr size_t ADDR_COUNT = 128;      // 7 bit addresses
+        static constexpr size_t LATENCY_BUCKETS = 16;  // bucket 0: < 16us, bucket n: < 16us << n, last: all above
+
+        //! Errno classes (the ones returned by i2c adapters)
+        enum DErrnoClass {
+            ERRNO_NXIO,        // no ack on address (device missing)
+            ERRNO_REMOTEIO,    // no ack on data
+            ERRNO_TIMEDOUT,    // bus timeout (clock stretching, stuck bus)
+            ERRNO_AGAIN,       // arbitration lost
+            ERRNO_IO,          // generic adapter error
+            ERRNO_OTHER,
+            ERRNO_CLASSES
+        };
+
+        //! Copy of counters of an address (or of whole bus).
+        struct DSnapshot {
+            uint64_t transactions;
+            uint64_t txBytes;
+            uint64_t rxBytes;
+            uint64_t errors;
+            uint64_t shared;       // transactions in an ioctl with other addresses (latency and errors are of the whole ioctl)
+            std::array<uint64_t, ERRNO_CLASSES> errnoCount;
+            std::array<uint64_t, LATENCY_BUCKETS> latencyHist;
+            uint64_t latencySumUs;
+            uint64_t latencyMaxUs;
+
+            uint64_t latencyAvgUs(void) const;
+            uint64_t latencyPercentileUs(double percentile) const;
+        };
+
+        DI2CBusStats();
+
+        void record(uint8_t slaveAddr, uint32_t txBytes, uint32_t rxBytes, uint64_t latencyUs, int errnoValue, bool shared = false);
+        bool getSnapshot(uint8_t slaveAddr, DSnapshot& snapshot) const;
+        void getBusSnapshot(DSnapshot& snapshot) const;
+        std::vector<uint8_t> activeAddresses(void) const;
+        void reset(void);
+        std::string toString(void) const;
+
+        static DI2CBusStats& forBus(DI2CBusHandle busHandle);
+        static DErrnoClass errnoClass(int errnoValue);
+        static const char* errnoClassName(DErrnoClass errnoClass);
+        static uint64_t bucketUpperUs(size_t bucket);
+
+    private:
+        struct DAddrCounters {
+            std::atomic<uint64_t> transactions{0};
+            std::atomic<uint64_t> txBytes{0};
+            std::atomic<uint64_t> rxBytes{0};
+            std::atomic<uint64_t> errors{0};
+            std::atomic<uint64_t> shared{0};
+            std::array<std::atomic<uint64_t>, ERRNO_CLASSES> errnoCount{};
+            std::array<std::atomic<uint64_t>, LATENCY_BUCKETS> latencyHist{};
+            std::atomic<uint64_t> latencySumUs{0};
+            std::atomic<uint64_t> latencyMaxUs{0};
+        };
+
+        void load(const DAddrCounters& counters, DSnapshot& snapshot) const;
+
+        std::array<DAddrCounters, ADDR_COUNT> addrCounters;
+};
+
+#endif
@@ -0,0 +1,18 @@
+/**
+ * @file dsensor.cpp
+ * @brief Common interface of sensors.
+ *
+ * @version 0.1
+ * @date 2025-04-02
+ *
+ * @copyright Copyright (c) 2025
+ */
+
+#include "dsensor.h"
+#include <chrono>
+
+//! @return monotonic time in microseconds (the clock of DSensorSample timestamps).
+uint64_t DSensor::monotonicUs(void)
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
@@ -0,0 +1,71 @@
+#ifndef DSensor_H
+#define DSensor_H
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+/**
+ * Common interface of sensors (SBC only): any driver that implements DSensor can be scheduled, buffered and batched
+ * by DSensorHub together with other sensors, whatever its bus or chip.
+ *
+ * - DSensorQuantity    ->  physical quantity of a channel.
+ * - DSensorChannel     ->  one value provided by the sensor (name, quantity, unit).
+ * - DSensorSample      ->  one timestamped value of a channel.
+ * - DSensor            ->  the interface: channel list, preferred poll period, batched read.
+ */
+
+//! Physical quantity of a channel.
+enum DSensorQuantity : uint8_t {
+    QUANTITY_OTHER = 0,
+    QUANTITY_VOLTAGE,       // V
+    QUANTITY_CURRENT,       // A
+    QUANTITY_POWER,         // W
+    QUANTITY_ENERGY,        // J
+    QUANTITY_CHARGE,        // C
+    QUANTITY_TEMPERATURE,   // Celsius
+    QUANTITY_HUMIDITY       // %RH
+};
+
+//! A value provided by a sensor.
+struct DSensorChannel {
+    const char *name;       // i.e. "current"
+    DSensorQuantity quantity;
+    const char *unit;       // i.e. "A"
+};
+
+//! A timestamped value of a sensor channel.
+struct DSensorSample {
+    uint64_t timestampUs;   // monotonic time of the reading (CLOCK_MONOTONIC, same as std::chrono::steady_clock)
+    double value;           // in channel unit
+    uint16_t sensorID;      // set by DSensorHub (the id returned by addSensor())
+    uint16_t channel;       // index in getChannels()
+};
+
+class DSensor {
+    public:
+        virtual ~DSensor() = default;
+
+        //! @return the channels of the sensor (the list must not change after begin()).
+        virtual std::span<const DSensorChannel> getChannels(void) = 0;
+
+        //! @return the period that gives a new value at each read (i.e. ADC conversion time), 0 = no preference.
+        virtual uint32_t getPreferredPeriodUs(void) = 0;
+
+        /**
+         * @brief Read the sensor and write its samples (usually one for each channel, all with the same timestamp;
+         * buffered sensors can return more readings at once).
+         *
+         * @param samples   ->  destination, at least getMaxSamplesPerRead() items: sensorID is left untouched.
+         * @param count     ->  number of samples written.
+         * @return true on success, otherwise false.
+         */
+        virtual bool readInto(std::span<DSensorSample> samples, size_t& count) = 0;
+
+        //! @return the max number of samples written by a single readInto().
+        virtual size_t getMaxSamplesPerRead(void) { return getChannels().size(); }
+
+        static uint64_t monotonicUs(void);
+};
+
+#endif
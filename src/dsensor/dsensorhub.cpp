@@ -0,0 +1,314 @@
+/**
+ * @file dsensorhub.cpp
+ * @brief Schedule many sensors and merge their samples into a single stream.
+ *
+ * Each sensor is read at its own period (by default its preferred one, i.e. the ADC conversion time, so no reading
+ * is a duplicate) and all samples, tagged with the sensor id, go into one preallocated lock-free ring buffer: the
+ * application pops batches of samples of all sensors in time order of reads, without allocations or locks.
+ * Reads run in a scheduler thread (start()/stop()) or in the caller thread (poll() in a loop).
+ *
+ * How to use:
+ *
+ * @code
+ * DI2CBus bus(1);
+ * INA226 ina226(0x40, 0.002, bus.handle());
+ * INA228 ina228(0x41, bus.handle());
+ * ina226.begin(10.0);
+ * ina228.begin();
+ * DSensorHub hub(4096);
+ * int battery=hub.addSensor(&ina226);              // preferred period (conversion time)
+ * int motor=hub.addSensor(&ina228, 10000);         // 100 Hz
+ * hub.start();
+ * ...
+ * DSensorSample batch[256];
+ * size_t count=hub.popSamples(batch);
+ * @endcode
+ *
+ * N.B.
+ * A single thread reads all sensors: for sensors on different i2c buses use one hub for each bus.
+ *
+ * @version 0.1
+ * @date 2025-04-02
+ *
+ * @copyright Copyright (c) 2025
+ */
+
+#include "dsensorhub.h"
+#include <algorithm>
+#include <chrono>
+
+#define ERR_TXT_SUCCESS "Success"
+#define ERR_HUB_RUNNING "Hub is running"
+#define ERR_NO_SENSORS "No sensors to read"
+#define ERR_NULL_SENSOR "Sensor is null"
+#define ERR_TOO_MANY_SENSORS "Too many sensors"
+
+/**
+ * @param streamCapacity    ->  samples held by the stream before they are dropped (rounded up to a power of 2).
+ */
+DSensorHub::DSensorHub(size_t streamCapacity) : stream(streamCapacity)
+{
+    prepared=false;
+    running=false;
+    lastErrorString=ERR_TXT_SUCCESS;
+}
+
+DSensorHub::~DSensorHub()
+{
+    stop();
+}
+
+/**
+ * @brief Add a sensor to schedule.
+ * Can be called only when the hub is not running.
+ *
+ * @param sensor    ->  the sensor (it must live as long as the hub).
+ * @param periodUs  ->  read period in microseconds (0 = sensor preferred period, DEFAULT_PERIOD_US if it has none).
+ * @return the sensor id used in samples and getTiming(), or -1 on error (you can retrieve the error by calling
+ * getLastError()).
+ */
+int DSensorHub::addSensor(DSensor *sensor, uint32_t periodUs)
+{
+    if (running) {
+        lastErrorString=ERR_HUB_RUNNING;
+        return -1;
+    }
+    if (sensor == nullptr) {
+        lastErrorString=ERR_NULL_SENSOR;
+        return -1;
+    }
+    if (entries.size() > UINT16_MAX) {
+        lastErrorString=ERR_TOO_MANY_SENSORS;
+        return -1;
+    }
+    entries.push_back(std::make_unique<DEntry>());
+    entries.back()->sensor=sensor;
+    entries.back()->periodUs=periodUs;
+    prepared=false;
+    lastErrorString=ERR_TXT_SUCCESS;
+    return entries.size()-1;
+}
+
+/**
+ * @brief Start the scheduler thread.
+ *
+ * @return true on success, otherwise false (you can retrieve the error by calling getLastError()).
+ */
+bool DSensorHub::start(void)
+{
+    if (running) {
+        lastErrorString=ERR_HUB_RUNNING;
+        return false;
+    }
+    if (!prepare()) {
+        return false;
+    }
+    running=true;
+    thread=std::thread([this]() { schedulerLoop(); });
+    lastErrorString=ERR_TXT_SUCCESS;
+    return true;
+}
+
+/**
+ * @brief Stop the scheduler thread and wait for it.
+ */
+void DSensorHub::stop(void)
+{
+    {
+        std::lock_guard<std::mutex> lock(waitMutex);
+        if (!running) {
+            return;
+        }
+        running=false;
+    }
+    waitCond.notify_all();
+    if (thread.joinable()) {
+        thread.join();
+    }
+}
+
+//! @return true if the scheduler thread is running.
+bool DSensorHub::isRunning(void)
+{
+    return running;
+}
+
+/**
+ * @brief Read all due sensors in the caller thread (use it instead of start(), i.e. in the application main loop).
+ *
+ * @return number of samples added to the stream (0 also on error: you can retrieve it by calling getLastError()).
+ */
+size_t DSensorHub::poll(void)
+{
+    if (running) {
+        lastErrorString=ERR_HUB_RUNNING;
+        return 0;
+    }
+    if (!prepared && !prepare()) {
+        return 0;
+    }
+    size_t produced=0;
+    runDue(DSensor::monotonicUs(),produced);
+    return produced;
+}
+
+/**
+ * @brief Remove the oldest samples of all sensors from the stream (lock-free, one consumer thread).
+ *
+ * @param samples   ->  destination.
+ * @return number of samples written.
+ */
+size_t DSensorHub::popSamples(std::span<DSensorSample> samples)
+{
+    return stream.pop(samples);
+}
+
+//! @return samples waiting in the stream.
+size_t DSensorHub::available(void)
+{
+    return stream.size();
+}
+
+//! @return samples lost because the stream was full (pop them faster or use a larger stream).
+size_t DSensorHub::getDroppedCount(void)
+{
+    return stream.droppedCount();
+}
+
+//! @return number of sensors added.
+size_t DSensorHub::sensorsCount(void)
+{
+    return entries.size();
+}
+
+/**
+ * @brief Get timing and counters of a sensor (can be called from any thread).
+ *
+ * @param sensorID  ->  the id returned by addSensor().
+ * @param timing    ->  destination.
+ * @return false if sensorID is not valid.
+ */
+bool DSensorHub::getTiming(size_t sensorID, DSensorHub::DSensorTiming& timing)
+{
+    if (sensorID >= entries.size()) {
+        return false;
+    }
+    DEntry& entry=*entries[sensorID];
+    timing.periodUs=entry.periodUs;
+    timing.lastReadUs=entry.lastReadUs.load(std::memory_order_relaxed);
+    timing.maxReadUs=entry.maxReadUs.load(std::memory_order_relaxed);
+    timing.maxLateUs=entry.maxLateUs.load(std::memory_order_relaxed);
+    timing.reads=entry.reads.load(std::memory_order_relaxed);
+    timing.errors=entry.errors.load(std::memory_order_relaxed);
+    timing.samples=entry.samples.load(std::memory_order_relaxed);
+    uint32_t calls=timing.reads+timing.errors;
+    timing.avgReadUs=calls > 0 ? entry.totalReadUs.load(std::memory_order_relaxed)/calls : 0;
+    return true;
+}
+
+/**
+ * @return last error.
+ */
+std::string DSensorHub::getLastError(void)
+{
+    return lastErrorString;
+}
+
+/**
+ * @brief Resolve periods, size the read buffer and make all sensors due now.
+ */
+bool DSensorHub::prepare(void)
+{
+    if (entries.empty()) {
+        lastErrorString=ERR_NO_SENSORS;
+        return false;
+    }
+    size_t maxSamples=0;
+    uint64_t nowUs=DSensor::monotonicUs();
+    for (auto& entry : entries) {
+        if (entry->periodUs == 0) {
+            entry->periodUs=entry->sensor->getPreferredPeriodUs();
+        }
+        // A zero period would read the sensor back to back (the scheduler would never sleep)
+        if (entry->periodUs == 0) {
+            entry->periodUs=DEFAULT_PERIOD_US;
+        }
+        entry->nextDueUs=nowUs;
+        maxSamples=std::max(maxSamples,entry->sensor->getMaxSamplesPerRead());
+    }
+    scratch.resize(maxSamples);
+    prepared=true;
+    return true;
+}
+
+/**
+ * @brief Read due sensors and push their samples.
+ *
+ * @param nowUs     ->  current time.
+ * @param produced  ->  incremented by the number of samples pushed.
+ * @return the due time of the next sensor.
+ */
+uint64_t DSensorHub::runDue(uint64_t nowUs, size_t& produced)
+{
+    uint64_t nextWakeUs=UINT64_MAX;
+    for (size_t ixS=0; ixS<entries.size(); ixS++) {
+        DEntry& entry=*entries[ixS];
+        if (entry.nextDueUs <= nowUs) {
+            uint64_t startUs=DSensor::monotonicUs();
+            size_t count=0;
+            bool ok=entry.sensor->readInto(scratch,count);
+            uint64_t readUs=DSensor::monotonicUs()-startUs;
+
+            count=std::min(count,scratch.size());
+            for (size_t ixC=0; ixC<count; ixC++) {
+                scratch[ixC].sensorID=static_cast<uint16_t>(ixS);
+                stream.push(scratch[ixC]);
+            }
+            produced+=count;
+
+            // Single writer: plain load/store
+            entry.lastReadUs.store(readUs,std::memory_order_relaxed);
+            entry.totalReadUs.store(entry.totalReadUs.load(std::memory_order_relaxed)+readUs,std::memory_order_relaxed);
+            if (readUs > entry.maxReadUs.load(std::memory_order_relaxed)) {
+                entry.maxReadUs.store(readUs,std::memory_order_relaxed);
+            }
+            uint64_t lateUs=startUs-entry.nextDueUs;
+            if (lateUs > entry.maxLateUs.load(std::memory_order_relaxed)) {
+                entry.maxLateUs.store(lateUs,std::memory_order_relaxed);
+            }
+            if (ok) {
+                entry.reads.store(entry.reads.load(std::memory_order_relaxed)+1,std::memory_order_relaxed);
+            }
+            else {
+                entry.errors.store(entry.errors.load(std::memory_order_relaxed)+1,std::memory_order_relaxed);
+            }
+            entry.samples.store(entry.samples.load(std::memory_order_relaxed)+count,std::memory_order_relaxed);
+
+            // Next due time (if late more than a period, restart from now)
+            entry.nextDueUs+=entry.periodUs;
+            if (entry.nextDueUs < nowUs) {
+                entry.nextDueUs=nowUs+entry.periodUs;
+            }
+        }
+        nextWakeUs=std::min(nextWakeUs,entry.nextDueUs);
+    }
+    return nextWakeUs;
+}
+
+/**
+ * @brief Scheduler: read due sensors, sleep until next due sensor.
+ */
+void DSensorHub::schedulerLoop(void)
+{
+    while (running) {
+        size_t produced=0;
+        uint64_t nextWakeUs=runDue(DSensor::monotonicUs(),produced);
+
+        // Wait for next due sensor (or stop)
+        uint64_t nowUs=DSensor::monotonicUs();
+        if (nextWakeUs > nowUs) {
+            std::unique_lock<std::mutex> lock(waitMutex);
+            waitCond.wait_for(lock,std::chrono::microseconds(nextWakeUs-nowUs),[this]() { return !running; });
+        }
+    }
+}
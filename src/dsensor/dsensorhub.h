@@ -0,0 +1,79 @@
+#ifndef DSensorHub_H
+#define DSensorHub_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+#include <dringbuffer>
+#include "dsensor.h"
+
+class DSensorHub {
+    public:
+        //! Read period of sensors without a preferred one (getPreferredPeriodUs() = 0).
+        static constexpr uint32_t DEFAULT_PERIOD_US = 10000;
+
+        //! Timing and counters of a sensor.
+        struct DSensorTiming {
+            uint32_t periodUs;      // scheduled period
+            uint64_t lastReadUs;    // duration of last readInto()
+            uint64_t maxReadUs;     // longest readInto()
+            uint64_t avgReadUs;     // average readInto() duration
+            uint64_t maxLateUs;     // worst delay of a read from its due time
+            uint32_t reads;         // successful reads
+            uint32_t errors;        // failed reads
+            uint64_t samples;       // samples produced
+        };
+
+        explicit DSensorHub(size_t streamCapacity = 4096);
+        ~DSensorHub();
+
+        int addSensor(DSensor *sensor, uint32_t periodUs = 0);
+        bool start(void);
+        void stop(void);
+        bool isRunning(void);
+        size_t poll(void);
+
+        size_t popSamples(std::span<DSensorSample> samples);
+        size_t available(void);
+        size_t getDroppedCount(void);
+        size_t sensorsCount(void);
+        bool getTiming(size_t sensorID, DSensorHub::DSensorTiming& timing);
+        std::string getLastError(void);
+
+    private:
+        struct DEntry {
+            DSensor *sensor;
+            uint32_t periodUs;
+            uint64_t nextDueUs;
+            std::atomic<uint64_t> lastReadUs{0};
+            std::atomic<uint64_t> maxReadUs{0};
+            std::atomic<uint64_t> totalReadUs{0};
+            std::atomic<uint64_t> maxLateUs{0};
+            std::atomic<uint32_t> reads{0};
+            std::atomic<uint32_t> errors{0};
+            std::atomic<uint64_t> samples{0};
+        };
+
+        bool prepare(void);
+        uint64_t runDue(uint64_t nowUs, size_t& produced);
+        void schedulerLoop(void);
+
+        std::vector<std::unique_ptr<DEntry>> entries;
+        std::vector<DSensorSample> scratch;     // readInto() destination, sized by prepare()
+        DRingBuffer<DSensorSample> stream;
+        bool prepared;
+
+        std::thread thread;
+        std::atomic<bool> running;
+        std::mutex waitMutex;
+        std::condition_variable waitCond;
+        std::string lastErrorString;
+};
+
+#endif
@@ -51,7 +51,7 @@ namespace std {
                 size_t len = snprintf(nullptr,0,format,args ...);
                 str.reserve(len);
                 snprintf(str.c_str(),len,format,args ...);
-                return this;
+                return *this;
             };
 
             void resize(size_t lenght, char c = ' ') {
@@ -0,0 +1,107 @@
+#ifndef DRingBuffer_H
+#define DRingBuffer_H
+
+#include <atomic>
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <span>
+
+/**
+ * @brief Lock-free single producer / single consumer ring buffer (SBC only).
+ *
+ * One thread push()es (i.e. a sampler worker), one thread pop()s (i.e. the application): no locks, no allocations
+ * after construction. Capacity is rounded up to a power of 2.
+ * When full, push() fails and the item is counted as dropped (old items are never overwritten, so the consumer
+ * always sees a gap-free sequence up to the drop).
+ *
+ * @code
+ * DRingBuffer<INA226::Sample> ring(1024);
+ * // Producer
+ * ring.push(sample);
+ * // Consumer
+ * INA226::Sample batch[64];
+ * size_t count=ring.pop(batch);
+ * @endcode
+ */
+template<typename T>
+class DRingBuffer {
+    public:
+        explicit DRingBuffer(size_t minCapacity)
+        {
+            size_t cap=1;
+            while (cap < minCapacity) {
+                cap<<=1;
+            }
+            mask=cap-1;
+            items=std::make_unique<T[]>(cap);
+        }
+
+        //! Producer side: append an item, false if full.
+        bool push(const T& item)
+        {
+            size_t h=head.load(std::memory_order_relaxed);
+            if (h - tail.load(std::memory_order_acquire) > mask) {
+                dropped.fetch_add(1,std::memory_order_relaxed);
+                return false;
+            }
+            items[h & mask]=item;
+            head.store(h+1,std::memory_order_release);
+            return true;
+        }
+
+        //! Consumer side: remove the oldest item, false if empty.
+        bool pop(T& item)
+        {
+            size_t t=tail.load(std::memory_order_relaxed);
+            if (t == head.load(std::memory_order_acquire)) {
+                return false;
+            }
+            item=items[t & mask];
+            tail.store(t+1,std::memory_order_release);
+            return true;
+        }
+
+        //! Consumer side: remove up to dest.size() oldest items, returns how many.
+        size_t pop(std::span<T> dest)
+        {
+            size_t t=tail.load(std::memory_order_relaxed);
+            size_t count=std::min(dest.size(), head.load(std::memory_order_acquire) - t);
+            for (size_t ixI=0; ixI<count; ixI++) {
+                dest[ixI]=items[(t+ixI) & mask];
+            }
+            tail.store(t+count,std::memory_order_release);
+            return count;
+        }
+
+        //! Consumer side: discard all items.
+        void clear(void)
+        {
+            tail.store(head.load(std::memory_order_acquire),std::memory_order_release);
+        }
+
+        size_t size(void) const
+        {
+            return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+        }
+
+        size_t capacity(void) const
+        {
+            return mask+1;
+        }
+
+        //! @return items refused because buffer was full.
+        size_t droppedCount(void) const
+        {
+            return dropped.load(std::memory_order_relaxed);
+        }
+
+    private:
+        std::unique_ptr<T[]> items;
+        size_t mask;
+        alignas(64) std::atomic<size_t> head{0};    // written by producer only
+        alignas(64) std::atomic<size_t> tail{0};    // written by consumer only
+        std::atomic<size_t> dropped{0};
+};
+
+#endif
@@ -0,0 +1,393 @@
+#ifndef DStats_H
+#define DStats_H
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+/**
+ * Streaming statistics of timestamped samples (i.e. INA226/INA228 readings): O(1) per sample, fixed memory, no
+ * allocations (SBC only).
+ *
+ * - DStatsResult       ->  count, mean, min, max, RMS, variance of a set of samples.
+ * - DRunningStats      ->  all samples since reset (Welford).
+ * - DTumblingStats     ->  consecutive non-overlapping windows of a duration and/or a number of samples.
+ * - DSlidingStats<N>   ->  last N samples and/or samples of last windowUs.
+ * - DEma               ->  exponential moving average, by alpha or by time constant.
+ *
+ * @code
+ * DSlidingStats<1000> last100ms(100000);
+ * DTumblingStats perSecond(1000000);
+ * INA226::Sample batch[64];
+ * size_t count=ina226.popSamples(batch);
+ * for (size_t ixS=0; ixS<count; ixS++) {
+ *     last100ms.push(batch[ixS].timestampUs, batch[ixS].current);
+ *     if (perSecond.push(batch[ixS].timestampUs, batch[ixS].current)) {
+ *         printf("%.3f A avg, %.3f A peak\n", perSecond.getLastWindow().mean, perSecond.getLastWindow().max);
+ *     }
+ * }
+ * @endcode
+ */
+
+//! Statistics of a set of samples.
+struct DStatsResult {
+    size_t count = 0;
+    double mean = 0;
+    double min = 0;
+    double max = 0;
+    double rms = 0;
+    double variance = 0;        // population variance
+    uint64_t firstUs = 0;       // timestamp of first sample
+    uint64_t lastUs = 0;        // timestamp of last sample
+
+    double stddev(void) const { return std::sqrt(variance); }
+};
+
+/**
+ * @brief Statistics of all samples since last reset().
+ */
+class DRunningStats {
+    public:
+        void push(uint64_t timestampUs, double value)
+        {
+            if (count == 0) {
+                firstUs=timestampUs;
+                minValue=value;
+                maxValue=value;
+            }
+            count++;
+            double delta=value-mean;
+            mean+=delta/count;
+            m2+=delta*(value-mean);
+            minValue=std::min(minValue,value);
+            maxValue=std::max(maxValue,value);
+            lastUs=timestampUs;
+        }
+
+        void reset(void)
+        {
+            count=0;
+            mean=0;
+            m2=0;
+        }
+
+        size_t getCount(void) const { return count; }
+
+        DStatsResult getResult(void) const
+        {
+            DStatsResult result;
+            if (count == 0) {
+                return result;
+            }
+            result.count=count;
+            result.mean=mean;
+            result.min=minValue;
+            result.max=maxValue;
+            result.variance=m2/count;
+            result.rms=std::sqrt(result.variance+mean*mean);
+            result.firstUs=firstUs;
+            result.lastUs=lastUs;
+            return result;
+        }
+
+    private:
+        size_t count = 0;
+        double mean = 0;
+        double m2 = 0;          // sum of squared differences from mean
+        double minValue = 0;
+        double maxValue = 0;
+        uint64_t firstUs = 0;
+        uint64_t lastUs = 0;
+};
+
+/**
+ * @brief Consecutive non-overlapping windows: a window closes when it lasts windowUs or has maxSamples samples
+ * (0 = no limit), and its result is kept until next window closes.
+ */
+class DTumblingStats {
+    public:
+        DTumblingStats(uint64_t windowUs, size_t maxSamples = 0) : windowUs(windowUs), maxSamples(maxSamples) {}
+
+        /**
+         * @brief Add a sample.
+         * @return true if a window closed (read it with getLastWindow()).
+         */
+        bool push(uint64_t timestampUs, double value)
+        {
+            bool closed=false;
+            bool aligned=false;
+            if (current.getCount() > 0 && windowUs > 0 && timestampUs-windowStartUs >= windowUs) {
+                closeWindow();
+                closed=true;
+                // Next window follows the closed one (no drift), unless a gap skipped whole windows
+                if (timestampUs-windowStartUs < 2*windowUs) {
+                    windowStartUs+=windowUs;
+                    aligned=true;
+                }
+            }
+            if (current.getCount() == 0 && !aligned) {
+                windowStartUs=timestampUs;
+            }
+            current.push(timestampUs,value);
+            if (maxSamples > 0 && current.getCount() >= maxSamples) {
+                closeWindow();
+                closed=true;
+            }
+            return closed;
+        }
+
+        //! Result of last closed window.
+        const DStatsResult& getLastWindow(void) const { return lastWindow; }
+        //! Partial result of the window in progress.
+        DStatsResult getCurrentWindow(void) const { return current.getResult(); }
+        uint64_t getWindowsCount(void) const { return windowsCount; }
+
+        void reset(void)
+        {
+            current.reset();
+            lastWindow=DStatsResult();
+            windowsCount=0;
+        }
+
+    private:
+        void closeWindow(void)
+        {
+            lastWindow=current.getResult();
+            current.reset();
+            windowsCount++;
+        }
+
+        uint64_t windowUs;
+        size_t maxSamples;
+        uint64_t windowStartUs = 0;
+        uint64_t windowsCount = 0;
+        DRunningStats current;
+        DStatsResult lastWindow;
+};
+
+/**
+ * @brief Statistics of the last N samples, and of the samples of last windowUs only (if windowUs > 0).
+ * Mean/variance are updated on insert and remove (recomputed from the window every N samples, so rounding errors
+ * can't build up), min/max with monotonic queues: all O(1) amortized.
+ * Memory is 48 x N bytes: declare large windows as members or static, not on the stack.
+ */
+template<size_t N>
+class DSlidingStats {
+    static_assert(N > 0, "window must hold at least one sample");
+
+    public:
+        explicit DSlidingStats(uint64_t windowUs = 0) : windowUs(windowUs) {}
+
+        void push(uint64_t timestampUs, double value)
+        {
+            if (count == N) {
+                removeOldest();
+            }
+            while (windowUs > 0 && count > 0 && timestampUs-samples[tail].timestampUs >= windowUs) {
+                removeOldest();
+            }
+
+            size_t ix=wrap(tail+count);
+            samples[ix]={timestampUs, value};
+            count++;
+            seq++;
+
+            double delta=value-mean;
+            mean+=delta/count;
+            m2+=delta*(value-mean);
+
+            pushMonotonic(minQueue, minHead, minCount, value, [](double a, double b) { return a <= b; });
+            pushMonotonic(maxQueue, maxHead, maxCount, value, [](double a, double b) { return a >= b; });
+
+            if (++sinceRecompute == N) {
+                recompute();
+            }
+        }
+
+        //! Remove samples older than windowUs from timestampUs (i.e. now) without adding one.
+        void expire(uint64_t timestampUs)
+        {
+            while (windowUs > 0 && count > 0 && timestampUs-samples[tail].timestampUs >= windowUs) {
+                removeOldest();
+            }
+        }
+
+        DStatsResult getResult(void) const
+        {
+            DStatsResult result;
+            if (count == 0) {
+                return result;
+            }
+            result.count=count;
+            result.mean=mean;
+            result.min=minQueue[minHead].value;
+            result.max=maxQueue[maxHead].value;
+            result.variance=std::max(m2/count, 0.0);
+            result.rms=std::sqrt(result.variance+mean*mean);
+            result.firstUs=samples[tail].timestampUs;
+            result.lastUs=samples[wrap(tail+count-1)].timestampUs;
+            return result;
+        }
+
+        size_t getCount(void) const { return count; }
+
+        void reset(void)
+        {
+            count=0;
+            tail=0;
+            mean=0;
+            m2=0;
+            minHead=minCount=0;
+            maxHead=maxCount=0;
+            sinceRecompute=0;
+        }
+
+    private:
+        struct DSample {
+            uint64_t timestampUs;
+            double value;
+        };
+        struct DExtreme {
+            double value;
+            uint64_t seq;   // sequence number of the sample
+        };
+
+        // Ring index of ix < 2N (no division: ARM11 has no integer divide)
+        static size_t wrap(size_t ix) { return ix >= N ? ix-N : ix; }
+
+        void removeOldest(void)
+        {
+            double value=samples[tail].value;
+            uint64_t oldestSeq=seq-count;
+            tail=wrap(tail+1);
+            count--;
+
+            if (count == 0) {
+                mean=0;
+                m2=0;
+            }
+            else {
+                double delta=value-mean;
+                mean-=delta/count;
+                m2-=delta*(value-mean);
+            }
+
+            if (minCount > 0 && minQueue[minHead].seq == oldestSeq) {
+                minHead=wrap(minHead+1);
+                minCount--;
+            }
+            if (maxCount > 0 && maxQueue[maxHead].seq == oldestSeq) {
+                maxHead=wrap(maxHead+1);
+                maxCount--;
+            }
+        }
+
+        // Drop from the back the items the new value dominates, then append it
+        template<typename Dominates>
+        void pushMonotonic(std::array<DExtreme, N>& queue, size_t& head, size_t& qCount, double value, Dominates dominates)
+        {
+            while (qCount > 0 && dominates(value, queue[wrap(head+qCount-1)].value)) {
+                qCount--;
+            }
+            queue[wrap(head+qCount)]={value, seq-1};
+            qCount++;
+        }
+
+        void recompute(void)
+        {
+            sinceRecompute=0;
+            double sum=0;
+            for (size_t ixS=0; ixS<count; ixS++) {
+                sum+=samples[wrap(tail+ixS)].value;
+            }
+            mean=sum/count;
+            m2=0;
+            for (size_t ixS=0; ixS<count; ixS++) {
+                double delta=samples[wrap(tail+ixS)].value-mean;
+                m2+=delta*delta;
+            }
+        }
+
+        uint64_t windowUs;
+        std::array<DSample, N> samples;
+        size_t tail = 0;
+        size_t count = 0;
+        uint64_t seq = 0;           // samples pushed
+        double mean = 0;
+        double m2 = 0;
+        size_t sinceRecompute = 0;
+
+        std::array<DExtreme, N> minQueue;
+        size_t minHead = 0;
+        size_t minCount = 0;
+        std::array<DExtreme, N> maxQueue;
+        size_t maxHead = 0;
+        size_t maxCount = 0;
+};
+
+/**
+ * @brief Exponential moving average.
+ * With a time constant, alpha follows the sample interval (1 - e^(-dt/tau)), so irregular sample streams are
+ * weighted by time; alpha is recomputed only when the interval changes.
+ */
+class DEma {
+    public:
+        //! Fixed alpha (0..1, weight of the new sample).
+        static DEma withAlpha(double alpha)
+        {
+            DEma ema;
+            ema.alpha=alpha;
+            return ema;
+        }
+
+        //! Time constant in microseconds.
+        static DEma withTimeConstant(uint64_t tauUs)
+        {
+            DEma ema;
+            ema.tauUs=tauUs;
+            return ema;
+        }
+
+        double push(uint64_t timestampUs, double value)
+        {
+            if (!started) {
+                average=value;
+                started=true;
+            }
+            else {
+                if (tauUs > 0) {
+                    uint64_t dtUs=timestampUs-lastUs;
+                    if (dtUs != lastDtUs) {
+                        lastDtUs=dtUs;
+                        alpha=1.0-std::exp(-double(dtUs)/double(tauUs));
+                    }
+                }
+                average+=alpha*(value-average);
+            }
+            lastUs=timestampUs;
+            return average;
+        }
+
+        double getValue(void) const { return average; }
+
+        void reset(void)
+        {
+            started=false;
+            average=0;
+        }
+
+    private:
+        DEma() = default;
+
+        double alpha = 1.0;
+        uint64_t tauUs = 0;
+        uint64_t lastUs = 0;
+        uint64_t lastDtUs = std::numeric_limits<uint64_t>::max();
+        double average = 0;
+        bool started = false;
+};
+
+#endif
@@ -54,9 +54,7 @@ namespace std {
 
             //! Adds new value. If needed, allocates more space
             void push_back(Data const &x) {
-                if (d_capacity <= d_size) {
-                    resize(d_size+1);
-                }
+                resize(d_size+1);
                 d_data[d_size-1]=x;
             };
 
@@ -95,23 +93,25 @@ namespace std {
                 return d_data[idx];
             };
 
-            //! Resize vector to new_size (d_size is also updated)
+            /**
+             * Resize vector to new_size (d_size is also updated).
+             * Capacity grows geometrically (at least doubles) and never shrinks, so growing one element at a time
+             * reallocates only log(n) times: use shrink_to_fit() to release memory.
+             */
             void resize(size_t new_size) {
-                if (new_size == d_size) {
-                    return;
+                if (new_size > d_capacity) {
+                    size_t new_cap=d_capacity*2;
+                    reserve(new_cap > new_size ? new_cap : new_size);
                 }
-                Data *t_data;
-                t_data=(Data *) realloc(d_data,new_size * sizeof(Data));
-                d_capacity=new_size;
                 d_size=new_size;
-                d_data=t_data;
             };
 
             //! Resize vector to new_size and fill new spaces with val (d_size is also updated)
             void resize(size_t new_size, const Data& value) {
+                size_t old_size=d_size;
                 resize(new_size);
                 // fill the rest
-                for (size_t ix=d_size; ix < d_capacity; ix++) {
+                for (size_t ix=old_size; ix < d_size; ix++) {
                     d_data[ix]=value;
                 }
             };
@@ -132,19 +132,29 @@ namespace std {
             //! Requests the removal of unused capacity (for compatibility)
             void shrink_to_fit(void) {
                 if (d_capacity > d_size) {
-                    resize(d_size);
+                    d_data=(Data *) realloc(d_data,d_size * sizeof(Data));
+                    d_capacity=d_size;
                 }
             }
 
+            //! @return number of elements that can be held in currently allocated storage.
+            size_t capacity() const {
+                return d_capacity;
+            }
+
             //! Returns pointer to the underlying array serving as element storage.
             Data* data(void) {
                 return(d_data);
             }
 
+            const Data* data(void) const {
+                return(d_data);
+            }
+
             //! Erase an element from vector
             Data erase(size_t idx) {
-                for (size_t ix=idx; ix<d_capacity-1; ix++) {
-                    d_data[ix]=d_data[idx+1];
+                for (size_t ix=idx; ix+1<d_size; ix++) {
+                    d_data[ix]=d_data[ix+1];
                 }
                 resize(d_size-1);
 
@@ -155,7 +165,7 @@ namespace std {
                 return(d_data[idx]);
             }
 
-            bool empty(void) {
+            bool empty(void) const {
                 return d_size == 0;
             }
     };
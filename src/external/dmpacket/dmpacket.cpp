@@ -25,8 +25,10 @@
 
 /**
  * @brief Crea un pacchetto vuoto
+ * @param byteOrder ->  byte order of 16/32 bit values (see setByteOrder()).
  */
-DMPacket::DMPacket() {
+DMPacket::DMPacket(DMPacketByteOrder byteOrder) {
+	this->byteOrder=byteOrder;
 	clear();
 };
 
@@ -35,6 +37,7 @@ DMPacket::DMPacket() {
  * @param Buff		->	buffer di bytes.
  */
 DMPacket::DMPacket(const std::vector<uint8_t>& buffVec) {
+	byteOrder=DMPACKET_BIG_ENDIAN;
 	setBuffer(buffVec);
 };
 
@@ -42,7 +45,8 @@ DMPacket::DMPacket(const std::vector<uint8_t>& buffVec) {
  * @brief Crea un pacchetto eseguendo il parsing del buffer passato
  * @param buffVec	->  un std::vector<uint8_t>.
  */
-DMPacket::DMPacket(uint8_t buff[], uint16_t buffSize) {
+DMPacket::DMPacket(const uint8_t buff[], size_t buffSize) {
+	byteOrder=DMPACKET_BIG_ENDIAN;
 	setBuffer(buff,buffSize);
 };
 
@@ -52,41 +56,77 @@ DMPacket::~DMPacket() {
 
 /**
  * @brief Resetta il pacchetto.
- * -Riporta la dimensione a HDR_SIZE.
- * -Azzera il contenuto.
+ * -Riporta la dimensione a 0.
  * -Azzera li shiftIndex
+ * The allocated buffer is kept, so a reused packet does not reallocate (see shrinkToFit()).
  */
 void DMPacket::clear() {
 	packetBuff.resize(0);
-	packetBuff.shrink_to_fit();
     shiftIndex=0;
 }
 
+/**
+ * @brief Release the unused capacity of the buffer.
+ */
+void DMPacket::shrinkToFit() {
+	packetBuff.shrink_to_fit();
+}
+
 //! @return la lunghezza in bytes del paccketto
-uint8_t DMPacket::size(void) {
+size_t DMPacket::size(void) {
 	return(packetBuff.size());
 }
 
+//! @return bytes that the packet can hold before reallocating.
+size_t DMPacket::capacity(void) {
+	return(packetBuff.capacity());
+}
+
+/**
+ * @brief Set the byte order of 16/32 bit values (words, double words, floats) of following reads and writes.
+ * Big endian (the default) is the original DMPacket format; little endian avoids swapping bytes when both ends are
+ * little endian (ARM, x86, ESP32, AVR): typed reads and writes become plain copies.
+ * 
+ * @param byteOrder ->  DMPACKET_BIG_ENDIAN or DMPACKET_LITTLE_ENDIAN.
+ */
+void DMPacket::setByteOrder(DMPacketByteOrder byteOrder) {
+	this->byteOrder=byteOrder;
+}
+
+//! @return the byte order of 16/32 bit values.
+DMPacketByteOrder DMPacket::getByteOrder(void) {
+	return(byteOrder);
+}
+
+/**
+ * @brief Allocate room for capacity bytes, so pushing up to that size never reallocates.
+ * Without reserve() the buffer grows geometrically (it doubles), so a growing packet reallocates only log(n) times.
+ * 
+ * @param capacity  ->  bytes to allocate.
+ */
+void DMPacket::reserve(size_t capacity) {
+	packetBuff.reserve(capacity);
+}
+
 /**
  * @brief Copia Buff direttamente nel buffer del pacchetto.
  * 
   * @param Buff		->  buffer di bytes.
- * @param BuffSize	->	lunghezza del buffer (max 256).
+ * @param BuffSize	->	lunghezza del buffer.
  *
  **/
-void DMPacket::setBuffer(const uint8_t buff[], uint16_t buffSize) {
+void DMPacket::setBuffer(const uint8_t buff[], size_t buffSize) {
 	// Set buffer size
 	packetBuff.resize(buffSize);
 	// Fill it
-	//packetBuff.assign(Buff,BuffLen);
-	for (uint8_t ixB=0; ixB<buffSize; ixB++) {
-		packetBuff[ixB]=buff[ixB];
+	if (buffSize > 0) {
+		memcpy(packetBuff.data(),buff,buffSize);
 	}
     // Zeros shift index
     shiftIndex=0;
 }
 
-void DMPacket::setBuffer(const char buff[], uint16_t buffSize) {
+void DMPacket::setBuffer(const char buff[], size_t buffSize) {
     setBuffer((uint8_t *) buff,buffSize);
 }
 
@@ -117,25 +157,34 @@ std::vector<uint8_t>& DMPacket::buffer() {
 	return(packetBuff);
 }
 
+/**
+ * @brief Non-owning view of packet content (valid until the packet is modified).
+ * 
+ * @return DMPacketView 
+ */
+DMPacketView DMPacket::view() {
+	return DMPacketView(packetBuff,byteOrder);
+}
+
 /**
  * @brief Convert packet content into an hex string.
  * 
  * @param offset    ->  offset in buffer.
  * @return std::string containing an hex rappresentation of packet content like 01:F2:FF:E6
  */
-std::string DMPacket::toHexString(uint16_t offset) {
-    if (packetBuff.empty()) {
+std::string DMPacket::toHexString(size_t offset) {
+    if (offset >= packetBuff.size()) {
         return std::string();
     }
-    uint16_t MemSize=(packetBuff.size()-offset)*3; // 2 bytes + ':' for each byte
-    char *HexStr=new char[MemSize];
+    size_t MemSize=(packetBuff.size()-offset)*3; // 2 bytes + ':' for each byte
+    char *HexStr=new char[MemSize+1];   // +1 for the terminator written by sprintf
     char *itr=&HexStr[0]; // iterator pointer
     //size_t ixP;
     for (size_t ixP=offset; ixP<packetBuff.size(); ixP++) {
         itr+=sprintf(itr,"%02X:",packetBuff[ixP]);
     }
     std::string Ret=std::string(HexStr,MemSize-1); // (-1 because last byte have no ':' to the end)
-    delete HexStr;
+    delete[] HexStr;
     return Ret;
 }
 
@@ -145,19 +194,19 @@ std::string DMPacket::toHexString(uint16_t offset) {
  * @param offset    ->  offset in buffer.
  * @return std::string a string containing ascii convertion of all bytes in buffer (characters that can not be printed are replaced with '.')
  */
-std::string DMPacket::toAsciiString(uint16_t offset) {
-    if (packetBuff.empty()) {
+std::string DMPacket::toAsciiString(size_t offset) {
+    if (offset >= packetBuff.size()) {
         return std::string();
     }
-    uint16_t MemSize=(packetBuff.size()-offset)*3;
-    char *AsciiStr=new char[MemSize];
+    size_t MemSize=(packetBuff.size()-offset)*3;
+    char *AsciiStr=new char[MemSize+1];   // +1 for the terminator written by sprintf
     char *itr=&AsciiStr[0]; // iterator pointer
     //size_t ixP;
     for (size_t ixP=offset; ixP<packetBuff.size(); ixP++) {
         itr+=sprintf(itr,"%c  ",isprint(packetBuff[ixP]) ? packetBuff[ixP] : '.');
     }
     std::string Ret=std::string(AsciiStr,MemSize);
-    delete AsciiStr;
+    delete[] AsciiStr;
     return Ret;
 }
 
@@ -170,7 +219,7 @@ std::string DMPacket::toAsciiString(uint16_t offset) {
  * @param Index ->  offset of byte to read in the payload.
  * @return 8 bit value.
  */
-uint8_t DMPacket::readByte(uint16_t offset)
+uint8_t DMPacket::readByte(size_t offset)
 {
     if (offset < packetBuff.size()) {
         return packetBuff[offset];
@@ -189,10 +238,10 @@ uint8_t DMPacket::readByte(uint16_t offset)
  * @param Index ->  offset of byte in the payload where to start reading.
  * @return 16 bit value.
  */
-uint16_t DMPacket::readWord(uint16_t offset)
+uint16_t DMPacket::readWord(size_t offset)
 {
     if (offset+1 < packetBuff.size()) {
-	    return WORD(packetBuff[offset],packetBuff[offset+1]);
+	    return DMPacketEndian::load16(byteOrder,&packetBuff[offset]);
     }
     else {
         #ifdef TROWS_EXCEPTION_ON_READ_OVERFLOW
@@ -208,10 +257,10 @@ uint16_t DMPacket::readWord(uint16_t offset)
  * @param Index ->  offset of byte in the payload where to start reading.
  * @return 32 bit value.
  */
-uint32_t DMPacket::readDWord(uint16_t offset)
+uint32_t DMPacket::readDWord(size_t offset)
 {
     if (offset+3 < packetBuff.size()) {
-	    return DWORD_B(packetBuff[offset],packetBuff[offset+1],packetBuff[offset+2],packetBuff[offset+3]);
+	    return DMPacketEndian::load32(byteOrder,&packetBuff[offset]);
     }
     else {
         #ifdef TROWS_EXCEPTION_ON_READ_OVERFLOW
@@ -227,7 +276,7 @@ uint32_t DMPacket::readDWord(uint16_t offset)
  * @param Index ->  offset of byte to read in the payload.
  * @return integer value.
  */
-int8_t DMPacket::readInt8(uint16_t offset)
+int8_t DMPacket::readInt8(size_t offset)
 {
 	return((int8_t)readByte(offset));
 }
@@ -237,7 +286,7 @@ int8_t DMPacket::readInt8(uint16_t offset)
  * @param Index ->  offset of byte to read in the payload.
  * @return 16 bit integer value.
  */
-int16_t DMPacket::readInt16(uint16_t offset)
+int16_t DMPacket::readInt16(size_t offset)
 {
 	return((int16_t)readWord(offset));
 }
@@ -247,7 +296,7 @@ int16_t DMPacket::readInt16(uint16_t offset)
  * @param Index ->  Number of the float to read (first is 1).
  * @return float value.
  */
-float DMPacket::readFloat(uint16_t offset)
+float DMPacket::readFloat(size_t offset)
 {
 	uint32_t DWord=readDWord(offset);
 	// Important cast from dword to float
@@ -266,7 +315,7 @@ float DMPacket::readFloat(uint16_t offset)
  * @param Index ->  offset of byte to read in the payload.
  * @return true if readed byte is non-zero otherwise false.
  */
-bool DMPacket::readBool(uint16_t offset)
+bool DMPacket::readBool(size_t offset)
 {
     uint8_t Byte=readByte(offset);
     return Byte == 0 ? false : true;
@@ -279,7 +328,10 @@ bool DMPacket::readBool(uint16_t offset)
  * @param Len 
  * @return std::string 
  */
-std::string DMPacket::readString(uint16_t offset, uint16_t lenght) {
+std::string DMPacket::readString(size_t offset, size_t lenght) {
+    if (offset > packetBuff.size()) {
+        return std::string();
+    }
     if (lenght == 0) {
         // To the end of packetBuffer
         lenght=packetBuff.size()-offset;
@@ -293,13 +345,16 @@ std::string DMPacket::readString(uint16_t offset, uint16_t lenght) {
         #endif
     }
 
-    std::string sData;
-    sData.resize(lenght);
-    for (size_t ixS=0; ixS<lenght; ixS++) {
-        sData[ixS]=packetBuff[ixS+offset];
-    }
-
-    return(sData);
+    #ifdef ARDUINO
+        std::string sData;
+        sData.resize(lenght);
+        for (size_t ixS=0; ixS<lenght; ixS++) {
+            sData[ixS]=packetBuff[ixS+offset];
+        }
+        return(sData);
+    #else
+        return std::string((const char *) packetBuff.data()+offset,lenght);
+    #endif
 }
 
 /**
@@ -307,8 +362,11 @@ std::string DMPacket::readString(uint16_t offset, uint16_t lenght) {
  * 
  * @return un vector<uint8_t> contenente il payload
  */
-std::vector<uint8_t> DMPacket::readBytes(uint16_t offset, uint16_t count)
+std::vector<uint8_t> DMPacket::readBytes(size_t offset, size_t count)
 {
+    if (offset > packetBuff.size()) {
+        return std::vector<uint8_t>();
+    }
     if (count == 0) {
         // To the end of buffer
         count=packetBuff.size()-offset;
@@ -324,8 +382,8 @@ std::vector<uint8_t> DMPacket::readBytes(uint16_t offset, uint16_t count)
 
 	std::vector<uint8_t> data;
     data.resize(count);
-    for (size_t ixB=0; ixB<count; ixB++) {
-        data[ixB]=packetBuff[ixB+offset];
+    if (count > 0) {
+        memcpy(data.data(),packetBuff.data()+offset,count);
     }
 
     return data;
@@ -337,8 +395,12 @@ std::vector<uint8_t> DMPacket::readBytes(uint16_t offset, uint16_t count)
  * @param Datadest	->	Vettore di bytes in cui mettere i dati
  * @return false se i dati del pacchetto non sono di tipo byte o se è un pacchetto senza senza dati.
  */
-uint16_t DMPacket::readBytes(std::vector<uint8_t>& dest, uint16_t offset, uint16_t count)
+size_t DMPacket::readBytes(std::vector<uint8_t>& dest, size_t offset, size_t count)
 {
+    if (offset > packetBuff.size()) {
+        dest.resize(0);
+        return 0;
+    }
     if (count == 0) {
         // To the end of buffer
         count=packetBuff.size()-offset;
@@ -353,9 +415,8 @@ uint16_t DMPacket::readBytes(std::vector<uint8_t>& dest, uint16_t offset, uint16
     }
     
 	dest.resize(count);
-
-    for (size_t ixB=0; ixB<count; ixB++) {
-        dest[ixB]=packetBuff[ixB+offset];
+    if (count > 0) {
+        memcpy(dest.data(),packetBuff.data()+offset,count);
     }
 
 	return(dest.size());
@@ -367,32 +428,13 @@ uint16_t DMPacket::readBytes(std::vector<uint8_t>& dest, uint16_t offset, uint16
  * @param Data	->	Vettore di words in cui mettere i dati
  * @return false se i dati del pacchetto non sono di tipo byte o se è un pacchetto senza senza dati.
  */
-std::vector<uint16_t> DMPacket::readWords(uint16_t offset, uint16_t count)
+std::vector<uint16_t> DMPacket::readWords(size_t offset, size_t count)
 {
-    if (count == 0) {
-        // Truncate to the last block
-        uint16_t FreeSpace=packetBuff.size()-offset;
-        count=FreeSpace/2;
-    }
-    else if ((offset+(count*2)) > packetBuff.size()) {
-        #ifdef TROWS_EXCEPTION_ON_READ_OVERFLOW
-            throw("Reading over buffer operation not permitted");
-        #else
-            // Truncate to the last block
-            uint16_t FreeSpace=packetBuff.size()-offset;
-            count=FreeSpace/2;
-        #endif
-    }
-
     std::vector<uint16_t> data;
-	data.reserve(count);
-
-    // Read 2 bytes at time
-    for (uint16_t ixD=0; ixD<count; ixD++) {
-        data[ixD]=WORD(packetBuff[offset],packetBuff[offset+1]);
-        offset+=2;
+	data.resize(valuesCount(offset,count,2));
+    if (data.size() > 0) {
+        DMPacketEndian::load16(byteOrder,data.data(),packetBuff.data()+offset,data.size());
     }
-
 	return data;
 }
 
@@ -402,34 +444,95 @@ std::vector<uint16_t> DMPacket::readWords(uint16_t offset, uint16_t count)
  * @param Data	->	Vettore di words in cui mettere i dati
  * @return false se i dati del pacchetto non sono di tipo byte o se è un pacchetto senza senza dati.
  */
-std::vector<uint32_t> DMPacket::readDWords(uint16_t offset, uint16_t count)
+std::vector<uint32_t> DMPacket::readDWords(size_t offset, size_t count)
+{
+    std::vector<uint32_t> data;
+	data.resize(valuesCount(offset,count,4));
+    if (data.size() > 0) {
+        DMPacketEndian::load32(byteOrder,data.data(),packetBuff.data()+offset,data.size());
+    }
+	return data;
+}
+
+/**
+ * @brief Read an array of words (uint16_t) into caller storage (no allocations, bulk byte swap).
+ * 
+ * @param dest      ->  destination.
+ * @param offset    ->  index offset in packetBuffer.
+ * @param count     ->  number of words to read.
+ * @return number of words read (truncated to the end of buffer).
+ */
+size_t DMPacket::readWordsInto(uint16_t dest[], size_t offset, size_t count)
 {
     if (count == 0) {
-        // Truncate to the last block
-        uint16_t FreeSpace=packetBuff.size()-offset;
-        count=FreeSpace/4;
+        return 0;
     }
-    else if (offset+(count*4) > packetBuff.size()) {
-        #ifdef TROWS_EXCEPTION_ON_READ_OVERFLOW
-            throw("Reading over buffer operation not permitted");
-        #else
-            // Truncate to the last block
-            uint16_t FreeSpace=packetBuff.size()-offset;
-            count=FreeSpace/4;
-        #endif
+    count=valuesCount(offset,count,2);
+    if (count > 0) {
+        DMPacketEndian::load16(byteOrder,dest,packetBuff.data()+offset,count);
     }
+    return count;
+}
 
-    std::vector<uint32_t> data;
-	data.reserve(count);
+/**
+ * @brief Read an array of double words (uint32_t) into caller storage (no allocations, bulk byte swap).
+ * 
+ * @param dest      ->  destination.
+ * @param offset    ->  index offset in packetBuffer.
+ * @param count     ->  number of double words to read.
+ * @return number of double words read (truncated to the end of buffer).
+ */
+size_t DMPacket::readDWordsInto(uint32_t dest[], size_t offset, size_t count)
+{
+    if (count == 0) {
+        return 0;
+    }
+    count=valuesCount(offset,count,4);
+    if (count > 0) {
+        DMPacketEndian::load32(byteOrder,dest,packetBuff.data()+offset,count);
+    }
+    return count;
+}
 
-    // Read 4 bytes at time
-    for (uint16_t ixD=count; ixD<packetBuff.size(); ixD++) {
-        data[ixD]=DWORD_B(packetBuff[offset],packetBuff[offset+1],packetBuff[offset+2],packetBuff[offset+3]);
-        offset+=4;
+/**
+ * @brief Read an array of floats into caller storage (no allocations, bulk byte swap).
+ * 
+ * @param dest      ->  destination.
+ * @param offset    ->  index offset in packetBuffer.
+ * @param count     ->  number of floats to read.
+ * @return number of floats read (truncated to the end of buffer).
+ */
+size_t DMPacket::readFloatsInto(float dest[], size_t offset, size_t count)
+{
+    if (count == 0) {
+        return 0;
     }
+    count=valuesCount(offset,count,4);
+    if (count > 0) {
+        DMPacketEndian::loadFloat(byteOrder,dest,packetBuff.data()+offset,count);
+    }
+    return count;
+}
 
-	return data;
+#ifdef DMPACKET_HAS_SPAN
+//! @brief Read dest.size() words (see readWordsInto()).
+size_t DMPacket::readWordsInto(std::span<uint16_t> dest, size_t offset)
+{
+    return readWordsInto(dest.data(),offset,dest.size());
+}
+
+//! @brief Read dest.size() double words (see readDWordsInto()).
+size_t DMPacket::readDWordsInto(std::span<uint32_t> dest, size_t offset)
+{
+    return readDWordsInto(dest.data(),offset,dest.size());
+}
+
+//! @brief Read dest.size() floats (see readFloatsInto()).
+size_t DMPacket::readFloatsInto(std::span<float> dest, size_t offset)
+{
+    return readFloatsInto(dest.data(),offset,dest.size());
 }
+#endif
 
 // ********************************************************************************************************
 // ***************************************** Write...ing methods ******************************************
@@ -443,7 +546,7 @@ std::vector<uint32_t> DMPacket::readDWords(uint16_t offset, uint16_t count)
  * 
  * N.B. if offset is out of range, nothing will be done.
  */
-void DMPacket::writeByte(uint8_t Byte, uint16_t offset)
+void DMPacket::writeByte(uint8_t Byte, size_t offset)
 {
     if (offset >= packetBuff.size()) {
         return;
@@ -460,13 +563,12 @@ void DMPacket::writeByte(uint8_t Byte, uint16_t offset)
  * N.B.
  * - If offset is out of range, nothing will be done.
  */
-void DMPacket::writeWord(uint16_t Word, uint16_t offset)
+void DMPacket::writeWord(uint16_t Word, size_t offset)
 {
     if ((offset+1) >= packetBuff.size()) {
         return;
     }
-	packetBuff[offset]=HIBYTE(Word);
-	packetBuff[offset]=LOBYTE(Word);
+	DMPacketEndian::store16(byteOrder,&packetBuff[offset],Word);
 }
 
 /**
@@ -478,15 +580,12 @@ void DMPacket::writeWord(uint16_t Word, uint16_t offset)
  * N.B.
  * - If offset is out of range or data overflows, nothing will be done.
  */
-void DMPacket::writeDWord(uint32_t DWord, uint16_t offset)
+void DMPacket::writeDWord(uint32_t DWord, size_t offset)
 {
     if ((offset+3) >= packetBuff.size()) {
         return;
     }
-	packetBuff[offset]=HIBYTE(HIWORD(DWord));
-	packetBuff[offset]=LOBYTE(HIWORD(DWord));
-	packetBuff[offset]=HIBYTE(LOWORD(DWord));
-	packetBuff[offset]=LOBYTE(LOWORD(DWord));
+	DMPacketEndian::store32(byteOrder,&packetBuff[offset],DWord);
 }
 
 /**
@@ -498,7 +597,7 @@ void DMPacket::writeDWord(uint32_t DWord, uint16_t offset)
  * N.B.
  * - If offset is out of range or data overflows, nothing will be done.
  */
-void DMPacket::writeInt16(int16_t Int, uint16_t offset)
+void DMPacket::writeInt16(int16_t Int, size_t offset)
 {
     if ((offset+1) >= packetBuff.size()) {
         return;
@@ -515,23 +614,12 @@ void DMPacket::writeInt16(int16_t Int, uint16_t offset)
  * N.B.
  * - If offset is out of range or data overflows, nothing will be done.
  */
-void DMPacket::writeFloat(float Float, uint16_t offset)
+void DMPacket::writeFloat(float Float, size_t offset)
 {
     if (offset+3 >= packetBuff.size()) {
         return;
     }
-	// Important: cast from float to dword
-	//uint32_t f=*(uint32_t*)&Float;
-	//uint32_t f=float(Float);
-    union {
-        float ff;
-        uint32_t ii;
-    }d;
-    d.ff=Float;
-	packetBuff[offset]=HIBYTE(HIWORD(d.ii));
-	packetBuff[offset]=LOBYTE(HIWORD(d.ii));
-	packetBuff[offset]=HIBYTE(LOWORD(d.ii));
-	packetBuff[offset]=LOBYTE(LOWORD(d.ii));
+	DMPacketEndian::store32(byteOrder,&packetBuff[offset],DMPacketBE::fromFloat(Float));
 }
 
 /**
@@ -542,7 +630,7 @@ void DMPacket::writeFloat(float Float, uint16_t offset)
  * 
  * N.B. if offset is out of range, nothing will be done.
  */
-void DMPacket::writeBool(bool Bool, uint16_t offset)
+void DMPacket::writeBool(bool Bool, size_t offset)
 {
     if (offset >= packetBuff.size()) {
         return;
@@ -560,23 +648,22 @@ void DMPacket::writeBool(bool Bool, uint16_t offset)
  * - If offset is out of range, nothing will be done.
  * - If data overflows, string will be truncated to the end of buffer.
  */
-void DMPacket::writeString(std::string str, uint16_t offset)
+void DMPacket::writeString(std::string str, size_t offset)
 {
     if (offset >= packetBuff.size()) {
         return;
     }
 
-    // @todo Whats the fastest?
+    size_t count=packetBuff.size()-offset;
+    if (str.size() < count) {
+        count=str.size();
+    }
     #ifdef ARDUINO
-        const auto maxSize = packetBuff.size()-offset;
-        for (size_t ixB=offset; ixB<maxSize; ixB++) {
-            packetBuff[ixB]=str[ixB-offset];
+        for (size_t ixB=0; ixB<count; ixB++) {
+            packetBuff[offset+ixB]=str[ixB];
         }
     #else
-        const auto maxSize = packetBuff.size()-offset;
-        std::transform(str.begin(), str.end(), std::next(packetBuff.begin()+offset, maxSize), [](uint8_t c) {
-            return c;
-        });
+        memcpy(&packetBuff[offset],str.data(),count);
     #endif
 }
 
@@ -590,14 +677,8 @@ void DMPacket::writeString(std::string str, uint16_t offset)
  * - If offset is out of range, nothing will be done.
  * - If data overflows, buffVect will be truncated to the end of buffer.
  */
-void DMPacket::writeData(const std::vector<uint8_t>& buffVec, uint16_t offset) {
-    auto maxOffset=offset+buffVec.size();
-    if (maxOffset >= packetBuff.size()) {
-        maxOffset=packetBuff.size();
-    }
-    for(uint16_t ixB=offset; ixB<maxOffset; ixB++) {
-        packetBuff[ixB]=buffVec[ixB-offset];
-    }
+void DMPacket::writeData(const std::vector<uint8_t>& buffVec, size_t offset) {
+    writeData(buffVec.data(),buffVec.size(),offset);
 }
 
 /**
@@ -611,14 +692,15 @@ void DMPacket::writeData(const std::vector<uint8_t>& buffVec, uint16_t offset) {
  * - If offset is out of range, nothing will be done.
  * - If data overflows, buffVect will be truncated to the end of buffer.
  */
-void DMPacket::writeData(const uint8_t buff[], const uint16_t buffSize, uint16_t offset) {
-    auto maxOffset=offset+buffSize;
-    if (maxOffset >= packetBuff.size()) {
-        maxOffset=packetBuff.size();
+void DMPacket::writeData(const uint8_t buff[], size_t buffSize, size_t offset) {
+    if (offset >= packetBuff.size()) {
+        return;
     }
-    for (uint8_t ixB=offset; ixB<maxOffset; ixB++) {
-		packetBuff[ixB]=*buff++;
-	}
+    size_t count=packetBuff.size()-offset;
+    if (buffSize < count) {
+        count=buffSize;
+    }
+    memcpy(&packetBuff[offset],buff,count);
 }
 
 // ********************************************************************************************************
@@ -642,10 +724,7 @@ void DMPacket::pushByte(uint8_t Byte)
  */
 void DMPacket::pushWord(uint16_t Word)
 {
-	uint8_t Ix=packetBuff.size();
-	packetBuff.resize(Ix+2);
-	packetBuff[Ix]=HIBYTE(Word);
-	packetBuff[Ix+1]=LOBYTE(Word);
+	DMPacketEndian::store16(byteOrder,grow(2),Word);
 }
 
 /**
@@ -655,12 +734,7 @@ void DMPacket::pushWord(uint16_t Word)
  */
 void DMPacket::pushDWord(uint32_t DWord)
 {
-	uint8_t Ix=packetBuff.size();
-	packetBuff.resize(Ix+4);
-	packetBuff[Ix]=HIBYTE(HIWORD(DWord));
-	packetBuff[Ix+1]=LOBYTE(HIWORD(DWord));
-	packetBuff[Ix+2]=HIBYTE(LOWORD(DWord));
-	packetBuff[Ix+3]=LOBYTE(LOWORD(DWord));
+	DMPacketEndian::store32(byteOrder,grow(4),DWord);
 }
 
 /**
@@ -680,20 +754,7 @@ void DMPacket::pushInt16(int16_t Int16)
  */
 void DMPacket::pushFloat(float Float)
 {
-	uint8_t Ix=packetBuff.size();
-	packetBuff.resize(Ix+4);
-	// Important: cast from float to dword
-	//uint32_t f=*(uint32_t*)&Float;
-	//uint32_t f=float(Float);
-    union {
-        float ff;
-        uint32_t ii;
-    }d;
-    d.ff=Float;
-	packetBuff[Ix]=HIBYTE(HIWORD(d.ii));
-	packetBuff[Ix+1]=LOBYTE(HIWORD(d.ii));
-	packetBuff[Ix+2]=HIBYTE(LOWORD(d.ii));
-	packetBuff[Ix+3]=LOBYTE(LOWORD(d.ii));
+	DMPacketEndian::store32(byteOrder,grow(4),DMPacketBE::fromFloat(Float));
 }
 
 /**
@@ -715,22 +776,12 @@ void DMPacket::pushString(std::string str)
 {
     #ifdef ARDUINO
         size_t currSize=packetBuff.size();
-	    packetBuff.resize(currSize+str.size());
+        packetBuff.resize(currSize+str.size());
         for (size_t ixP=currSize; ixP<packetBuff.size(); ixP++) {
             packetBuff[ixP]=str[ixP-currSize];
         }
     #else
-        const auto currSize = packetBuff.size();
-        packetBuff.resize(currSize + str.size());
-        std::transform(str.begin(), str.end(), std::next(packetBuff.begin(), currSize), [](uint8_t c) {
-            return c;
-        });
-/*
-        response.reserve(response.size() + headers.size());  // Optional
-std::transform(headers.begin(), headers.end(), std::back_inserter(response),
-    [](unsigned char c) { return std::byte{c}; }              // or `encode(c)`
-);
-*/
+        pushData((const uint8_t *) str.data(),str.size());
     #endif
 }
 
@@ -740,15 +791,7 @@ std::transform(headers.begin(), headers.end(), std::back_inserter(response),
  * @param buffVec   ->  vector of bytes to add.
  */
 void DMPacket::pushData(const std::vector<uint8_t>& buffVec) {
-    packetBuff.reserve(packetBuff.size() + buffVec.size());
-    for(uint16_t ixV=0; ixV<buffVec.size(); ixV++) {
-        packetBuff.emplace_back(buffVec[ixV]);
-    }
-    /*
-    for (uint8_t b : buffVec) {
-        packetBuff.emplace_back(b);
-    }
-    */
+    pushData(buffVec.data(),buffVec.size());
 }
 
 /**
@@ -757,12 +800,88 @@ void DMPacket::pushData(const std::vector<uint8_t>& buffVec) {
  * @param buff      ->  buffer pointer.
  * @param buffSize  ->  size of buffer.
  */
-void DMPacket::pushData(const uint8_t buff[], const uint16_t buffSize) {
-    uint16_t startByte=packetBuff.size();
-    packetBuff.resize(startByte + buffSize);
-    for (uint8_t ixB=startByte; ixB<buffSize; ixB++) {
-		packetBuff[ixB]=*buff++;
-	}
+void DMPacket::pushData(const uint8_t buff[], size_t buffSize) {
+    if (buffSize > 0) {
+        memcpy(grow(buffSize),buff,buffSize);
+    }
+}
+
+/**
+ * @brief Add an array of words (uint16_t) to the packet (one grow, bulk byte swap).
+ * 
+ * @param values    ->  words to add.
+ * @param count     ->  number of words.
+ */
+void DMPacket::pushWords(const uint16_t values[], size_t count) {
+    if (count > 0) {
+        DMPacketEndian::store16(byteOrder,grow(count*2),values,count);
+    }
+}
+
+/**
+ * @brief Add an array of double words (uint32_t) to the packet (one grow, bulk byte swap).
+ * 
+ * @param values    ->  double words to add.
+ * @param count     ->  number of double words.
+ */
+void DMPacket::pushDWords(const uint32_t values[], size_t count) {
+    if (count > 0) {
+        DMPacketEndian::store32(byteOrder,grow(count*4),values,count);
+    }
+}
+
+/**
+ * @brief Add an array of floats to the packet (one grow, bulk byte swap).
+ * 
+ * @param values    ->  floats to add.
+ * @param count     ->  number of floats.
+ */
+void DMPacket::pushFloats(const float values[], size_t count) {
+    if (count > 0) {
+        DMPacketEndian::storeFloat(byteOrder,grow(count*4),values,count);
+    }
+}
+
+#ifdef DMPACKET_HAS_SPAN
+void DMPacket::pushWords(std::span<const uint16_t> values) {
+    pushWords(values.data(),values.size());
+}
+
+void DMPacket::pushDWords(std::span<const uint32_t> values) {
+    pushDWords(values.data(),values.size());
+}
+
+void DMPacket::pushFloats(std::span<const float> values) {
+    pushFloats(values.data(),values.size());
+}
+#endif
+
+/**
+ * @brief Add a varint: 1 byte below 128, 2 below 16384, up to 5 (see DMPacketVarint).
+ * 
+ * @param value     ->  value to add.
+ */
+void DMPacket::pushVarUInt(uint32_t value) {
+    DMPacketVarint::encode(grow(DMPacketVarint::size(value)),value);
+}
+
+/**
+ * @brief Add a zigzag varint: small negative values stay short too.
+ * 
+ * @param value     ->  value to add.
+ */
+void DMPacket::pushVarInt(int32_t value) {
+    pushVarUInt(DMPacketVarint::zigzag(value));
+}
+
+/**
+ * @brief Append count bytes to fill in place (i.e. by DMPacketSchema::pack()).
+ *
+ * @param count     ->  bytes to append (their content is undefined until written).
+ * @return a pointer to the appended bytes (valid until the next push/clear).
+ */
+uint8_t* DMPacket::pushSpace(size_t count) {
+    return grow(count);
 }
 
 // ********************************************************************************************************
@@ -777,8 +896,7 @@ void DMPacket::pushData(const uint8_t buff[], const uint16_t buffSize) {
  * @return uint8_t 
  */
 uint8_t DMPacket::shiftByte(void) {
-    if (packetBuff.size() > 0) {
-        //return packetBuff[shiftIndex++];
+    if (shiftIndex < packetBuff.size()) {
         uint8_t data=packetBuff[shiftIndex];
         shiftIndex++;
         return data;
@@ -800,7 +918,7 @@ uint8_t DMPacket::shiftByte(void) {
  * @return uint16_t 
  */
 uint16_t DMPacket::shiftWord(void) {
-    if (packetBuff.size() >= 2) {
+    if (shiftIndex+1 < packetBuff.size()) {
         uint16_t data=readWord(shiftIndex);
         shiftIndex+=2;
         return data;
@@ -822,12 +940,18 @@ uint16_t DMPacket::shiftWord(void) {
  * @return uint32_t 
  */
 uint32_t DMPacket::shiftDWord(void) {
-    if (packetBuff.size() > 0) {
-        uint16_t data=readDWord(shiftIndex);
+    if (shiftIndex+3 < packetBuff.size()) {
+        uint32_t data=readDWord(shiftIndex);
         shiftIndex+=4;
         return data;
     }
-    return 0;
+    else {
+        #ifdef TROWS_EXCEPTION_ON_READ_OVERFLOW
+            throw("Reading over buffer operation not permitted");
+        #else
+            return 0xFFFFFFFF;
+        #endif
+    }
 }
 
 /**
@@ -850,7 +974,7 @@ bool DMPacket::shiftBool(void) {
  * @param lenght    ->  number of characters to read.
  * @return uint32_t 
  */
-std::string DMPacket::shiftString(uint16_t lenght) {
+std::string DMPacket::shiftString(size_t lenght) {
     std::string s=readString(shiftIndex,lenght);
     shiftIndex+=s.size();
     // @todo needs?
@@ -859,3 +983,79 @@ std::string DMPacket::shiftString(uint16_t lenght) {
     //}
     return s;
 }
+
+/**
+ * @brief Pop a varint.
+ * 
+ * @return the value (0xFFFFFFFF if truncated or malformed: the rest of the packet is skipped).
+ */
+uint32_t DMPacket::shiftVarUInt(void) {
+    uint32_t value;
+    if (!decodeVarint(value)) {
+        #ifdef TROWS_EXCEPTION_ON_READ_OVERFLOW
+            throw("Reading over buffer operation not permitted");
+        #endif
+        return 0xFFFFFFFF;
+    }
+    return value;
+}
+
+/**
+ * @brief Pop a zigzag varint.
+ * 
+ * @return the value (-2147483648 if truncated or malformed: the rest of the packet is skipped).
+ */
+int32_t DMPacket::shiftVarInt(void) {
+    return DMPacketVarint::unzigzag(shiftVarUInt());
+}
+
+/**
+ * @brief Append count bytes to the buffer (capacity grows geometrically, see reserve()).
+ * 
+ * @return pointer to the first appended byte.
+ */
+uint8_t* DMPacket::grow(size_t count) {
+    size_t ix=packetBuff.size();
+    packetBuff.resize(ix+count);
+    return packetBuff.data()+ix;
+}
+
+/**
+ * @brief Decode the varint at shiftIndex and move past it (to the end of buffer if it is truncated or malformed).
+ */
+bool DMPacket::decodeVarint(uint32_t& value) {
+    size_t n=0;
+    if (shiftIndex < packetBuff.size()) {
+        n=DMPacketVarint::decode(packetBuff.data()+shiftIndex,packetBuff.size()-shiftIndex,value);
+    }
+    if (n == 0) {
+        shiftIndex=packetBuff.size();
+        return false;
+    }
+    shiftIndex+=n;
+    return true;
+}
+
+/**
+ * @brief Number of values of valueSize bytes that can be read from offset.
+ *
+ * @param count     ->  values requested (0 = to the end of buffer).
+ * @return count, truncated to the last whole value in buffer.
+ */
+size_t DMPacket::valuesCount(size_t offset, size_t count, size_t valueSize) {
+    if (offset > packetBuff.size()) {
+        return 0;
+    }
+    size_t available=(packetBuff.size()-offset)/valueSize;
+    if (count == 0) {
+        return available;
+    }
+    if (count > available) {
+        #ifdef TROWS_EXCEPTION_ON_READ_OVERFLOW
+            throw("Reading over buffer operation not permitted");
+        #else
+            return available;
+        #endif
+    }
+    return count;
+}
@@ -13,45 +13,65 @@
 
 #include <vector>
 #include <string>
+#include "dmpacketview.h"
+#include "dmpacketframe.h"
+#include "dmpacketpool.h"
+#include "dmpacketrouter.h"
+#include "dmpacketschema.h"
+#include "dmpacketstream.h"
 
 class DMPacket {
     public:
-        DMPacket();
-        DMPacket(uint8_t buff[], uint16_t buffSize);
+        DMPacket(DMPacketByteOrder byteOrder = DMPACKET_BIG_ENDIAN);
+        DMPacket(const uint8_t buff[], size_t buffSize);
         DMPacket(const std::vector<uint8_t>& buffVec);
         ~DMPacket();
 
         void clear();
-        uint8_t size(void);
+        void shrinkToFit();
+        size_t size(void);
+        size_t capacity(void);
+        void reserve(size_t capacity);
+        void setByteOrder(DMPacketByteOrder byteOrder);
+        DMPacketByteOrder getByteOrder(void);
         uint8_t* rawBuffer(void);
         std::vector<uint8_t>& buffer(void);
+        DMPacketView view(void);
 
-        void setBuffer(const uint8_t buff[], uint16_t buffLen);
-        void setBuffer(const char buff[], uint16_t buffLen);
+        void setBuffer(const uint8_t buff[], size_t buffLen);
+        void setBuffer(const char buff[], size_t buffLen);
         void setBuffer(const std::vector<uint8_t>& buffVec);
 
-        uint8_t readByte(uint16_t offset);
-        uint16_t readWord(uint16_t offset);
-        uint32_t readDWord(uint16_t offset);
-        int8_t readInt8(uint16_t offset);
-        int16_t readInt16(uint16_t offset);
-        float readFloat(uint16_t offset);
-        bool readBool(uint16_t offset);
-        std::vector<uint8_t> readBytes(uint16_t offset, uint16_t count = 0);
-        uint16_t readBytes(std::vector<uint8_t>& dest, uint16_t offset, uint16_t count = 0);
-        std::vector<uint16_t> readWords(uint16_t offset, uint16_t count = 0);
-        std::vector<uint32_t> readDWords(uint16_t offset, uint16_t count = 0);
-        std::string readString(uint16_t offset = 0, uint16_t lenght = 0);
-
-        void writeByte(uint8_t Byte, uint16_t offset);
-        void writeWord(uint16_t Word, uint16_t offset);
-        void writeDWord(uint32_t DWord, uint16_t offset);
-        void writeInt16(int16_t Int, uint16_t offset);
-        void writeFloat(float Float, uint16_t offset);
-        void writeBool(bool Bool, uint16_t offset);
-        void writeString(std::string Str, uint16_t offset);
-        void writeData(const std::vector<uint8_t>& buffVec, uint16_t offset);
-        void writeData(const uint8_t buff[], const uint16_t buffSize, uint16_t offset);
+        uint8_t readByte(size_t offset);
+        uint16_t readWord(size_t offset);
+        uint32_t readDWord(size_t offset);
+        int8_t readInt8(size_t offset);
+        int16_t readInt16(size_t offset);
+        float readFloat(size_t offset);
+        bool readBool(size_t offset);
+        std::vector<uint8_t> readBytes(size_t offset, size_t count = 0);
+        size_t readBytes(std::vector<uint8_t>& dest, size_t offset, size_t count = 0);
+        std::vector<uint16_t> readWords(size_t offset, size_t count = 0);
+        std::vector<uint32_t> readDWords(size_t offset, size_t count = 0);
+        size_t readWordsInto(uint16_t dest[], size_t offset, size_t count);
+        size_t readDWordsInto(uint32_t dest[], size_t offset, size_t count);
+        size_t readFloatsInto(float dest[], size_t offset, size_t count);
+        #ifdef DMPACKET_HAS_SPAN
+        size_t readWordsInto(std::span<uint16_t> dest, size_t offset);
+        size_t readDWordsInto(std::span<uint32_t> dest, size_t offset);
+        size_t readFloatsInto(std::span<float> dest, size_t offset);
+        #endif
+        std::string readString(size_t offset = 0, size_t lenght = 0);
+
+        void writeByte(uint8_t Byte, size_t offset);
+        void writeWord(uint16_t Word, size_t offset);
+        void writeDWord(uint32_t DWord, size_t offset);
+        void writeInt16(int16_t Int, size_t offset);
+        void writeFloat(float Float, size_t offset);
+        void writeBool(bool Bool, size_t offset);
+        void writeString(std::string Str, size_t offset);
+        void writeData(const std::vector<uint8_t>& buffVec, size_t offset);
+        void writeData(const uint8_t buff[], size_t buffSize, size_t offset);
 
         void pushByte(uint8_t Byte);
         void pushWord(uint16_t Word);
@@ -61,21 +81,80 @@ class DMPacket {
         void pushBool(bool Bool);
         void pushString(std::string str);
         void pushData(const std::vector<uint8_t>& buffVec);
-        void pushData(const uint8_t buff[], const uint16_t buffSize);
+        void pushData(const uint8_t buff[], size_t buffSize);
+        void pushWords(const uint16_t values[], size_t count);
+        void pushDWords(const uint32_t values[], size_t count);
+        void pushFloats(const float values[], size_t count);
+        #ifdef DMPACKET_HAS_SPAN
+        void pushWords(std::span<const uint16_t> values);
+        void pushDWords(std::span<const uint32_t> values);
+        void pushFloats(std::span<const float> values);
+        #endif
+        uint8_t* pushSpace(size_t count);
+        void pushVarUInt(uint32_t value);
+        void pushVarInt(int32_t value);
+        template<typename T>
+        void pushDeltas(const T values[], size_t count, T base = 0);
 
         uint8_t shiftByte(void);
         uint16_t shiftWord(void);
         uint32_t shiftDWord(void);
         bool shiftBool(void);
-        std::string shiftString(uint16_t lenght = 0);
+        std::string shiftString(size_t lenght = 0);
+        uint32_t shiftVarUInt(void);
+        int32_t shiftVarInt(void);
+        template<typename T>
+        size_t shiftDeltasInto(T dest[], size_t count, T base = 0);
 
-        std::string toHexString(uint16_t offset = 0);
-        std::string toAsciiString(uint16_t offset = 0);
+        std::string toHexString(size_t offset = 0);
+        std::string toAsciiString(size_t offset = 0);
 
     private:
+        uint8_t* grow(size_t count);
+        size_t valuesCount(size_t offset, size_t count, size_t valueSize);
+        bool decodeVarint(uint32_t& value);
+
     	std::vector<uint8_t>packetBuff;
-        uint16_t shiftIndex;
+        size_t shiftIndex;
+        DMPacketByteOrder byteOrder;
 
 };
 
+/**
+ * @brief Append a time series (integers up to 32 bit) as zigzag varints of the differences between consecutive
+ * values: slowly changing samples take 1-2 bytes each.
+ *
+ * @param values    ->  the series.
+ * @param count     ->  number of values.
+ * @param base      ->  value before the first one (i.e. the last value of the previous packet, or 0).
+ */
+template<typename T>
+void DMPacket::pushDeltas(const T values[], size_t count, T base)
+{
+    size_t ix=packetBuff.size();
+    size_t n=DMPacketVarint::encodeDeltas(grow(DMPacketVarint::deltasCapacity(count)),values,count,(uint32_t) base);
+    packetBuff.resize(ix+n);
+}
+
+/**
+ * @brief Shift a time series written by pushDeltas().
+ *
+ * @param dest  ->  destination.
+ * @param count ->  number of values.
+ * @param base  ->  value before the first one (the same used to push them).
+ * @return number of values decoded (less than count if the packet ends before).
+ */
+template<typename T>
+size_t DMPacket::shiftDeltasInto(T dest[], size_t count, T base)
+{
+    if (shiftIndex >= packetBuff.size()) {
+        return 0;
+    }
+    const uint8_t *p=packetBuff.data()+shiftIndex;
+    size_t avail=packetBuff.size()-shiftIndex;
+    size_t decoded=DMPacketVarint::decodeDeltas(p,avail,dest,count,(uint32_t) base);
+    shiftIndex=decoded < count ? packetBuff.size() : packetBuff.size()-avail;
+    return decoded;
+}
+
 #endif // DMPACKET_H
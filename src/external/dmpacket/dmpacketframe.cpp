@@ -0,0 +1,339 @@
+#include "dmpacketframe.h"
+#ifdef ARDUINO
+    #include "Arduino.h"
+#endif
+
+// ********************************************************************************************************
+// ********************************************** CRC *****************************************************
+// ********************************************************************************************************
+
+#ifdef ARDUINO
+// One nibble at a time: 32 + 64 bytes of flash instead of KBs of tables
+static const uint16_t CRC16_NIBBLE[16] PROGMEM = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+};
+
+static const uint32_t CRC32_NIBBLE[16] PROGMEM = {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+};
+
+uint16_t DMPacketCRC::crc16(const uint8_t *buff, size_t buffSize, uint16_t crc)
+{
+    for (size_t ixB=0; ixB<buffSize; ixB++) {
+        crc=(crc << 4) ^ pgm_read_word(&CRC16_NIBBLE[(crc >> 12) ^ (buff[ixB] >> 4)]);
+        crc=(crc << 4) ^ pgm_read_word(&CRC16_NIBBLE[(crc >> 12) ^ (buff[ixB] & 0x0F)]);
+    }
+    return crc;
+}
+
+uint32_t DMPacketCRC::crc32(const uint8_t *buff, size_t buffSize, uint32_t crc)
+{
+    crc=~crc;
+    for (size_t ixB=0; ixB<buffSize; ixB++) {
+        crc^=buff[ixB];
+        crc=(crc >> 4) ^ pgm_read_dword(&CRC32_NIBBLE[crc & 0x0F]);
+        crc=(crc >> 4) ^ pgm_read_dword(&CRC32_NIBBLE[crc & 0x0F]);
+    }
+    return ~crc;
+}
+#else
+// Slicing-by-8: table k holds the CRC of a byte followed by k zero bytes, so 8 bytes are folded with 8 lookups
+struct DCRCTables {
+    uint16_t crc16[8][256];
+    uint32_t crc32[8][256];
+};
+
+static constexpr DCRCTables makeCRCTables(void)
+{
+    DCRCTables t{};
+    for (uint32_t ixV=0; ixV<256; ixV++) {
+        uint16_t c16=(uint16_t) (ixV << 8);
+        uint32_t c32=ixV;
+        for (int ixBit=0; ixBit<8; ixBit++) {
+            c16=(c16 & 0x8000) ? (uint16_t) ((c16 << 1) ^ 0x1021) : (uint16_t) (c16 << 1);
+            c32=(c32 & 1) ? (c32 >> 1) ^ 0xEDB88320 : c32 >> 1;
+        }
+        t.crc16[0][ixV]=c16;
+        t.crc32[0][ixV]=c32;
+    }
+    for (int ixT=1; ixT<8; ixT++) {
+        for (uint32_t ixV=0; ixV<256; ixV++) {
+            uint16_t c16=t.crc16[ixT-1][ixV];
+            t.crc16[ixT][ixV]=(uint16_t) ((c16 << 8) ^ t.crc16[0][c16 >> 8]);
+            uint32_t c32=t.crc32[ixT-1][ixV];
+            t.crc32[ixT][ixV]=(c32 >> 8) ^ t.crc32[0][c32 & 0xFF];
+        }
+    }
+    return t;
+}
+
+static constexpr DCRCTables CRC_TABLES=makeCRCTables();
+
+uint16_t DMPacketCRC::crc16(const uint8_t *buff, size_t buffSize, uint16_t crc)
+{
+    const auto& t=CRC_TABLES.crc16;
+    while (buffSize >= 8) {
+        crc^=(uint16_t) ((buff[0] << 8) | buff[1]);
+        crc=t[7][crc >> 8] ^ t[6][crc & 0xFF] ^ t[5][buff[2]] ^ t[4][buff[3]] ^
+            t[3][buff[4]] ^ t[2][buff[5]] ^ t[1][buff[6]] ^ t[0][buff[7]];
+        buff+=8;
+        buffSize-=8;
+    }
+    while (buffSize-- > 0) {
+        crc=(uint16_t) ((crc << 8) ^ t[0][(crc >> 8) ^ *buff++]);
+    }
+    return crc;
+}
+
+uint32_t DMPacketCRC::crc32(const uint8_t *buff, size_t buffSize, uint32_t crc)
+{
+    const auto& t=CRC_TABLES.crc32;
+    crc=~crc;
+    while (buffSize >= 8) {
+        uint32_t lo=crc ^ ((uint32_t) buff[0] | ((uint32_t) buff[1] << 8) | ((uint32_t) buff[2] << 16) | ((uint32_t) buff[3] << 24));
+        crc=t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^ t[5][(lo >> 16) & 0xFF] ^ t[4][lo >> 24] ^
+            t[3][buff[4]] ^ t[2][buff[5]] ^ t[1][buff[6]] ^ t[0][buff[7]];
+        buff+=8;
+        buffSize-=8;
+    }
+    while (buffSize-- > 0) {
+        crc=(crc >> 8) ^ t[0][(crc ^ *buff++) & 0xFF];
+    }
+    return ~crc;
+}
+#endif
+
+// ********************************************************************************************************
+// ******************************************** Encoding **************************************************
+// ********************************************************************************************************
+
+namespace {
+    // COBS: each block is a code byte (distance to the next 0x00, 0xFF = 254 data bytes and no 0x00) and its data
+    class DCOBSEncoder {
+        public:
+            DCOBSEncoder(uint8_t *out) : out(out+1), codePtr(out), code(1) {}
+
+            void put(const uint8_t *buff, size_t buffSize) {
+                for (size_t ixB=0; ixB<buffSize; ixB++) {
+                    if (buff[ixB] == 0) {
+                        endBlock();
+                    }
+                    else {
+                        *out++=buff[ixB];
+                        if (++code == 0xFF) {
+                            endBlock();
+                        }
+                    }
+                }
+            }
+            //! Close the last block and add the delimiter: @return the end of the frame.
+            uint8_t* finish(void) {
+                *codePtr=code;
+                *out++=0x00;
+                return out;
+            }
+
+        private:
+            void endBlock(void) {
+                *codePtr=code;
+                codePtr=out++;
+                code=1;
+            }
+
+            uint8_t *out;
+            uint8_t *codePtr;
+            uint8_t code;
+    };
+}
+
+/**
+ * @brief Encode a frame.
+ *
+ * @param payload       ->  data to send.
+ * @param payloadSize   ->  size of data.
+ * @param frame         ->  destination.
+ * @param frameCapacity ->  size of destination (at least maxFrameSize(payloadSize, crc)).
+ * @param crc           ->  CRC appended to the payload.
+ * @return the size of the frame (delimiter included), 0 if frameCapacity is too small.
+ */
+size_t DMPacketFrame::encode(const uint8_t *payload, size_t payloadSize, uint8_t *frame, size_t frameCapacity, CRCType crc)
+{
+    if (frameCapacity < maxFrameSize(payloadSize,crc)) {
+        return 0;
+    }
+    uint8_t crcBytes[4];
+    if (crc == CRC_16) {
+        DMPacketBE::store16(crcBytes,DMPacketCRC::crc16(payload,payloadSize));
+    }
+    else if (crc == CRC_32) {
+        DMPacketBE::store32(crcBytes,DMPacketCRC::crc32(payload,payloadSize));
+    }
+    DCOBSEncoder encoder(frame);
+    encoder.put(payload,payloadSize);
+    encoder.put(crcBytes,crcSize(crc));
+    return encoder.finish()-frame;
+}
+
+/**
+ * @brief Encode a frame at the end of a writer.
+ *
+ * @return false if it does not fit (writer.overflow() is set).
+ */
+bool DMPacketFrame::encode(const uint8_t *payload, size_t payloadSize, DMPacketWriter& writer, CRCType crc)
+{
+    size_t frameSize=encode(payload,payloadSize,writer.data()+writer.size(),writer.available(),crc);
+    if (frameSize == 0) {
+        writer.pushSpace(writer.available()+1);     // set the overflow flag
+        return false;
+    }
+    writer.pushSpace(frameSize);
+    return true;
+}
+
+// ********************************************************************************************************
+// ******************************************** Decoding **************************************************
+// ********************************************************************************************************
+
+/**
+ * @param buff      ->  frame buffer (the largest payload plus the CRC).
+ * @param capacity  ->  size of buffer.
+ * @param crc       ->  CRC of frames.
+ */
+DMPacketFrameDecoder::DMPacketFrameDecoder(uint8_t *buff, size_t capacity, DMPacketFrame::CRCType crc) : buff(buff), capacity(capacity), crc(crc)
+{
+    frameSize=0;
+    framesCount=0;
+    crcErrors=0;
+    framingErrors=0;
+    overflows=0;
+    reset();
+}
+
+//! Drop the frame being received (the next one is decoded after a delimiter).
+void DMPacketFrameDecoder::reset(void)
+{
+    size=0;
+    blockLeft=0;
+    zeroPending=false;
+    started=false;
+    discarding=false;
+}
+
+/**
+ * @brief Decode received bytes up to the end of the next valid frame.
+ *
+ * @param data      ->  received bytes, advanced past the bytes consumed.
+ * @param dataSize  ->  number of received bytes, decreased by the bytes consumed.
+ * @return true if a frame is ready (get it by frame()), false if all bytes were consumed without completing one.
+ */
+bool DMPacketFrameDecoder::decode(const uint8_t*& data, size_t& dataSize)
+{
+    // State in locals: stores through buff (uint8_t*) could alias the members
+    const uint8_t *p=data;
+    const uint8_t *end=data+dataSize;
+    size_t n=size;
+    uint8_t left=blockLeft;
+    bool zero=zeroPending;
+    bool skip=discarding;
+    bool any=started;
+    bool ready=false;
+
+    while (p != end) {
+        uint8_t b=*p++;
+        if (b == 0x00) {
+            size=n;
+            blockLeft=left;
+            started=any;
+            discarding=skip;
+            ready=endFrame();
+            n=0;
+            left=0;
+            zero=false;
+            skip=false;
+            any=false;
+            if (ready) {
+                break;
+            }
+            continue;
+        }
+        any=true;
+        if (skip) {
+            continue;
+        }
+        if (left == 0) {
+            // Code byte
+            if (zero) {
+                if (n == capacity) {
+                    skip=true;
+                    continue;
+                }
+                buff[n++]=0x00;
+            }
+            left=b-1;
+            zero=(b != 0xFF);
+        }
+        else {
+            if (n == capacity) {
+                skip=true;
+                continue;
+            }
+            buff[n++]=b;
+            left--;
+        }
+    }
+
+    if (!ready) {
+        size=n;
+        blockLeft=left;
+        zeroPending=zero;
+        discarding=skip;
+        started=any;
+    }
+    dataSize-=p-data;
+    data=p;
+    return ready;
+}
+
+/**
+ * @brief Check the frame just ended by a delimiter.
+ */
+bool DMPacketFrameDecoder::endFrame(void)
+{
+    bool ok=false;
+    size_t crcBytes=DMPacketFrame::crcSize(crc);
+    if (!started) {
+        // Consecutive delimiters: nothing to decode
+    }
+    else if (discarding) {
+        overflows++;
+    }
+    else if (blockLeft != 0) {
+        framingErrors++;
+    }
+    else if (size < crcBytes) {
+        crcErrors++;
+    }
+    else {
+        size_t payloadSize=size-crcBytes;
+        if (crc == DMPacketFrame::CRC_16) {
+            ok=DMPacketCRC::crc16(buff,payloadSize) == DMPacketBE::load16(buff+payloadSize);
+        }
+        else if (crc == DMPacketFrame::CRC_32) {
+            ok=DMPacketCRC::crc32(buff,payloadSize) == DMPacketBE::load32(buff+payloadSize);
+        }
+        else {
+            ok=true;
+        }
+        if (ok) {
+            frameSize=payloadSize;
+            framesCount++;
+        }
+        else {
+            crcErrors++;
+        }
+    }
+    reset();
+    return ok;
+}
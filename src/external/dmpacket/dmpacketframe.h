@@ -0,0 +1,107 @@
+#ifndef DMPACKETFRAME_H
+#define DMPACKETFRAME_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "dmpacketview.h"
+
+/**
+ * Framing for byte streams (UART, I2C bursts, sockets): the payload and its CRC are COBS encoded, so they contain no
+ * 0x00 byte, and a 0x00 ends the frame. After noise or a lost byte the receiver resyncs at the next 0x00: only the
+ * damaged frame is lost (and detected by the CRC), no need to reset both ends.
+ *
+ * Frame: COBS(payload + CRC big endian) + 0x00, at most maxFrameSize() bytes.
+ *
+ * @code
+ * uint8_t frame[DMPacketFrame::maxFrameSize(sizeof(payload), DMPacketFrame::CRC_16)];
+ * size_t frameSize=DMPacketFrame::encode(payload, payloadSize, frame, sizeof(frame));
+ * uart.write(frame, frameSize);
+ *
+ * static uint8_t rxFrame[256];
+ * DMPacketFrameDecoder decoder(rxFrame);
+ * const uint8_t *chunk=rx;              // any number of bytes, frames can span chunks
+ * size_t chunkSize=received;
+ * while (decoder.decode(chunk, chunkSize)) {
+ *     DMPacketView packet=decoder.frame();
+ *     ...
+ * }
+ * @endcode
+ */
+
+//! CRC-16/CCITT-FALSE and CRC-32 (IEEE 802.3, zlib): slicing-by-8 tables on Linux, 16 entries tables on Arduino.
+struct DMPacketCRC {
+    /**
+     * @brief CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF): "123456789" -> 0x29B1.
+     * @param crc   ->  previous result to continue over more buffers.
+     */
+    static uint16_t crc16(const uint8_t *buff, size_t buffSize, uint16_t crc = 0xFFFF);
+    /**
+     * @brief CRC-32 (poly 0x04C11DB7 reflected, init and final xor 0xFFFFFFFF): "123456789" -> 0xCBF43926.
+     * @param crc   ->  previous result to continue over more buffers.
+     */
+    static uint32_t crc32(const uint8_t *buff, size_t buffSize, uint32_t crc = 0);
+};
+
+//! Frame encoding.
+struct DMPacketFrame {
+    enum CRCType : uint8_t {
+        CRC_NONE = 0,
+        CRC_16 = 2,
+        CRC_32 = 4
+    };
+
+    //! @return bytes of the CRC.
+    static constexpr size_t crcSize(CRCType crc) { return (size_t) crc; }
+    //! @return the largest frame of a payload (COBS adds a byte every 254, plus the first one and the delimiter).
+    static constexpr size_t maxFrameSize(size_t payloadSize, CRCType crc = CRC_16) {
+        return payloadSize + crcSize(crc) + (payloadSize + crcSize(crc)) / 254 + 2;
+    }
+
+    static size_t encode(const uint8_t *payload, size_t payloadSize, uint8_t *frame, size_t frameCapacity, CRCType crc = CRC_16);
+    static bool encode(const uint8_t *payload, size_t payloadSize, DMPacketWriter& writer, CRCType crc = CRC_16);
+};
+
+/**
+ * Incremental frame decoder: feed it byte chunks of any size, it returns each complete frame with a valid CRC as a
+ * view of its buffer. Damaged frames (CRC or COBS error, longer than the buffer) are counted and skipped.
+ */
+class DMPacketFrameDecoder {
+    public:
+        DMPacketFrameDecoder(uint8_t *buff, size_t capacity, DMPacketFrame::CRCType crc = DMPacketFrame::CRC_16);
+        template<size_t N>
+        DMPacketFrameDecoder(uint8_t (&buff)[N], DMPacketFrame::CRCType crc = DMPacketFrame::CRC_16) : DMPacketFrameDecoder(buff, N, crc) {}
+
+        bool decode(const uint8_t*& data, size_t& dataSize);
+        //! @return the payload of the last frame decoded (valid until the next decode()).
+        DMPacketView frame(void) const { return DMPacketView(buff,frameSize); }
+        void reset(void);
+
+        //! @return frames decoded.
+        uint32_t getFramesCount(void) const { return framesCount; }
+        //! @return frames dropped for a wrong CRC (or shorter than the CRC).
+        uint32_t getCRCErrorsCount(void) const { return crcErrors; }
+        //! @return frames dropped for a COBS error (truncated block).
+        uint32_t getFramingErrorsCount(void) const { return framingErrors; }
+        //! @return frames dropped because longer than the buffer.
+        uint32_t getOverflowsCount(void) const { return overflows; }
+
+    private:
+        bool endFrame(void);
+
+        uint8_t *buff;
+        size_t capacity;
+        size_t size;            // decoded bytes of the current frame
+        size_t frameSize;       // payload size of the last frame
+        DMPacketFrame::CRCType crc;
+        uint8_t blockLeft;      // data bytes left in the current COBS block
+        bool zeroPending;       // the current block ends with an implicit 0x00
+        bool started;           // at least a byte of the current frame received
+        bool discarding;        // current frame overflowed, skip up to the delimiter
+
+        uint32_t framesCount;
+        uint32_t crcErrors;
+        uint32_t framingErrors;
+        uint32_t overflows;
+};
+
+#endif // DMPACKETFRAME_H
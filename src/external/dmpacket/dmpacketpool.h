@@ -0,0 +1,225 @@
+#ifndef DMPACKETPOOL_H
+#define DMPACKETPOOL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "dmpacketview.h"
+#ifdef ARDUINO
+    #include "Arduino.h"
+#else
+    #include <atomic>
+#endif
+
+/**
+ * Pool of packet buffers: a fixed number of fixed size slabs, allocated once with the pool (no heap at all, declare
+ * the pool static), handed out as move-only DMPooledPacket handles that give their slab back when destroyed.
+ * A 1 kHz message loop then builds and parses packets without any malloc/free.
+ *
+ * acquire() and release are thread-safe (lock-free tagged free list on Linux, interrupts disabled on Arduino): a
+ * producer thread can acquire and fill packets, and a consumer thread drop them after sending.
+ *
+ * @code
+ * static DMPacketPool<256, 16> pool;     // 16 packets of 256 bytes
+ * DMPooledPacket packet=pool.acquire();
+ * if (packet) {
+ *     packet->pushByte(CMD_TELEMETRY);
+ *     packet->pushFloat(voltage);
+ *     send(packet.data(), packet.size());
+ * }   // slab back to pool
+ * @endcode
+ */
+
+class DMPacketPoolBase;
+
+//! A packet buffer of a pool (move-only): pushes/writes through -> (DMPacketWriter), reads through view().
+class DMPooledPacket {
+    public:
+        DMPooledPacket() : pool(nullptr), slab(0), writer(nullptr,0) {}
+        DMPooledPacket(DMPooledPacket&& other) : pool(other.pool), slab(other.slab), writer(other.writer) {
+            other.pool=nullptr;
+        }
+        DMPooledPacket& operator=(DMPooledPacket&& other) {
+            if (this != &other) {
+                release();
+                pool=other.pool;
+                slab=other.slab;
+                writer=other.writer;
+                other.pool=nullptr;
+            }
+            return *this;
+        }
+        DMPooledPacket(const DMPooledPacket&) = delete;
+        DMPooledPacket& operator=(const DMPooledPacket&) = delete;
+        ~DMPooledPacket() { release(); }
+
+        //! @return false if the pool was exhausted (or the packet has been released/moved).
+        bool valid(void) const { return pool != nullptr; }
+        explicit operator bool(void) const { return valid(); }
+        inline void release(void);
+
+        DMPacketWriter* operator->() { return &writer; }
+        DMPacketWriter& packet(void) { return writer; }
+        DMPacketView view(void) const { return writer.view(); }
+        uint8_t* data(void) { return writer.data(); }
+        size_t size(void) const { return writer.size(); }
+        size_t capacity(void) const { return writer.capacity(); }
+        //! Restart from an empty packet (the slab is kept).
+        void clear(void) { writer.clear(); }
+
+    private:
+        friend class DMPacketPoolBase;
+        DMPooledPacket(DMPacketPoolBase *pool, uint16_t slab, uint8_t *buff, size_t capacity) : pool(pool), slab(slab), writer(buff,capacity) {}
+
+        DMPacketPoolBase *pool;
+        uint16_t slab;
+        DMPacketWriter writer;
+};
+
+//! Slabs bookkeeping of DMPacketPool (use DMPacketPool).
+class DMPacketPoolBase {
+    public:
+        static constexpr uint16_t NO_SLAB = 0xFFFF;
+
+        /**
+         * @brief Get a free packet.
+         * @return the packet, not valid() if all slabs are in use.
+         */
+        DMPooledPacket acquire(void) {
+            uint16_t ix=pop();
+            if (ix == NO_SLAB) {
+                return DMPooledPacket();
+            }
+            return DMPooledPacket(this,ix,storage+(size_t) ix*slabSize,slabSize);
+        }
+
+        size_t getSlabSize(void) const { return slabSize; }
+        size_t getSlabsCount(void) const { return slabsCount; }
+        //! @return slabs currently free.
+        size_t getFreeCount(void) const {
+            #ifdef ARDUINO
+                return freeCount;
+            #else
+                return freeCount.load(std::memory_order_relaxed);
+            #endif
+        }
+
+    protected:
+        DMPacketPoolBase() : storage(nullptr), slabSize(0), slabsCount(0) {}
+
+        #ifdef ARDUINO
+            typedef uint16_t NextIndex;
+        #else
+            typedef std::atomic<uint16_t> NextIndex;
+        #endif
+
+        void init(uint8_t *storage, NextIndex *next, size_t slabSize, uint16_t slabsCount) {
+            this->storage=storage;
+            this->next=next;
+            this->slabSize=slabSize;
+            this->slabsCount=slabsCount;
+            // Free list: 0 -> 1 -> ... -> N-1
+            for (uint16_t ixS=0; ixS<slabsCount; ixS++) {
+                next[ixS]=ixS+1 < slabsCount ? ixS+1 : NO_SLAB;
+            }
+            #ifdef ARDUINO
+                head=slabsCount > 0 ? 0 : NO_SLAB;
+                freeCount=slabsCount;
+            #else
+                head.store(slabsCount > 0 ? 0 : NO_SLAB);
+                freeCount.store(slabsCount);
+            #endif
+        }
+
+    private:
+        friend class DMPooledPacket;
+
+        #ifdef ARDUINO
+            uint16_t pop(void) {
+                noInterrupts();
+                uint16_t ix=head;
+                if (ix != NO_SLAB) {
+                    head=next[ix];
+                    freeCount--;
+                }
+                interrupts();
+                return ix;
+            }
+            void push(uint16_t ix) {
+                noInterrupts();
+                next[ix]=head;
+                head=ix;
+                freeCount++;
+                interrupts();
+            }
+        #else
+            // Head is (tag << 16 | index): the tag changes at each update, so a CAS can't succeed on a head that was
+            // popped and pushed back meanwhile (ABA)
+            uint16_t pop(void) {
+                uint32_t old=head.load(std::memory_order_acquire);
+                while (true) {
+                    uint16_t ix=old & 0xFFFF;
+                    if (ix == NO_SLAB) {
+                        return NO_SLAB;
+                    }
+                    uint32_t desired=((old + 0x10000) & 0xFFFF0000) | next[ix].load(std::memory_order_relaxed);
+                    if (head.compare_exchange_weak(old,desired,std::memory_order_acquire,std::memory_order_acquire)) {
+                        freeCount.fetch_sub(1,std::memory_order_relaxed);
+                        return ix;
+                    }
+                }
+            }
+            void push(uint16_t ix) {
+                uint32_t old=head.load(std::memory_order_relaxed);
+                while (true) {
+                    next[ix].store(old & 0xFFFF,std::memory_order_relaxed);
+                    uint32_t desired=((old + 0x10000) & 0xFFFF0000) | ix;
+                    if (head.compare_exchange_weak(old,desired,std::memory_order_release,std::memory_order_relaxed)) {
+                        freeCount.fetch_add(1,std::memory_order_relaxed);
+                        return;
+                    }
+                }
+            }
+        #endif
+
+        uint8_t *storage;
+        NextIndex *next;
+        size_t slabSize;
+        uint16_t slabsCount;
+        #ifdef ARDUINO
+            volatile uint16_t head;
+            volatile uint16_t freeCount;
+        #else
+            std::atomic<uint32_t> head{NO_SLAB};
+            std::atomic<size_t> freeCount{0};
+        #endif
+};
+
+/**
+ * @brief Pool of SlabsCount packets of SlabSize bytes (storage inside the object).
+ */
+template<size_t SlabSize, uint16_t SlabsCount>
+class DMPacketPool : public DMPacketPoolBase {
+    static_assert(SlabsCount < NO_SLAB, "too many slabs");
+
+    public:
+        DMPacketPool() {
+            init(slabs[0],nextSlab,SlabSize,SlabsCount);
+        }
+        DMPacketPool(const DMPacketPool&) = delete;
+        DMPacketPool& operator=(const DMPacketPool&) = delete;
+
+    private:
+        alignas(4) uint8_t slabs[SlabsCount][SlabSize];
+        NextIndex nextSlab[SlabsCount];   // free list links
+};
+
+//! Give the slab back to the pool (the packet becomes not valid).
+inline void DMPooledPacket::release(void)
+{
+    if (pool != nullptr) {
+        pool->push(slab);
+        pool=nullptr;
+    }
+}
+
+#endif // DMPACKETPOOL_H
@@ -0,0 +1,152 @@
+#ifndef DMPACKETROUTER_H
+#define DMPACKETROUTER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "dmpacketview.h"
+
+/**
+ * Command dispatch: the command byte of a request (the first byte, or a header field at a fixed offset) indexes a
+ * flat table of handlers, one load and an indirect call whatever the number of commands, instead of if/else chains
+ * in the application. Handlers get a view of the payload (positioned after the command byte) and a writer for the
+ * reply over a buffer reused for every request. No heap: the table lives in the router (2 bytes per command on AVR,
+ * use DMPacketRouter<N> for commands below N on small boards), and a router declared static is constant-initialized.
+ *
+ * Typed handlers receive the request already unpacked by a DMPacketSchema (and fill a reply struct packed by another
+ * one): a payload shorter than the schema is rejected before the handler runs.
+ *
+ * @code
+ * static bool onSetLed(DMPacketView& request, DMPacketWriter& reply, void *context) {
+ *     digitalWrite(LED_BUILTIN, request.shiftBool());
+ *     return true;                                 // no reply
+ * }
+ * static bool onReadConfig(const ConfigRequest& request, Config& reply, void *context) { ... }
+ *
+ * static DMPacketRouter<> router;
+ * router.on(CMD_SET_LED, onSetLed);
+ * router.onRequest<ConfigRequestSchema, ConfigSchema, onReadConfig>(CMD_READ_CONFIG);
+ *
+ * static uint8_t replyBuff[64];
+ * DMPacketWriter reply(replyBuff);
+ * if (router.dispatch(rx, rxSize, reply) == DMPACKET_DISPATCH_OK && reply.size() > 0) {
+ *     send(reply.data(), reply.size());
+ * }
+ * @endcode
+ */
+
+//! Result of DMPacketRouter::dispatch().
+enum DMPacketDispatch : uint8_t {
+    DMPACKET_DISPATCH_OK = 0,           // handled, the reply is in the writer (empty if the command has none)
+    DMPACKET_DISPATCH_UNKNOWN,          // no handler for the command, or no command byte in the request
+    DMPACKET_DISPATCH_MALFORMED,        // the handler returned false or read past the end of the request
+    DMPACKET_DISPATCH_REPLY_OVERFLOW    // the reply did not fit the reply buffer
+};
+
+/**
+ * @brief Handler of a command.
+ *
+ * @param request   ->  the request, shift index after the command byte (the header is still readable by offset).
+ * @param reply     ->  empty reply, in the byte order of the writer passed to dispatch().
+ * @param context   ->  context of the router.
+ * @return false to reject the request (DMPACKET_DISPATCH_MALFORMED).
+ */
+typedef bool (*DMPacketHandler)(DMPacketView& request, DMPacketWriter& reply, void *context);
+
+template<size_t Commands = 256>
+class DMPacketRouter {
+    static_assert(Commands > 0 && Commands <= 256, "commands are 1 byte");
+
+    public:
+        /**
+         * @param commandOffset ->  offset of the command byte in requests (after a header, if any).
+         * @param context       ->  passed to every handler.
+         */
+        constexpr DMPacketRouter(size_t commandOffset = 0, void *context = nullptr) : handlers(), fallback(nullptr), commandOffset(commandOffset), context(context) {}
+
+        //! Set the handler of a command (nullptr to remove it), commands not below Commands are ignored.
+        void on(uint8_t command, DMPacketHandler handler) {
+            if (command < Commands) {
+                handlers[command]=handler;
+            }
+        }
+        /**
+         * @brief Set a handler of a request unpacked by a schema.
+         *
+         * @tparam Schema   ->  DMPacketSchema of the payload.
+         * @tparam Handler  ->  bool handler(const Schema::Type& request, DMPacketWriter& reply, void *context).
+         */
+        template<typename Schema, bool (*Handler)(const typename Schema::Type&, DMPacketWriter&, void*)>
+        void onMessage(uint8_t command) { on(command,&messageThunk<Schema,Handler>); }
+        /**
+         * @brief Set a handler of a request and reply both packed by schemas.
+         *
+         * @tparam RequestSchema    ->  DMPacketSchema of the payload.
+         * @tparam ReplySchema      ->  DMPacketSchema of the reply (packed only if the handler returns true).
+         * @tparam Handler          ->  bool handler(const RequestSchema::Type& request, ReplySchema::Type& reply, void *context).
+         */
+        template<typename RequestSchema, typename ReplySchema, bool (*Handler)(const typename RequestSchema::Type&, typename ReplySchema::Type&, void*)>
+        void onRequest(uint8_t command) { on(command,&requestThunk<RequestSchema,ReplySchema,Handler>); }
+        //! Handler of commands without one (nullptr: DMPACKET_DISPATCH_UNKNOWN), it can read the command by offset.
+        void onUnknown(DMPacketHandler handler) { fallback=handler; }
+
+        //! @return the handler of a command (nullptr if none).
+        DMPacketHandler handler(uint8_t command) const { return command < Commands ? handlers[command] : nullptr; }
+        size_t getCommandOffset(void) const { return commandOffset; }
+        void setContext(void *context) { this->context=context; }
+
+        /**
+         * @brief Run the handler of a request.
+         *
+         * @param request   ->  the whole request (header included).
+         * @param reply     ->  writer of the reply, cleared first.
+         * @return DMPACKET_DISPATCH_OK if handled, the reason otherwise (reply is then to be ignored).
+         */
+        DMPacketDispatch dispatch(DMPacketView request, DMPacketWriter& reply) const {
+            reply.clear();
+            if (request.size() <= commandOffset) {
+                return DMPACKET_DISPATCH_UNKNOWN;
+            }
+            uint8_t command=request.data()[commandOffset];
+            DMPacketHandler run=command < Commands ? handlers[command] : nullptr;
+            if (run == nullptr) {
+                run=fallback;
+                if (run == nullptr) {
+                    return DMPACKET_DISPATCH_UNKNOWN;
+                }
+            }
+            request.rewind(commandOffset+1);
+            bool ok=run(request,reply,context);
+            if (reply.overflow()) {
+                return DMPACKET_DISPATCH_REPLY_OVERFLOW;
+            }
+            return ok && !request.overflow() ? DMPACKET_DISPATCH_OK : DMPACKET_DISPATCH_MALFORMED;
+        }
+        //! Run the handler of a request in the byte order of the reply.
+        DMPacketDispatch dispatch(const uint8_t *request, size_t requestSize, DMPacketWriter& reply) const {
+            return dispatch(DMPacketView(request,requestSize,reply.getByteOrder()),reply);
+        }
+
+    private:
+        template<typename Schema, bool (*Handler)(const typename Schema::Type&, DMPacketWriter&, void*)>
+        static bool messageThunk(DMPacketView& request, DMPacketWriter& reply, void *context) {
+            typename Schema::Type message;
+            return Schema::unpack(request,message) && Handler(message,reply,context);
+        }
+        template<typename RequestSchema, typename ReplySchema, bool (*Handler)(const typename RequestSchema::Type&, typename ReplySchema::Type&, void*)>
+        static bool requestThunk(DMPacketView& request, DMPacketWriter& reply, void *context) {
+            typename RequestSchema::Type message;
+            typename ReplySchema::Type answer;
+            if (!RequestSchema::unpack(request,message) || !Handler(message,answer,context)) {
+                return false;
+            }
+            ReplySchema::pack(reply,answer);
+            return true;
+        }
+
+        DMPacketHandler handlers[Commands];
+        DMPacketHandler fallback;
+        size_t commandOffset;
+        void *context;
+};
+
+#endif // DMPACKETROUTER_H
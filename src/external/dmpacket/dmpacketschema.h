@@ -0,0 +1,243 @@
+#ifndef DMPACKETSCHEMA_H
+#define DMPACKETSCHEMA_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "dmpacketview.h"
+
+/**
+ * Compile-time message schemas: the fields of a struct are listed once, and the schema packs/unpacks the whole struct
+ * in the DMPacket wire format (fields one after the other, no padding, in the byte order of the packet). The size of
+ * the message is a compile-time constant, bounds are checked once for the whole message, and fields are stored/loaded
+ * at constant offsets (straight-line code, no per-field checks or size updates).
+ *
+ * Field types: uint8_t, int8_t, bool, uint16_t, int16_t, uint32_t, int32_t, float and fixed size arrays of them.
+ *
+ * @code
+ * struct Telemetry {
+ *     uint8_t cmd;
+ *     uint16_t seq;
+ *     float voltage;
+ *     int16_t temps[4];
+ * };
+ * typedef DMPacketSchema<Telemetry,
+ *     DMPACKET_FIELD(Telemetry, cmd),
+ *     DMPACKET_FIELD(Telemetry, seq),
+ *     DMPACKET_FIELD(Telemetry, voltage),
+ *     DMPACKET_FIELD(Telemetry, temps)> TelemetrySchema;
+ *
+ * static_assert(TelemetrySchema::SIZE == 15, "wire size");
+ * TelemetrySchema::pack(packet, telemetry);        // DMPacket, DMPacketWriter or DMPooledPacket::packet()
+ * DMPacketView view(rx, rxSize);
+ * if (TelemetrySchema::unpack(view, telemetry)) { ... }
+ * @endcode
+ */
+
+//! Wire encoding of a field type (DMPacket format).
+template<typename T>
+struct DMPacketCodec;
+
+template<>
+struct DMPacketCodec<uint8_t> {
+    static constexpr size_t SIZE = 1;
+    template<typename Endian>
+    static inline void store(uint8_t *p, uint8_t v) { p[0]=v; }
+    template<typename Endian>
+    static inline void load(const uint8_t *p, uint8_t& v) { v=p[0]; }
+};
+
+template<>
+struct DMPacketCodec<int8_t> {
+    static constexpr size_t SIZE = 1;
+    template<typename Endian>
+    static inline void store(uint8_t *p, int8_t v) { p[0]=(uint8_t) v; }
+    template<typename Endian>
+    static inline void load(const uint8_t *p, int8_t& v) { v=(int8_t) p[0]; }
+};
+
+template<>
+struct DMPacketCodec<bool> {
+    static constexpr size_t SIZE = 1;
+    template<typename Endian>
+    static inline void store(uint8_t *p, bool v) { p[0]=v ? 0x01 : 0x00; }
+    template<typename Endian>
+    static inline void load(const uint8_t *p, bool& v) { v=p[0] != 0; }
+};
+
+template<>
+struct DMPacketCodec<uint16_t> {
+    static constexpr size_t SIZE = 2;
+    template<typename Endian>
+    static inline void store(uint8_t *p, uint16_t v) { Endian::store16(p,v); }
+    template<typename Endian>
+    static inline void load(const uint8_t *p, uint16_t& v) { v=Endian::load16(p); }
+};
+
+template<>
+struct DMPacketCodec<int16_t> {
+    static constexpr size_t SIZE = 2;
+    template<typename Endian>
+    static inline void store(uint8_t *p, int16_t v) { Endian::store16(p,(uint16_t) v); }
+    template<typename Endian>
+    static inline void load(const uint8_t *p, int16_t& v) { v=(int16_t) Endian::load16(p); }
+};
+
+template<>
+struct DMPacketCodec<uint32_t> {
+    static constexpr size_t SIZE = 4;
+    template<typename Endian>
+    static inline void store(uint8_t *p, uint32_t v) { Endian::store32(p,v); }
+    template<typename Endian>
+    static inline void load(const uint8_t *p, uint32_t& v) { v=Endian::load32(p); }
+};
+
+template<>
+struct DMPacketCodec<int32_t> {
+    static constexpr size_t SIZE = 4;
+    template<typename Endian>
+    static inline void store(uint8_t *p, int32_t v) { Endian::store32(p,(uint32_t) v); }
+    template<typename Endian>
+    static inline void load(const uint8_t *p, int32_t& v) { v=(int32_t) Endian::load32(p); }
+};
+
+template<>
+struct DMPacketCodec<float> {
+    static constexpr size_t SIZE = 4;
+    template<typename Endian>
+    static inline void store(uint8_t *p, float v) { Endian::store32(p,DMPacketBE::fromFloat(v)); }
+    template<typename Endian>
+    static inline void load(const uint8_t *p, float& v) { v=DMPacketBE::toFloat(Endian::load32(p)); }
+};
+
+//! Fixed size arrays: elements one after the other.
+template<typename T, size_t N>
+struct DMPacketCodec<T[N]> {
+    static constexpr size_t SIZE = DMPacketCodec<T>::SIZE * N;
+    template<typename Endian>
+    static inline void store(uint8_t *p, const T (&v)[N]) {
+        for (size_t ixE=0; ixE<N; ixE++) {
+            DMPacketCodec<T>::template store<Endian>(p+ixE*DMPacketCodec<T>::SIZE,v[ixE]);
+        }
+    }
+    template<typename Endian>
+    static inline void load(const uint8_t *p, T (&v)[N]) {
+        for (size_t ixE=0; ixE<N; ixE++) {
+            DMPacketCodec<T>::template load<Endian>(p+ixE*DMPacketCodec<T>::SIZE,v[ixE]);
+        }
+    }
+};
+
+//! A member of a struct in a schema (use DMPACKET_FIELD()).
+template<typename Struct, typename T, T Struct::*Member>
+struct DMPacketField {
+    static constexpr size_t SIZE = DMPacketCodec<T>::SIZE;
+    template<typename Endian>
+    static inline void store(uint8_t *p, const Struct& s) { DMPacketCodec<T>::template store<Endian>(p,s.*Member); }
+    template<typename Endian>
+    static inline void load(const uint8_t *p, Struct& s) { DMPacketCodec<T>::template load<Endian>(p,s.*Member); }
+};
+
+#define DMPACKET_FIELD(Struct, member) DMPacketField<Struct, decltype(Struct::member), &Struct::member>
+
+//! Fields at constant offsets (recursion unrolled by the compiler).
+template<typename... Fields>
+struct DMPacketFields;
+
+template<>
+struct DMPacketFields<> {
+    static constexpr size_t SIZE = 0;
+    template<typename Endian, typename Struct>
+    static inline void store(uint8_t *, const Struct&) {}
+    template<typename Endian, typename Struct>
+    static inline void load(const uint8_t *, Struct&) {}
+};
+
+template<typename Field, typename... Rest>
+struct DMPacketFields<Field, Rest...> {
+    static constexpr size_t SIZE = Field::SIZE + DMPacketFields<Rest...>::SIZE;
+    template<typename Endian, typename Struct>
+    static inline void store(uint8_t *p, const Struct& s) {
+        Field::template store<Endian>(p,s);
+        DMPacketFields<Rest...>::template store<Endian>(p+Field::SIZE,s);
+    }
+    template<typename Endian, typename Struct>
+    static inline void load(const uint8_t *p, Struct& s) {
+        Field::template load<Endian>(p,s);
+        DMPacketFields<Rest...>::template load<Endian>(p+Field::SIZE,s);
+    }
+};
+
+template<typename Struct, typename... Fields>
+class DMPacketSchema {
+    public:
+        typedef Struct Type;
+        //! Bytes of a message on the wire.
+        static constexpr size_t SIZE = DMPacketFields<Fields...>::SIZE;
+
+        //! Store the fields into buff (at least SIZE bytes, not checked).
+        static inline void store(uint8_t *buff, const Struct& s, DMPacketByteOrder byteOrder = DMPACKET_BIG_ENDIAN) {
+            if (byteOrder == DMPACKET_LITTLE_ENDIAN) {
+                DMPacketFields<Fields...>::template store<DMPacketLE>(buff,s);
+            }
+            else {
+                DMPacketFields<Fields...>::template store<DMPacketBE>(buff,s);
+            }
+        }
+        //! Load the fields from buff (at least SIZE bytes, not checked).
+        static inline void load(const uint8_t *buff, Struct& s, DMPacketByteOrder byteOrder = DMPACKET_BIG_ENDIAN) {
+            if (byteOrder == DMPACKET_LITTLE_ENDIAN) {
+                DMPacketFields<Fields...>::template load<DMPacketLE>(buff,s);
+            }
+            else {
+                DMPacketFields<Fields...>::template load<DMPacketBE>(buff,s);
+            }
+        }
+
+        /**
+         * @brief Append the message to a packet (one size check/grow for all fields), in the byte order of the packet.
+         *
+         * @param packet    ->  DMPacket or DMPacketWriter.
+         * @param s         ->  the struct.
+         * @return false if it does not fit (DMPacketWriter only, overflow() is set).
+         */
+        template<typename Packet>
+        static bool pack(Packet& packet, const Struct& s) {
+            uint8_t *p=packet.pushSpace(SIZE);
+            if (p == nullptr) {
+                return false;
+            }
+            store(p,s,packet.getByteOrder());
+            return true;
+        }
+
+        /**
+         * @brief Shift a message from a view (one bounds check for all fields), in the byte order of the view.
+         *
+         * @param view  ->  the view, advanced by SIZE bytes.
+         * @param s     ->  destination.
+         * @return false if less than SIZE bytes remain (s untouched, overflow() is set).
+         */
+        static bool unpack(DMPacketView& view, Struct& s) {
+            const uint8_t *p=view.shiftData(SIZE);
+            if (p == nullptr) {
+                return false;
+            }
+            load(p,s,view.getByteOrder());
+            return true;
+        }
+
+        /**
+         * @brief Load a message from a buffer.
+         *
+         * @return false if buffSize is less than SIZE (s untouched).
+         */
+        static bool unpack(const uint8_t *buff, size_t buffSize, Struct& s, DMPacketByteOrder byteOrder = DMPACKET_BIG_ENDIAN) {
+            if (buffSize < SIZE) {
+                return false;
+            }
+            load(buff,s,byteOrder);
+            return true;
+        }
+};
+
+#endif // DMPACKETSCHEMA_H
@@ -0,0 +1,207 @@
+#include "dmpacketstream.h"
+#ifdef ARDUINO
+    #include "Arduino.h"
+#endif
+
+// decodeLength(): varint longer than 32 bits
+static const size_t LENGTH_MALFORMED = (size_t) -1;
+
+/**
+ * @param buff          ->  buffer of packets split across chunks (the largest packet).
+ * @param capacity      ->  size of buffer.
+ * @param lengthType    ->  encoding of lengths.
+ * @param byteOrder     ->  byte order of 16/32 bit lengths and of the packet views.
+ */
+DMPacketStream::DMPacketStream(uint8_t *buff, size_t capacity, LengthType lengthType, DMPacketByteOrder byteOrder) : buff(buff), capacity(capacity), lengthType(lengthType), byteOrder(byteOrder)
+{
+    packetData=buff;
+    packetSize=0;
+    packetsCount=0;
+    reassembled=0;
+    overflows=0;
+    errors=0;
+    reset();
+}
+
+//! Drop the packet being received (the next byte is taken as the length of a packet).
+void DMPacketStream::reset(void)
+{
+    headerBytes=0;
+    inPacket=false;
+    skipping=false;
+    packetLeft=0;
+    received=0;
+}
+
+/**
+ * @brief Parse received bytes up to the end of the next packet.
+ *
+ * @param data      ->  received bytes, advanced past the bytes consumed.
+ * @param dataSize  ->  number of received bytes, decreased by the bytes consumed.
+ * @return true if a packet is ready (get it by packet()), false if all bytes were consumed without completing one.
+ */
+bool DMPacketStream::parse(const uint8_t*& data, size_t& dataSize)
+{
+    while (dataSize > 0) {
+        if (inPacket) {
+            // Rest of a packet split across chunks
+            size_t count=dataSize < packetLeft ? dataSize : packetLeft;
+            if (!skipping) {
+                memcpy(buff+received,data,count);
+                received+=count;
+            }
+            data+=count;
+            dataSize-=count;
+            packetLeft-=count;
+            if (packetLeft > 0) {
+                return false;
+            }
+            inPacket=false;
+            if (skipping) {
+                skipping=false;
+                overflows++;
+                continue;
+            }
+            packetData=buff;
+            packetSize=received;
+            packetsCount++;
+            reassembled++;
+            return true;
+        }
+
+        uint32_t length;
+        size_t n=0;
+        if (headerBytes == 0) {
+            // Length straight from the chunk
+            n=decodeLength(data,dataSize,length);
+            if (n != 0 && n != LENGTH_MALFORMED) {
+                data+=n;
+                dataSize-=n;
+                if (startPacket(length,data,dataSize)) {
+                    return true;
+                }
+                continue;
+            }
+        }
+        if (headerBytes != 0 || n == 0) {
+            // Length split across chunks: a byte at a time
+            header[headerBytes++]=*data++;
+            dataSize--;
+            n=decodeLength(header,headerBytes,length);
+            if (n == 0) {
+                continue;
+            }
+            headerBytes=0;
+            if (n != LENGTH_MALFORMED) {
+                if (startPacket(length,data,dataSize)) {
+                    return true;
+                }
+                continue;
+            }
+        }
+        else {
+            // As the bytes of a split length: the whole varint is dropped
+            data+=DMPacketVarint::MAX_SIZE;
+            dataSize-=DMPacketVarint::MAX_SIZE;
+        }
+        errors++;
+    }
+    return false;
+}
+
+/**
+ * @brief Decode a length.
+ *
+ * @return bytes of the length, 0 if more are needed, LENGTH_MALFORMED for a varint longer than 32 bits.
+ */
+size_t DMPacketStream::decodeLength(const uint8_t *p, size_t avail, uint32_t& length) const
+{
+    switch (lengthType) {
+        case LENGTH_8:
+            if (avail < 1) {
+                return 0;
+            }
+            length=p[0];
+            return 1;
+        case LENGTH_16:
+            if (avail < 2) {
+                return 0;
+            }
+            length=DMPacketEndian::load16(byteOrder,p);
+            return 2;
+        case LENGTH_32:
+            if (avail < 4) {
+                return 0;
+            }
+            length=DMPacketEndian::load32(byteOrder,p);
+            return 4;
+        default: {
+            size_t n=DMPacketVarint::decode(p,avail,length);
+            if (n == 0 && avail >= DMPacketVarint::MAX_SIZE) {
+                return LENGTH_MALFORMED;
+            }
+            return n;
+        }
+    }
+}
+
+/**
+ * @brief Start a packet after its length: a packet all in the chunk is returned in place.
+ *
+ * @return true if the packet is ready.
+ */
+bool DMPacketStream::startPacket(uint32_t length, const uint8_t*& data, size_t& dataSize)
+{
+    skipping=length > capacity;
+    if (!skipping && length <= dataSize) {
+        packetData=data;
+        packetSize=length;
+        data+=length;
+        dataSize-=length;
+        packetsCount++;
+        return true;
+    }
+    inPacket=true;
+    packetLeft=length;
+    received=0;
+    return false;
+}
+
+size_t DMPacketStream::headerSize(uint32_t payloadSize) const
+{
+    return lengthType == LENGTH_VARINT ? DMPacketVarint::size(payloadSize) : (size_t) lengthType;
+}
+
+/**
+ * @brief Append a packet (its length and payload) to a writer.
+ *
+ * @return false if it does not fit (writer.overflow() is set) or it is longer than the length type allows.
+ */
+bool DMPacketStream::push(DMPacketWriter& writer, const uint8_t *payload, size_t payloadSize) const
+{
+    if ((lengthType == LENGTH_8 && payloadSize > 0xFF) || (lengthType == LENGTH_16 && payloadSize > 0xFFFF) ||
+        (uint32_t) payloadSize != payloadSize) {
+        return false;
+    }
+    size_t n=headerSize((uint32_t) payloadSize);
+    uint8_t *p=writer.pushSpace(n+payloadSize);
+    if (p == nullptr) {
+        return false;
+    }
+    switch (lengthType) {
+        case LENGTH_8:
+            p[0]=(uint8_t) payloadSize;
+            break;
+        case LENGTH_16:
+            DMPacketEndian::store16(byteOrder,p,(uint16_t) payloadSize);
+            break;
+        case LENGTH_32:
+            DMPacketEndian::store32(byteOrder,p,(uint32_t) payloadSize);
+            break;
+        default:
+            DMPacketVarint::encode(p,(uint32_t) payloadSize);
+            break;
+    }
+    memcpy(p+n,payload,payloadSize);
+    return true;
+}
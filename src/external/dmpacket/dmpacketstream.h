@@ -0,0 +1,91 @@
+#ifndef DMPACKETSTREAM_H
+#define DMPACKETSTREAM_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "dmpacketview.h"
+
+/**
+ * Length-prefixed packets over byte streams (TCP sockets, serial ports, I2C reads): each packet is sent after its
+ * length, so the receiver finds packet boundaries whatever the chunks read_some()/read() return, with packets split
+ * across chunks or several packets in a chunk.
+ *
+ * The parser keeps its state across calls and never allocates: a packet entirely inside a chunk is returned as a view
+ * of the chunk itself (no copy), only packets split across chunks are reassembled in the buffer of the parser.
+ * Packets longer than the buffer are skipped and counted.
+ *
+ * The length is not protected: a lost or corrupted byte desyncs the stream, use it on reliable transports (TCP, USB
+ * CDC). On noisy links use DMPacketFrame/DMPacketFrameDecoder (COBS framing and CRC, same decode loop).
+ *
+ * @code
+ * static uint8_t rxBuff[1024];
+ * DMPacketStream stream(rxBuff);                  // 16 bit lengths, big endian
+ * uint8_t chunk[1500];
+ * size_t received=socket.read_some(asio::buffer(chunk));
+ * const uint8_t *data=chunk;
+ * while (stream.parse(data, received)) {
+ *     DMPacketView packet=stream.packet();        // valid until the next parse() and while chunk is untouched
+ *     ...
+ * }
+ *
+ * stream.push(writer, payload, payloadSize);      // sender: length and payload
+ * @endcode
+ */
+class DMPacketStream {
+    public:
+        //! Encoding of the length before each packet.
+        enum LengthType : uint8_t {
+            LENGTH_VARINT = 0,  // 1-5 bytes (see DMPacketVarint)
+            LENGTH_8 = 1,
+            LENGTH_16 = 2,      // in the byte order of the stream
+            LENGTH_32 = 4       // in the byte order of the stream
+        };
+
+        DMPacketStream(uint8_t *buff, size_t capacity, LengthType lengthType = LENGTH_16, DMPacketByteOrder byteOrder = DMPACKET_BIG_ENDIAN);
+        template<size_t N>
+        DMPacketStream(uint8_t (&buff)[N], LengthType lengthType = LENGTH_16, DMPacketByteOrder byteOrder = DMPACKET_BIG_ENDIAN) : DMPacketStream(buff, N, lengthType, byteOrder) {}
+
+        bool parse(const uint8_t*& data, size_t& dataSize);
+        //! @return the last packet parsed (valid until the next parse(), it can point into the chunk passed to it).
+        DMPacketView packet(void) const { return DMPacketView(packetData,packetSize,byteOrder); }
+        void reset(void);
+
+        //! @return bytes of the length of a packet.
+        size_t headerSize(uint32_t payloadSize) const;
+        bool push(DMPacketWriter& writer, const uint8_t *payload, size_t payloadSize) const;
+
+        //! @return packets parsed.
+        uint32_t getPacketsCount(void) const { return packetsCount; }
+        //! @return packets parsed that were split across chunks (copied into the buffer).
+        uint32_t getReassembledCount(void) const { return reassembled; }
+        //! @return packets skipped because longer than the buffer.
+        uint32_t getOverflowsCount(void) const { return overflows; }
+        //! @return malformed lengths (varint longer than 32 bits), its 5 bytes are skipped.
+        uint32_t getErrorsCount(void) const { return errors; }
+
+    private:
+        size_t decodeLength(const uint8_t *p, size_t avail, uint32_t& length) const;
+        bool startPacket(uint32_t length, const uint8_t*& data, size_t& dataSize);
+
+        uint8_t *buff;
+        size_t capacity;
+        LengthType lengthType;
+        DMPacketByteOrder byteOrder;
+
+        const uint8_t *packetData;
+        size_t packetSize;
+
+        uint8_t header[DMPacketVarint::MAX_SIZE];
+        uint8_t headerBytes;    // bytes of the current length received (split across chunks)
+        bool inPacket;          // length received, receiving the packet
+        bool skipping;          // current packet longer than the buffer, skip it
+        uint32_t packetLeft;    // bytes of the current packet still to receive
+        size_t received;        // bytes of the current packet in buff
+
+        uint32_t packetsCount;
+        uint32_t reassembled;
+        uint32_t overflows;
+        uint32_t errors;
+};
+
+#endif // DMPACKETSTREAM_H
@@ -0,0 +1,168 @@
+#ifndef DMPACKETVARINT_H
+#define DMPACKETVARINT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+/**
+ * Variable length integers (LEB128, as protobuf): 7 bits per byte, least significant group first, the high bit set on
+ * all bytes but the last one. Values below 128 take 1 byte, below 16384 2 bytes, a full 32 bit value 5 bytes.
+ * Signed values are zigzag mapped first (0, -1, 1, -2, ... -> 0, 1, 2, 3, ...) so small negative values stay short.
+ *
+ * Varints do not depend on the byte order of the packet.
+ */
+#if defined(__GNUC__) && defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__ && !defined(ARDUINO)
+    #define DMPACKET_VARINT_BRANCHLESS  // 64 bit loads/stores and bit tricks instead of a loop per byte
+#endif
+
+struct DMPacketVarint {
+    //! Longest encoding of a 32 bit value.
+    static constexpr size_t MAX_SIZE = 5;
+
+    static inline uint32_t zigzag(int32_t v) {
+        return ((uint32_t) v << 1) ^ (0 - ((uint32_t) v >> 31));
+    }
+    static inline int32_t unzigzag(uint32_t v) {
+        return (int32_t) ((v >> 1) ^ (0 - (v & 1)));
+    }
+
+    //! @return bytes of the encoding of v.
+    static inline size_t size(uint32_t v) {
+        #ifdef __GNUC__
+            return 1 + (31 - __builtin_clz(v | 1)) / 7;
+        #else
+            return v < (1UL << 7) ? 1 : v < (1UL << 14) ? 2 : v < (1UL << 21) ? 3 : v < (1UL << 28) ? 4 : 5;
+        #endif
+    }
+
+    //! Encode v into p (at least size(v) bytes): @return bytes written.
+    static inline size_t encode(uint8_t *p, uint32_t v) {
+        #ifdef DMPACKET_VARINT_BRANCHLESS
+            uint8_t tmp[8];
+            size_t n=encode8(tmp,v);
+            memcpy(p,tmp,n);
+        #else
+            size_t n=0;
+            while (v >= 0x80) {
+                p[n++]=(uint8_t) (v | 0x80);
+                v>>=7;
+            }
+            p[n++]=(uint8_t) v;
+        #endif
+        return n;
+    }
+
+    #ifdef DMPACKET_VARINT_BRANCHLESS
+    //! Encode v into p writing 8 bytes (only the first size(v) are the value): @return bytes of the value.
+    static inline size_t encode8(uint8_t *p, uint32_t v) {
+        // Spread the 7 bit groups one per byte, then set the continuation bit of all bytes but the last one
+        uint64_t x=(v & 0x7F) | ((uint64_t) (v & 0x3F80) << 1) | ((uint64_t) (v & 0x1FC000) << 2) |
+                   ((uint64_t) (v & 0xFE00000) << 3) | ((uint64_t) (v & 0xF0000000) << 4);
+        size_t n=size(v);
+        x|=0x8080808080ULL & ((1ULL << (8*(n-1))) - 1);
+        memcpy(p,&x,8);
+        return n;
+    }
+    #endif
+
+    /**
+     * @brief Decode a value.
+     *
+     * @param p     ->  encoded bytes.
+     * @param avail ->  bytes available from p.
+     * @param v     ->  decoded value.
+     * @return bytes consumed, 0 if the encoding is truncated or longer than a 32 bit value (v untouched).
+     */
+    static inline size_t decode(const uint8_t *p, size_t avail, uint32_t& v) {
+        #ifdef DMPACKET_VARINT_BRANCHLESS
+            if (avail >= 8) {
+                // Branchless: the first byte with the high bit clear ends the value, then the 7 bit groups are packed
+                uint64_t x;
+                memcpy(&x,p,8);
+                uint64_t stops=~x & 0x8080808080ULL;
+                if (stops == 0) {
+                    return 0;
+                }
+                size_t n=(__builtin_ctzll(stops) >> 3) + 1;
+                x&=stops ^ (stops - 1);
+                if (x >> 36) {
+                    return 0;       // more than 32 bits
+                }
+                v=(uint32_t) ((x & 0x7F) | ((x >> 1) & 0x3F80) | ((x >> 2) & 0x1FC000) | ((x >> 3) & 0xFE00000) |
+                              ((x >> 4) & 0xF0000000));
+                return n;
+            }
+        #endif
+        uint32_t value=0;
+        for (size_t ixB=0; ixB<MAX_SIZE && ixB<avail; ixB++) {
+            uint8_t b=p[ixB];
+            if (ixB == MAX_SIZE-1 && b > 0x0F) {
+                return 0;           // more than 32 bits
+            }
+            value|=(uint32_t) (b & 0x7F) << (7*ixB);
+            if (b < 0x80) {
+                v=value;
+                return ixB+1;
+            }
+        }
+        return 0;
+    }
+
+    //! @return bytes to reserve for encodeDeltas() of count values (encode8() may write past the last value).
+    static constexpr size_t deltasCapacity(size_t count) { return count*MAX_SIZE + 8 - MAX_SIZE; }
+
+    /**
+     * @brief Encode the zigzag differences between consecutive values.
+     *
+     * @param p     ->  destination, at least deltasCapacity(count) bytes.
+     * @param prev  ->  value before the first one.
+     * @return bytes of the encoding.
+     */
+    template<typename T>
+    static size_t encodeDeltas(uint8_t *p, const T values[], size_t count, uint32_t prev) {
+        uint8_t *start=p;
+        for (size_t ixV=0; ixV<count; ixV++) {
+            uint32_t value=(uint32_t) values[ixV];
+            #ifdef DMPACKET_VARINT_BRANCHLESS
+                p+=encode8(p,zigzag((int32_t) (value-prev)));
+            #else
+                p+=encode(p,zigzag((int32_t) (value-prev)));
+            #endif
+            prev=value;
+        }
+        return p-start;
+    }
+
+    /**
+     * @brief Decode values encoded by encodeDeltas().
+     *
+     * @param p     ->  encoded bytes, advanced past the values decoded.
+     * @param avail ->  bytes available from p, decreased by the bytes consumed.
+     * @param prev  ->  value before the first one.
+     * @return values decoded, less than count if a varint is truncated or malformed (p is left at it).
+     */
+    template<typename T>
+    static size_t decodeDeltas(const uint8_t*& p, size_t& avail, T dest[], size_t count, uint32_t prev) {
+        // State in locals: stores to dest could alias p/avail for uint8_t series
+        const uint8_t *q=p;
+        size_t left=avail;
+        size_t ixV=0;
+        for (; ixV<count; ixV++) {
+            uint32_t delta;
+            size_t n=decode(q,left,delta);
+            if (n == 0) {
+                break;
+            }
+            q+=n;
+            left-=n;
+            prev+=(uint32_t) unzigzag(delta);
+            dest[ixV]=(T) prev;
+        }
+        p=q;
+        avail=left;
+        return ixV;
+    }
+};
+
+#endif // DMPACKETVARINT_H
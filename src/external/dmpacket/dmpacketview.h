@@ -0,0 +1,790 @@
+#ifndef DMPACKETVIEW_H
+#define DMPACKETVIEW_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#ifdef ARDUINO
+    #include "Arduino.h"
+#endif
+#include <vector>
+#include <string>
+#include "dmpacketvarint.h"
+#if !defined(ARDUINO) && __cplusplus >= 202002L
+    #include <span>
+    #define DMPACKET_HAS_SPAN
+#endif
+
+/**
+ * Non-owning packets: same typed API and wire format (big endian, or little endian with setByteOrder()) of DMPacket,
+ * but over a buffer of the caller, so received data (i.e. from DI2CMaster::recvBuf() or a socket) is parsed in place,
+ * and packets to send are built straight into the transmit buffer: no copies, no heap.
+ *
+ * - DMPacketView   ->  read/shift over a const buffer.
+ * - DMPacketWriter ->  push/write into a fixed size buffer.
+ *
+ * Reading or writing out of buffer does nothing (reads return 0xFF..), and sets a sticky overflow flag, so a whole
+ * message can be parsed/built and checked once at the end.
+ *
+ * @code
+ * uint8_t rx[32];
+ * i2c.recvBuf(addr, rx, sizeof(rx));
+ * DMPacketView view(rx, sizeof(rx));
+ * uint8_t cmd=view.shiftByte();
+ * float temp=view.shiftFloat();
+ * if (view.overflow()) { ... }
+ *
+ * uint8_t tx[16];
+ * DMPacketWriter writer(tx);
+ * writer.pushByte(cmd);
+ * writer.pushWord(1234);
+ * i2c.sendBuf(addr, writer.data(), writer.size());
+ * @endcode
+ */
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    #define DMPACKET_HOST_LITTLE_ENDIAN
+#elif defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    #define DMPACKET_HOST_BIG_ENDIAN
+#endif
+#if !defined(ARDUINO) && defined(__GNUC__)
+    #define DMPACKET_BULK_BSWAP     // arrays in the other byte order: memcpy + bswap loops, vectorized by the compiler
+#endif
+
+//! Byte order of 16/32 bit values on the wire (big endian is the original DMPacket format).
+enum DMPacketByteOrder : uint8_t {
+    DMPACKET_BIG_ENDIAN = 0,
+    DMPACKET_LITTLE_ENDIAN = 1
+};
+
+#ifdef DMPACKET_BULK_BSWAP
+//! Arrays in the opposite byte order of the host (src and dst must not overlap).
+struct DMPacketSwap {
+    static inline void load16(uint16_t *dst, const uint8_t *src, size_t count) {
+        for (size_t ixV=0; ixV<count; ixV++) {
+            uint16_t v;
+            memcpy(&v,src+ixV*2,2);
+            dst[ixV]=__builtin_bswap16(v);
+        }
+    }
+    static inline void load32(uint32_t *dst, const uint8_t *src, size_t count) {
+        for (size_t ixV=0; ixV<count; ixV++) {
+            uint32_t v;
+            memcpy(&v,src+ixV*4,4);
+            dst[ixV]=__builtin_bswap32(v);
+        }
+    }
+    static inline void loadFloat(float *dst, const uint8_t *src, size_t count) {
+        for (size_t ixV=0; ixV<count; ixV++) {
+            uint32_t v;
+            memcpy(&v,src+ixV*4,4);
+            v=__builtin_bswap32(v);
+            memcpy(dst+ixV,&v,4);
+        }
+    }
+    static inline void store16(uint8_t *dst, const uint16_t *src, size_t count) {
+        for (size_t ixV=0; ixV<count; ixV++) {
+            uint16_t v=__builtin_bswap16(src[ixV]);
+            memcpy(dst+ixV*2,&v,2);
+        }
+    }
+    static inline void store32(uint8_t *dst, const uint32_t *src, size_t count) {
+        for (size_t ixV=0; ixV<count; ixV++) {
+            uint32_t v=__builtin_bswap32(src[ixV]);
+            memcpy(dst+ixV*4,&v,4);
+        }
+    }
+    static inline void storeFloat(uint8_t *dst, const float *src, size_t count) {
+        for (size_t ixV=0; ixV<count; ixV++) {
+            uint32_t v;
+            memcpy(&v,src+ixV,4);
+            v=__builtin_bswap32(v);
+            memcpy(dst+ixV*4,&v,4);
+        }
+    }
+};
+#endif
+
+//! Big endian (DMPacket wire format) load/store of 16/32 bit values and arrays.
+struct DMPacketBE {
+    static inline uint16_t load16(const uint8_t *p) {
+        return (uint16_t) (((uint16_t) p[0] << 8) | p[1]);
+    }
+    static inline uint32_t load32(const uint8_t *p) {
+        return ((uint32_t) p[0] << 24) | ((uint32_t) p[1] << 16) | ((uint32_t) p[2] << 8) | p[3];
+    }
+    static inline void store16(uint8_t *p, uint16_t v) {
+        p[0]=(uint8_t) (v >> 8);
+        p[1]=(uint8_t) v;
+    }
+    static inline void store32(uint8_t *p, uint32_t v) {
+        p[0]=(uint8_t) (v >> 24);
+        p[1]=(uint8_t) (v >> 16);
+        p[2]=(uint8_t) (v >> 8);
+        p[3]=(uint8_t) v;
+    }
+    static inline float toFloat(uint32_t v) {
+        float f;
+        memcpy(&f,&v,sizeof(f));
+        return f;
+    }
+    static inline uint32_t fromFloat(float f) {
+        uint32_t v;
+        memcpy(&v,&f,sizeof(v));
+        return v;
+    }
+
+    // Arrays (count values, src and dst must not overlap)
+    static inline void load16(uint16_t *dst, const uint8_t *src, size_t count) {
+        #if defined(DMPACKET_HOST_BIG_ENDIAN)
+            memcpy(dst,src,count*2);
+        #elif defined(DMPACKET_HOST_LITTLE_ENDIAN) && defined(DMPACKET_BULK_BSWAP)
+            DMPacketSwap::load16(dst,src,count);
+        #else
+            for (size_t ixV=0; ixV<count; ixV++) {
+                dst[ixV]=load16(src+ixV*2);
+            }
+        #endif
+    }
+    static inline void load32(uint32_t *dst, const uint8_t *src, size_t count) {
+        #if defined(DMPACKET_HOST_BIG_ENDIAN)
+            memcpy(dst,src,count*4);
+        #elif defined(DMPACKET_HOST_LITTLE_ENDIAN) && defined(DMPACKET_BULK_BSWAP)
+            DMPacketSwap::load32(dst,src,count);
+        #else
+            for (size_t ixV=0; ixV<count; ixV++) {
+                dst[ixV]=load32(src+ixV*4);
+            }
+        #endif
+    }
+    static inline void loadFloat(float *dst, const uint8_t *src, size_t count) {
+        #if defined(DMPACKET_HOST_BIG_ENDIAN)
+            memcpy(dst,src,count*4);
+        #elif defined(DMPACKET_HOST_LITTLE_ENDIAN) && defined(DMPACKET_BULK_BSWAP)
+            DMPacketSwap::loadFloat(dst,src,count);
+        #else
+            for (size_t ixV=0; ixV<count; ixV++) {
+                dst[ixV]=toFloat(load32(src+ixV*4));
+            }
+        #endif
+    }
+    static inline void store16(uint8_t *dst, const uint16_t *src, size_t count) {
+        #if defined(DMPACKET_HOST_BIG_ENDIAN)
+            memcpy(dst,src,count*2);
+        #elif defined(DMPACKET_HOST_LITTLE_ENDIAN) && defined(DMPACKET_BULK_BSWAP)
+            DMPacketSwap::store16(dst,src,count);
+        #else
+            for (size_t ixV=0; ixV<count; ixV++) {
+                store16(dst+ixV*2,src[ixV]);
+            }
+        #endif
+    }
+    static inline void store32(uint8_t *dst, const uint32_t *src, size_t count) {
+        #if defined(DMPACKET_HOST_BIG_ENDIAN)
+            memcpy(dst,src,count*4);
+        #elif defined(DMPACKET_HOST_LITTLE_ENDIAN) && defined(DMPACKET_BULK_BSWAP)
+            DMPacketSwap::store32(dst,src,count);
+        #else
+            for (size_t ixV=0; ixV<count; ixV++) {
+                store32(dst+ixV*4,src[ixV]);
+            }
+        #endif
+    }
+    static inline void storeFloat(uint8_t *dst, const float *src, size_t count) {
+        #if defined(DMPACKET_HOST_BIG_ENDIAN)
+            memcpy(dst,src,count*4);
+        #elif defined(DMPACKET_HOST_LITTLE_ENDIAN) && defined(DMPACKET_BULK_BSWAP)
+            DMPacketSwap::storeFloat(dst,src,count);
+        #else
+            for (size_t ixV=0; ixV<count; ixV++) {
+                store32(dst+ixV*4,fromFloat(src[ixV]));
+            }
+        #endif
+    }
+};
+
+//! Little endian load/store of 16/32 bit values and arrays: plain memcpy on little endian hosts.
+struct DMPacketLE {
+    static inline uint16_t load16(const uint8_t *p) {
+        #ifdef DMPACKET_HOST_LITTLE_ENDIAN
+            uint16_t v;
+            memcpy(&v,p,2);
+            return v;
+        #else
+            return (uint16_t) (((uint16_t) p[1] << 8) | p[0]);
+        #endif
+    }
+    static inline uint32_t load32(const uint8_t *p) {
+        #ifdef DMPACKET_HOST_LITTLE_ENDIAN
+            uint32_t v;
+            memcpy(&v,p,4);
+            return v;
+        #else
+            return ((uint32_t) p[3] << 24) | ((uint32_t) p[2] << 16) | ((uint32_t) p[1] << 8) | p[0];
+        #endif
+    }
+    static inline void store16(uint8_t *p, uint16_t v) {
+        #ifdef DMPACKET_HOST_LITTLE_ENDIAN
+            memcpy(p,&v,2);
+        #else
+            p[0]=(uint8_t) v;
+            p[1]=(uint8_t) (v >> 8);
+        #endif
+    }
+    static inline void store32(uint8_t *p, uint32_t v) {
+        #ifdef DMPACKET_HOST_LITTLE_ENDIAN
+            memcpy(p,&v,4);
+        #else
+            p[0]=(uint8_t) v;
+            p[1]=(uint8_t) (v >> 8);
+            p[2]=(uint8_t) (v >> 16);
+            p[3]=(uint8_t) (v >> 24);
+        #endif
+    }
+
+    // Arrays (count values, src and dst must not overlap)
+    static inline void load16(uint16_t *dst, const uint8_t *src, size_t count) {
+        #if defined(DMPACKET_HOST_LITTLE_ENDIAN)
+            memcpy(dst,src,count*2);
+        #elif defined(DMPACKET_HOST_BIG_ENDIAN) && defined(DMPACKET_BULK_BSWAP)
+            DMPacketSwap::load16(dst,src,count);
+        #else
+            for (size_t ixV=0; ixV<count; ixV++) {
+                dst[ixV]=load16(src+ixV*2);
+            }
+        #endif
+    }
+    static inline void load32(uint32_t *dst, const uint8_t *src, size_t count) {
+        #if defined(DMPACKET_HOST_LITTLE_ENDIAN)
+            memcpy(dst,src,count*4);
+        #elif defined(DMPACKET_HOST_BIG_ENDIAN) && defined(DMPACKET_BULK_BSWAP)
+            DMPacketSwap::load32(dst,src,count);
+        #else
+            for (size_t ixV=0; ixV<count; ixV++) {
+                dst[ixV]=load32(src+ixV*4);
+            }
+        #endif
+    }
+    static inline void loadFloat(float *dst, const uint8_t *src, size_t count) {
+        #if defined(DMPACKET_HOST_LITTLE_ENDIAN)
+            memcpy(dst,src,count*4);
+        #elif defined(DMPACKET_HOST_BIG_ENDIAN) && defined(DMPACKET_BULK_BSWAP)
+            DMPacketSwap::loadFloat(dst,src,count);
+        #else
+            for (size_t ixV=0; ixV<count; ixV++) {
+                dst[ixV]=DMPacketBE::toFloat(load32(src+ixV*4));
+            }
+        #endif
+    }
+    static inline void store16(uint8_t *dst, const uint16_t *src, size_t count) {
+        #if defined(DMPACKET_HOST_LITTLE_ENDIAN)
+            memcpy(dst,src,count*2);
+        #elif defined(DMPACKET_HOST_BIG_ENDIAN) && defined(DMPACKET_BULK_BSWAP)
+            DMPacketSwap::store16(dst,src,count);
+        #else
+            for (size_t ixV=0; ixV<count; ixV++) {
+                store16(dst+ixV*2,src[ixV]);
+            }
+        #endif
+    }
+    static inline void store32(uint8_t *dst, const uint32_t *src, size_t count) {
+        #if defined(DMPACKET_HOST_LITTLE_ENDIAN)
+            memcpy(dst,src,count*4);
+        #elif defined(DMPACKET_HOST_BIG_ENDIAN) && defined(DMPACKET_BULK_BSWAP)
+            DMPacketSwap::store32(dst,src,count);
+        #else
+            for (size_t ixV=0; ixV<count; ixV++) {
+                store32(dst+ixV*4,src[ixV]);
+            }
+        #endif
+    }
+    static inline void storeFloat(uint8_t *dst, const float *src, size_t count) {
+        #if defined(DMPACKET_HOST_LITTLE_ENDIAN)
+            memcpy(dst,src,count*4);
+        #elif defined(DMPACKET_HOST_BIG_ENDIAN) && defined(DMPACKET_BULK_BSWAP)
+            DMPacketSwap::storeFloat(dst,src,count);
+        #else
+            for (size_t ixV=0; ixV<count; ixV++) {
+                store32(dst+ixV*4,DMPacketBE::fromFloat(src[ixV]));
+            }
+        #endif
+    }
+};
+
+//! Load/store in the byte order of a packet.
+struct DMPacketEndian {
+    static inline uint16_t load16(DMPacketByteOrder order, const uint8_t *p) {
+        return order == DMPACKET_LITTLE_ENDIAN ? DMPacketLE::load16(p) : DMPacketBE::load16(p);
+    }
+    static inline uint32_t load32(DMPacketByteOrder order, const uint8_t *p) {
+        return order == DMPACKET_LITTLE_ENDIAN ? DMPacketLE::load32(p) : DMPacketBE::load32(p);
+    }
+    static inline void store16(DMPacketByteOrder order, uint8_t *p, uint16_t v) {
+        if (order == DMPACKET_LITTLE_ENDIAN) {
+            DMPacketLE::store16(p,v);
+        }
+        else {
+            DMPacketBE::store16(p,v);
+        }
+    }
+    static inline void store32(DMPacketByteOrder order, uint8_t *p, uint32_t v) {
+        if (order == DMPACKET_LITTLE_ENDIAN) {
+            DMPacketLE::store32(p,v);
+        }
+        else {
+            DMPacketBE::store32(p,v);
+        }
+    }
+    static inline void load16(DMPacketByteOrder order, uint16_t *dst, const uint8_t *src, size_t count) {
+        if (order == DMPACKET_LITTLE_ENDIAN) {
+            DMPacketLE::load16(dst,src,count);
+        }
+        else {
+            DMPacketBE::load16(dst,src,count);
+        }
+    }
+    static inline void load32(DMPacketByteOrder order, uint32_t *dst, const uint8_t *src, size_t count) {
+        if (order == DMPACKET_LITTLE_ENDIAN) {
+            DMPacketLE::load32(dst,src,count);
+        }
+        else {
+            DMPacketBE::load32(dst,src,count);
+        }
+    }
+    static inline void loadFloat(DMPacketByteOrder order, float *dst, const uint8_t *src, size_t count) {
+        if (order == DMPACKET_LITTLE_ENDIAN) {
+            DMPacketLE::loadFloat(dst,src,count);
+        }
+        else {
+            DMPacketBE::loadFloat(dst,src,count);
+        }
+    }
+    static inline void store16(DMPacketByteOrder order, uint8_t *dst, const uint16_t *src, size_t count) {
+        if (order == DMPACKET_LITTLE_ENDIAN) {
+            DMPacketLE::store16(dst,src,count);
+        }
+        else {
+            DMPacketBE::store16(dst,src,count);
+        }
+    }
+    static inline void store32(DMPacketByteOrder order, uint8_t *dst, const uint32_t *src, size_t count) {
+        if (order == DMPACKET_LITTLE_ENDIAN) {
+            DMPacketLE::store32(dst,src,count);
+        }
+        else {
+            DMPacketBE::store32(dst,src,count);
+        }
+    }
+    static inline void storeFloat(DMPacketByteOrder order, uint8_t *dst, const float *src, size_t count) {
+        if (order == DMPACKET_LITTLE_ENDIAN) {
+            DMPacketLE::storeFloat(dst,src,count);
+        }
+        else {
+            DMPacketBE::storeFloat(dst,src,count);
+        }
+    }
+};
+
+class DMPacketView {
+    public:
+        DMPacketView() : buff(nullptr), buffSize(0), shiftIndex(0), overflowed(false), byteOrder(DMPACKET_BIG_ENDIAN) {}
+        DMPacketView(const uint8_t *buff, size_t buffSize, DMPacketByteOrder byteOrder = DMPACKET_BIG_ENDIAN) : buff(buff), buffSize(buffSize), shiftIndex(0), overflowed(false), byteOrder(byteOrder) {}
+        DMPacketView(const std::vector<uint8_t>& buffVec, DMPacketByteOrder byteOrder = DMPACKET_BIG_ENDIAN) : DMPacketView(buffVec.data(), buffVec.size(), byteOrder) {}
+        #ifdef DMPACKET_HAS_SPAN
+        DMPacketView(std::span<const uint8_t> buff, DMPacketByteOrder byteOrder = DMPACKET_BIG_ENDIAN) : DMPacketView(buff.data(), buff.size(), byteOrder) {}
+        #endif
+
+        size_t size(void) const { return buffSize; }
+        const uint8_t* data(void) const { return buff; }
+        //! @return bytes not yet shifted.
+        size_t remaining(void) const { return shiftIndex < buffSize ? buffSize-shiftIndex : 0; }
+        size_t getShiftIndex(void) const { return shiftIndex; }
+        void rewind(size_t offset = 0) { shiftIndex=offset; }
+        //! @return true if a read went out of buffer (sticky, see clearOverflow()).
+        bool overflow(void) const { return overflowed; }
+        void clearOverflow(void) { overflowed=false; }
+        //! Byte order of 16/32 bit values (big endian by default).
+        DMPacketByteOrder getByteOrder(void) const { return byteOrder; }
+        void setByteOrder(DMPacketByteOrder byteOrder) { this->byteOrder=byteOrder; }
+
+        uint8_t readByte(size_t offset) {
+            return check(offset,1) ? buff[offset] : 0xFF;
+        }
+        uint16_t readWord(size_t offset) {
+            return check(offset,2) ? DMPacketEndian::load16(byteOrder,buff+offset) : 0xFFFF;
+        }
+        uint32_t readDWord(size_t offset) {
+            return check(offset,4) ? DMPacketEndian::load32(byteOrder,buff+offset) : 0xFFFFFFFF;
+        }
+        int8_t readInt8(size_t offset) { return (int8_t) readByte(offset); }
+        int16_t readInt16(size_t offset) { return (int16_t) readWord(offset); }
+        int32_t readInt32(size_t offset) { return (int32_t) readDWord(offset); }
+        float readFloat(size_t offset) { return DMPacketBE::toFloat(readDWord(offset)); }
+        bool readBool(size_t offset) { return readByte(offset) != 0; }
+        std::string readString(size_t offset = 0, size_t lenght = 0);
+        //! @return count bytes starting from offset (nullptr if out of buffer): a pointer into the viewed buffer.
+        const uint8_t* readData(size_t offset, size_t count) {
+            return check(offset,count) ? buff+offset : nullptr;
+        }
+
+        //! Read count values into dest: @return count, 0 if out of buffer (dest untouched, overflow() is set).
+        size_t readWordsInto(uint16_t dest[], size_t offset, size_t count) {
+            if (!check(offset,count*2)) {
+                return 0;
+            }
+            DMPacketEndian::load16(byteOrder,dest,buff+offset,count);
+            return count;
+        }
+        size_t readDWordsInto(uint32_t dest[], size_t offset, size_t count) {
+            if (!check(offset,count*4)) {
+                return 0;
+            }
+            DMPacketEndian::load32(byteOrder,dest,buff+offset,count);
+            return count;
+        }
+        size_t readFloatsInto(float dest[], size_t offset, size_t count) {
+            if (!check(offset,count*4)) {
+                return 0;
+            }
+            DMPacketEndian::loadFloat(byteOrder,dest,buff+offset,count);
+            return count;
+        }
+        #ifdef DMPACKET_HAS_SPAN
+        size_t readWordsInto(std::span<uint16_t> dest, size_t offset) { return readWordsInto(dest.data(),offset,dest.size()); }
+        size_t readDWordsInto(std::span<uint32_t> dest, size_t offset) { return readDWordsInto(dest.data(),offset,dest.size()); }
+        size_t readFloatsInto(std::span<float> dest, size_t offset) { return readFloatsInto(dest.data(),offset,dest.size()); }
+        #endif
+
+        uint8_t shiftByte(void) { return readByte(advance(1)); }
+        uint16_t shiftWord(void) { return readWord(advance(2)); }
+        uint32_t shiftDWord(void) { return readDWord(advance(4)); }
+        int8_t shiftInt8(void) { return (int8_t) shiftByte(); }
+        int16_t shiftInt16(void) { return (int16_t) shiftWord(); }
+        int32_t shiftInt32(void) { return (int32_t) shiftDWord(); }
+        float shiftFloat(void) { return DMPacketBE::toFloat(shiftDWord()); }
+        bool shiftBool(void) { return shiftByte() != 0; }
+        std::string shiftString(size_t lenght = 0);
+        const uint8_t* shiftData(size_t count) { return readData(advance(count),count); }
+        uint32_t shiftVarUInt(void);
+        int32_t shiftVarInt(void) { return DMPacketVarint::unzigzag(shiftVarUInt()); }
+        template<typename T>
+        size_t shiftDeltasInto(T dest[], size_t count, T base = 0);
+        size_t shiftWordsInto(uint16_t dest[], size_t count) { return readWordsInto(dest,advance(count*2),count); }
+        size_t shiftDWordsInto(uint32_t dest[], size_t count) { return readDWordsInto(dest,advance(count*4),count); }
+        size_t shiftFloatsInto(float dest[], size_t count) { return readFloatsInto(dest,advance(count*4),count); }
+        #ifdef DMPACKET_HAS_SPAN
+        size_t shiftWordsInto(std::span<uint16_t> dest) { return shiftWordsInto(dest.data(),dest.size()); }
+        size_t shiftDWordsInto(std::span<uint32_t> dest) { return shiftDWordsInto(dest.data(),dest.size()); }
+        size_t shiftFloatsInto(std::span<float> dest) { return shiftFloatsInto(dest.data(),dest.size()); }
+        #endif
+
+    private:
+        bool check(size_t offset, size_t count) {
+            if (offset > buffSize || count > buffSize-offset) {
+                #ifdef TROWS_EXCEPTION_ON_READ_OVERFLOW
+                    throw("Reading over buffer operation not permitted");
+                #endif
+                overflowed=true;
+                return false;
+            }
+            return true;
+        }
+        size_t advance(size_t count) {
+            size_t offset=shiftIndex;
+            shiftIndex+=count;
+            return offset;
+        }
+
+        const uint8_t *buff;
+        size_t buffSize;
+        size_t shiftIndex;
+        bool overflowed;
+        DMPacketByteOrder byteOrder;
+};
+
+class DMPacketWriter {
+    public:
+        DMPacketWriter(uint8_t *buff, size_t capacity, DMPacketByteOrder byteOrder = DMPACKET_BIG_ENDIAN) : buff(buff), buffCapacity(capacity), buffSize(0), overflowed(false), byteOrder(byteOrder) {}
+        template<size_t N>
+        DMPacketWriter(uint8_t (&buff)[N], DMPacketByteOrder byteOrder = DMPACKET_BIG_ENDIAN) : DMPacketWriter(buff, N, byteOrder) {}
+        #ifdef DMPACKET_HAS_SPAN
+        DMPacketWriter(std::span<uint8_t> buff, DMPacketByteOrder byteOrder = DMPACKET_BIG_ENDIAN) : DMPacketWriter(buff.data(), buff.size(), byteOrder) {}
+        #endif
+
+        //! Restart from an empty packet (the buffer is untouched).
+        void clear(void) {
+            buffSize=0;
+            overflowed=false;
+        }
+        size_t size(void) const { return buffSize; }
+        size_t capacity(void) const { return buffCapacity; }
+        size_t available(void) const { return buffCapacity-buffSize; }
+        uint8_t* data(void) { return buff; }
+        const uint8_t* data(void) const { return buff; }
+        //! @return true if a push/write did not fit (sticky until clear()).
+        bool overflow(void) const { return overflowed; }
+        //! Byte order of 16/32 bit values (big endian by default).
+        DMPacketByteOrder getByteOrder(void) const { return byteOrder; }
+        void setByteOrder(DMPacketByteOrder byteOrder) { this->byteOrder=byteOrder; }
+        //! @return a view of the written bytes.
+        DMPacketView view(void) const { return DMPacketView(buff,buffSize,byteOrder); }
+
+        void writeByte(uint8_t Byte, size_t offset) {
+            if (check(offset,1)) {
+                buff[offset]=Byte;
+            }
+        }
+        void writeWord(uint16_t Word, size_t offset) {
+            if (check(offset,2)) {
+                DMPacketEndian::store16(byteOrder,buff+offset,Word);
+            }
+        }
+        void writeDWord(uint32_t DWord, size_t offset) {
+            if (check(offset,4)) {
+                DMPacketEndian::store32(byteOrder,buff+offset,DWord);
+            }
+        }
+        void writeInt16(int16_t Int, size_t offset) { writeWord((uint16_t) Int,offset); }
+        void writeInt32(int32_t Int, size_t offset) { writeDWord((uint32_t) Int,offset); }
+        void writeFloat(float Float, size_t offset) { writeDWord(DMPacketBE::fromFloat(Float),offset); }
+        void writeBool(bool Bool, size_t offset) { writeByte(Bool ? 0x01 : 0x00,offset); }
+        void writeData(const uint8_t buff[], size_t buffSize, size_t offset) {
+            if (check(offset,buffSize)) {
+                memcpy(this->buff+offset,buff,buffSize);
+            }
+        }
+
+        void pushByte(uint8_t Byte) {
+            if (reserve(1)) {
+                buff[buffSize++]=Byte;
+            }
+        }
+        void pushWord(uint16_t Word) {
+            if (reserve(2)) {
+                DMPacketEndian::store16(byteOrder,buff+buffSize,Word);
+                buffSize+=2;
+            }
+        }
+        void pushDWord(uint32_t DWord) {
+            if (reserve(4)) {
+                DMPacketEndian::store32(byteOrder,buff+buffSize,DWord);
+                buffSize+=4;
+            }
+        }
+        void pushInt8(int8_t Int) { pushByte((uint8_t) Int); }
+        void pushInt16(int16_t Int) { pushWord((uint16_t) Int); }
+        void pushInt32(int32_t Int) { pushDWord((uint32_t) Int); }
+        void pushFloat(float Float) { pushDWord(DMPacketBE::fromFloat(Float)); }
+        void pushBool(bool Bool) { pushByte(Bool ? 0x01 : 0x00); }
+        #ifdef ARDUINO
+        // DString has no data(), its size() and operator[] are not const
+        void pushString(std::string str) {
+            size_t count=str.size();
+            if (reserve(count)) {
+                for (size_t ixS=0; ixS<count; ixS++) {
+                    buff[buffSize+ixS]=(uint8_t) str[ixS];
+                }
+                buffSize+=count;
+            }
+        }
+        #else
+        void pushString(const std::string& str) { pushData((const uint8_t *) str.data(),str.size()); }
+        #endif
+        void pushData(const uint8_t buff[], size_t buffSize) {
+            if (reserve(buffSize)) {
+                memcpy(this->buff+this->buffSize,buff,buffSize);
+                this->buffSize+=buffSize;
+            }
+        }
+        void pushData(const std::vector<uint8_t>& buffVec) { pushData(buffVec.data(),buffVec.size()); }
+        void pushWords(const uint16_t values[], size_t count) {
+            if (reserve(count*2)) {
+                DMPacketEndian::store16(byteOrder,buff+buffSize,values,count);
+                buffSize+=count*2;
+            }
+        }
+        void pushDWords(const uint32_t values[], size_t count) {
+            if (reserve(count*4)) {
+                DMPacketEndian::store32(byteOrder,buff+buffSize,values,count);
+                buffSize+=count*4;
+            }
+        }
+        void pushFloats(const float values[], size_t count) {
+            if (reserve(count*4)) {
+                DMPacketEndian::storeFloat(byteOrder,buff+buffSize,values,count);
+                buffSize+=count*4;
+            }
+        }
+        #ifdef DMPACKET_HAS_SPAN
+        void pushWords(std::span<const uint16_t> values) { pushWords(values.data(),values.size()); }
+        void pushDWords(std::span<const uint32_t> values) { pushDWords(values.data(),values.size()); }
+        void pushFloats(std::span<const float> values) { pushFloats(values.data(),values.size()); }
+        #endif
+        //! Append a varint (1-5 bytes, see DMPacketVarint).
+        void pushVarUInt(uint32_t value) {
+            size_t n=DMPacketVarint::size(value);
+            if (reserve(n)) {
+                DMPacketVarint::encode(buff+buffSize,value);
+                buffSize+=n;
+            }
+        }
+        //! Append a zigzag varint (small negative values stay short).
+        void pushVarInt(int32_t value) { pushVarUInt(DMPacketVarint::zigzag(value)); }
+        template<typename T>
+        void pushDeltas(const T values[], size_t count, T base = 0);
+        //! Append count bytes to fill in place: @return a pointer to them, nullptr if they do not fit.
+        uint8_t* pushSpace(size_t count) {
+            if (!reserve(count)) {
+                return nullptr;
+            }
+            buffSize+=count;
+            return buff+buffSize-count;
+        }
+
+    private:
+        // Writes must stay inside written bytes, like DMPacket
+        bool check(size_t offset, size_t count) {
+            if (offset > buffSize || count > buffSize-offset) {
+                overflowed=true;
+                return false;
+            }
+            return true;
+        }
+        bool reserve(size_t count) {
+            if (count > buffCapacity-buffSize) {
+                overflowed=true;
+                return false;
+            }
+            return true;
+        }
+
+        uint8_t *buff;
+        size_t buffCapacity;
+        size_t buffSize;
+        bool overflowed;
+        DMPacketByteOrder byteOrder;
+};
+
+/**
+ * @brief Read a string.
+ *
+ * @param offset    ->  offset in buffer.
+ * @param lenght    ->  number of characters (0 = to the end of buffer).
+ * @return the string (truncated to the end of buffer).
+ */
+inline std::string DMPacketView::readString(size_t offset, size_t lenght)
+{
+    if (offset > buffSize) {
+        overflowed=true;
+        return std::string();
+    }
+    if (lenght == 0) {
+        lenght=buffSize-offset;
+    }
+    else if (lenght > buffSize-offset) {
+        overflowed=true;
+        lenght=buffSize-offset;
+    }
+    #ifdef ARDUINO
+        std::string sData;
+        sData.resize(lenght);
+        for (size_t ixS=0; ixS<lenght; ixS++) {
+            sData[ixS]=buff[offset+ixS];
+        }
+        return sData;
+    #else
+        return std::string((const char *) buff+offset,lenght);
+    #endif
+}
+
+/**
+ * @brief Shift a string.
+ *
+ * @param lenght    ->  number of characters (0 = to the end of buffer).
+ */
+inline std::string DMPacketView::shiftString(size_t lenght)
+{
+    std::string s=readString(shiftIndex,lenght);
+    shiftIndex+=s.size();
+    return s;
+}
+
+/**
+ * @brief Shift a varint.
+ *
+ * @return the value (0xFFFFFFFF if truncated or malformed: overflow() is set and the rest of the view is skipped).
+ */
+inline uint32_t DMPacketView::shiftVarUInt(void)
+{
+    uint32_t value=0xFFFFFFFF;
+    size_t n=shiftIndex < buffSize ? DMPacketVarint::decode(buff+shiftIndex,buffSize-shiftIndex,value) : 0;
+    if (n == 0) {
+        #ifdef TROWS_EXCEPTION_ON_READ_OVERFLOW
+            throw("Reading over buffer operation not permitted");
+        #endif
+        overflowed=true;
+        shiftIndex=buffSize;
+        return 0xFFFFFFFF;
+    }
+    shiftIndex+=n;
+    return value;
+}
+
+/**
+ * @brief Shift a time series written by DMPacketWriter::pushDeltas().
+ *
+ * @param dest  ->  destination.
+ * @param count ->  number of values.
+ * @param base  ->  value before the first one (the same used to push them).
+ * @return number of values decoded (less than count on overflow).
+ */
+template<typename T>
+size_t DMPacketView::shiftDeltasInto(T dest[], size_t count, T base)
+{
+    // shift...() move shiftIndex past the end on overflow
+    size_t decoded=0;
+    const uint8_t *p=nullptr;
+    if (shiftIndex < buffSize) {
+        p=buff+shiftIndex;
+        size_t avail=buffSize-shiftIndex;
+        decoded=DMPacketVarint::decodeDeltas(p,avail,dest,count,(uint32_t) base);
+    }
+    if (decoded < count) {
+        #ifdef TROWS_EXCEPTION_ON_READ_OVERFLOW
+            throw("Reading over buffer operation not permitted");
+        #endif
+        overflowed=true;
+        shiftIndex=buffSize;
+        return decoded;
+    }
+    if (p != nullptr) {
+        shiftIndex=p-buff;
+    }
+    return count;
+}
+
+/**
+ * @brief Append a time series (integers up to 32 bit) as zigzag varints of the differences between consecutive
+ * values: slowly changing samples take 1-2 bytes each.
+ *
+ * @param values    ->  the series.
+ * @param count     ->  number of values.
+ * @param base      ->  value before the first one (i.e. the last value of the previous packet, or 0).
+ */
+template<typename T>
+void DMPacketWriter::pushDeltas(const T values[], size_t count, T base)
+{
+    if (available() >= DMPacketVarint::deltasCapacity(count)) {
+        buffSize+=DMPacketVarint::encodeDeltas(buff+buffSize,values,count,(uint32_t) base);
+        return;
+    }
+    // Near the end of the buffer: value by value, up to the overflow
+    uint32_t prev=(uint32_t) base;
+    for (size_t ixV=0; ixV<count; ixV++) {
+        uint32_t value=(uint32_t) values[ixV];
+        pushVarInt((int32_t) (value-prev));
+        prev=value;
+    }
+}
+
+#endif // DMPACKETVIEW_H